@@ -11,6 +11,7 @@
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
 
+#include "gui/CompressedTileCache.h"
 #include "gui/TextEditor.h"
 #include "gui/XournalView.h"
 #include "gui/XournalppCursor.h"
@@ -35,6 +36,7 @@
 #include "layer/LayerController.h"
 #include "model/BackgroundImage.h"
 #include "model/FormatDefinitions.h"
+#include "model/ImageMipmap.h"
 #include "model/StrokeStyle.h"
 #include "model/XojPage.h"
 #include "pagetype/PageTypeHandler.h"
@@ -91,6 +93,9 @@ Control::Control(GladeSearchpath* gladeSearchPath) {
     this->applyPreferredLanguage();
 
     TextView::setDpi(settings->getDisplayDpi());
+    ImageMipmap::setMemoryLimit(static_cast<size_t>(settings->getImageCacheMemoryLimit()) * 1024 * 1024);
+    CompressedTileCache::getInstance().setMemoryLimit(
+            static_cast<size_t>(settings->getCompressedPageBufferMemoryLimit()) * 1024 * 1024);
 
     this->pageTypes = new PageTypeHandler(gladeSearchPath);
     this->newPageType = new PageTypeMenu(this->pageTypes, settings, true, true);
@@ -99,7 +104,7 @@ Control::Control(GladeSearchpath* gladeSearchPath) {
 
     this->scrollHandler = new ScrollHandler(this);
 
-    this->scheduler = new XournalScheduler();
+    this->scheduler = new XournalScheduler(this->settings->getRenderThreadCount());
 
     this->doc = new Document(this);
 
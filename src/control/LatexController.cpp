@@ -1,5 +1,6 @@
 #include "LatexController.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <iterator>
@@ -26,7 +27,9 @@ LatexController::LatexController(Control* control):
         dlg(control->getGladeSearchPath()),
         doc(control->getDocument()),
         texTmpDir(Util::getTmpDirSubfolder("tex")),
-        generator(settings) {
+        generator(settings),
+        cache(Util::getCacheSubfolder("tex"),
+              static_cast<uintmax_t>(std::max(settings.cacheSizeLimit, 0)) * 1024 * 1024) {
     Util::ensureFolderExists(this->texTmpDir);
 }
 
@@ -144,6 +147,19 @@ void LatexController::triggerImageUpdate(const string& texString) {
     this->lastPreviewedTex = texString;
     const std::string texContents = LatexGenerator::templateSub(
             texString, this->latexTemplate, this->control->getToolHandler()->getTool(TOOL_TEXT).getColor());
+
+    this->compilingKey = LatexCache::makeKey(texContents, this->settings.genCmd);
+    if (auto pdf = this->cache.lookup(this->compilingKey)) {
+        // Compiled before, no need to run LaTeX again
+        this->isValidTex = true;
+        this->temporaryRender = this->loadRendered(texString, std::move(*pdf));
+        if (this->temporaryRender != nullptr) {
+            this->dlg.setTempRender(this->temporaryRender->getPdf());
+        }
+        this->setUpdating(false);
+        return;
+    }
+
     auto result = generator.asyncRun(this->texTmpDir, texContents);
     if (auto* err = std::get_if<LatexGenerator::GenError>(&result)) {
         this->setUpdating(false);
@@ -187,7 +203,14 @@ void LatexController::onPdfRenderComplete(GObject* procObj, GAsyncResult* res, L
         g_error_free(err);
     } else {
         self->isValidTex = true;
-        self->temporaryRender = self->loadRendered(currentTex);
+        fs::path pdfPath = self->texTmpDir / "tex.pdf";
+        auto contents = Util::readString(pdfPath, true);
+        if (contents) {
+            self->cache.store(self->compilingKey, *contents);
+            self->temporaryRender = self->loadRendered(currentTex, std::move(*contents));
+        } else {
+            self->temporaryRender = nullptr;
+        }
         if (self->temporaryRender != nullptr) {
             self->dlg.setTempRender(self->temporaryRender->getPdf());
         }
@@ -232,20 +255,14 @@ void LatexController::deleteOldImage() {
     }
 }
 
-auto LatexController::loadRendered(string renderedTex) -> std::unique_ptr<TexImage> {
+auto LatexController::loadRendered(string renderedTex, std::string pdf) -> std::unique_ptr<TexImage> {
     if (!this->isValidTex) {
         return nullptr;
     }
 
-    fs::path pdfPath = texTmpDir / "tex.pdf";
-    auto contents = Util::readString(pdfPath, true);
-    if (!contents) {
-        return nullptr;
-    }
-
     auto img = std::make_unique<TexImage>();
     GError* err{};
-    bool loaded = img->loadData(std::move(*contents), &err);
+    bool loaded = img->loadData(std::move(pdf), &err);
 
     if (err != nullptr) {
         string message = FS(_F("Could not load LaTeX PDF file: {1}") % err->message);
@@ -22,6 +22,7 @@
 
 #include "control/settings/LatexSettings.h"
 #include "gui/dialog/LatexDialog.h"
+#include "latex/LatexCache.h"
 #include "latex/LatexGenerator.h"
 #include "model/PageRef.h"
 #include "model/Text.h"
@@ -109,9 +110,9 @@ private:
     void setUpdating(bool newValue);
 
     /**
-     * Load the preview PDF from disk and create a TexImage object.
+     * Create a TexImage object from the preview PDF.
      */
-    std::unique_ptr<TexImage> loadRendered(string renderedTex);
+    std::unique_ptr<TexImage> loadRendered(string renderedTex, std::string pdf);
 
     /**
      * Insert the generated preview TexImage into the current page.
@@ -148,6 +149,11 @@ private:
      */
     string lastPreviewedTex;
 
+    /**
+     * The cache key of the formula currently compiled
+     */
+    std::string compilingKey;
+
     /**
      * Whether a preview is currently being generated.
      */
@@ -216,4 +222,9 @@ private:
     std::unique_ptr<TexImage> temporaryRender;
 
     LatexGenerator generator;
+
+    /**
+     * Compiled formulas of earlier previews, also of other documents
+     */
+    LatexCache cache;
 };
@@ -1,100 +1,300 @@
 #include "PdfCache.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <utility>
 
-class PdfCacheEntry {
-public:
-    PdfCacheEntry(XojPdfPageSPtr popplerPage, cairo_surface_t* img) {
-        this->popplerPage = std::move(popplerPage);
-        this->rendered = img;
-    }
-
-    ~PdfCacheEntry() {
-        this->popplerPage = nullptr;
-        cairo_surface_destroy(this->rendered);
-        this->rendered = nullptr;
-    }
-    XojPdfPageSPtr popplerPage;
-    cairo_surface_t* rendered;
-};
+/**
+ * Zoom steps per 1.0 zoom which are distinguished by the cache
+ */
+constexpr double ZOOM_QUANTIZATION = 1000;
 
-PdfCache::PdfCache(int size) {
-    this->size = size;
-
-    g_mutex_init(&this->renderMutex);
+PdfCache::PdfCache(size_t maxBytes): maxBytes(maxBytes) {
+    g_mutex_init(&this->cacheMutex);
+    g_cond_init(&this->renderedCond);
 }
 
 PdfCache::~PdfCache() {
     clearCache();
-    this->size = 0;
+    g_cond_clear(&this->renderedCond);
+    g_mutex_clear(&this->cacheMutex);
 }
 
-void PdfCache::setZoom(double zoom) {
-    if (this->zoom == zoom) {
-        return;
+void PdfCache::clearCache() {
+    g_mutex_lock(&this->cacheMutex);
+
+    for (Entry& e: this->data) {
+        cairo_surface_destroy(e.rendered);
     }
-    this->zoom = zoom;
+    this->data.clear();
+    this->index.clear();
+    this->usedBytes = 0;
+    this->generation++;
 
-    clearCache();
+    g_mutex_unlock(&this->cacheMutex);
 }
 
-void PdfCache::clearCache() {
-    for (PdfCacheEntry* e: this->data) {
-        delete e;
+auto PdfCache::quantizeZoom(double zoom) -> int64_t { return std::llround(zoom * ZOOM_QUANTIZATION); }
+
+auto PdfCache::getTiles(const XojPdfPageSPtr& popplerPage, double zoom, double x1, double y1, double x2, double y2)
+        -> TileRange {
+    int width = static_cast<int>(std::ceil(popplerPage->getWidth() * zoom));
+    int height = static_cast<int>(std::ceil(popplerPage->getHeight() * zoom));
+
+    int px1 = std::max(0, static_cast<int>(std::floor(std::max(x1 * zoom, 0.0))));
+    int py1 = std::max(0, static_cast<int>(std::floor(std::max(y1 * zoom, 0.0))));
+    int px2 = static_cast<int>(std::ceil(std::min(x2 * zoom, static_cast<double>(width))));
+    int py2 = static_cast<int>(std::ceil(std::min(y2 * zoom, static_cast<double>(height))));
+
+    TileRange range;
+    if (px2 <= px1 || py2 <= py1) {
+        return range;
     }
-    this->data.clear();
+
+    range.x1 = px1 / TILE_SIZE;
+    range.y1 = py1 / TILE_SIZE;
+    range.x2 = (px2 - 1) / TILE_SIZE;
+    range.y2 = (py2 - 1) / TILE_SIZE;
+    return range;
 }
 
-auto PdfCache::lookup(const XojPdfPageSPtr& popplerPage) -> cairo_surface_t* {
-    for (PdfCacheEntry* e: this->data) {
-        if (e->popplerPage->getPageId() == popplerPage->getPageId()) {
-            return e->rendered;
-        }
+auto PdfCache::lookup(const TileKey& key) -> Entry* {
+    auto page = this->index.find(std::get<0>(key));
+    if (page == this->index.end()) {
+        return nullptr;
+    }
+
+    auto resolution = page->second.find(std::get<1>(key));
+    if (resolution == page->second.end()) {
+        return nullptr;
+    }
+
+    auto it = resolution->second.find({std::get<2>(key), std::get<3>(key)});
+    if (it == resolution->second.end()) {
+        return nullptr;
     }
 
-    return nullptr;
+    // Mark as most recently used
+    this->data.splice(this->data.begin(), this->data, it->second);
+    return &*it->second;
 }
 
-void PdfCache::cache(XojPdfPageSPtr popplerPage, cairo_surface_t* img) {
-    auto* ne = new PdfCacheEntry(std::move(popplerPage), img);
-    this->data.push_front(ne);
+auto PdfCache::lookupApproximation(const XojPdfPageSPtr& popplerPage, int64_t zoomKey, double x1, double y1,
+                                   double x2, double y2, double& tileZoom) -> std::vector<Tile> {
+    std::vector<Tile> tiles;
 
-    while (this->data.size() > this->size) {
-        delete this->data.back();
-        this->data.pop_back();
+    auto page = this->index.find(popplerPage->getPageId());
+    if (page == this->index.end()) {
+        return tiles;
+    }
+
+    // Compare the scale factors, not the difference of the zooms
+    auto ratio = [zoomKey](int64_t key) {
+        return key > zoomKey ? static_cast<double>(key) / zoomKey : static_cast<double>(zoomKey) / key;
+    };
+
+    int64_t nearest = 0;
+    for (auto const& resolution: page->second) {
+        if (resolution.first != zoomKey && (nearest == 0 || ratio(resolution.first) < ratio(nearest))) {
+            nearest = resolution.first;
+        }
+    }
+    if (nearest == 0) {
+        return tiles;
+    }
+
+    auto& cached = page->second[nearest];
+    tileZoom = cached.begin()->second->zoom;
+
+    TileRange range = getTiles(popplerPage, tileZoom, x1, y1, x2, y2);
+    for (int ty = range.y1; ty <= range.y2; ty++) {
+        for (int tx = range.x1; tx <= range.x2; tx++) {
+            auto it = cached.find({tx, ty});
+            if (it == cached.end()) {
+                // Only part of the area is cached with this zoom
+                for (Tile& t: tiles) {
+                    cairo_surface_destroy(t.img);
+                }
+                tiles.clear();
+                return tiles;
+            }
+            tiles.push_back({cairo_surface_reference(it->second->rendered), tx, ty});
+        }
     }
+
+    for (Tile& t: tiles) {
+        lookup({page->first, nearest, t.x, t.y});
+    }
+    return tiles;
 }
 
-void PdfCache::render(cairo_t* cr, const XojPdfPageSPtr& popplerPage, double zoom) {
-    g_mutex_lock(&this->renderMutex);
+void PdfCache::cache(const TileKey& key, double zoom, cairo_surface_t* img) {
+    size_t bytes = static_cast<size_t>(cairo_image_surface_get_stride(img)) * cairo_image_surface_get_height(img);
 
-    this->setZoom(zoom);
+    this->data.push_front({key, zoom, img, bytes});
+    this->index[std::get<0>(key)][std::get<1>(key)][{std::get<2>(key), std::get<3>(key)}] = this->data.begin();
+    this->usedBytes += bytes;
 
-    cairo_surface_t* img = lookup(popplerPage);
-    if (img == nullptr) {
-        img = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, popplerPage->getWidth() * this->zoom,
-                                         popplerPage->getHeight() * this->zoom);
-        cairo_t* cr2 = cairo_create(img);
+    evict();
+}
 
-        cairo_scale(cr2, this->zoom, this->zoom);
-        popplerPage->render(cr2, false);
-        cairo_destroy(cr2);
-        cache(popplerPage, img);
+/**
+ * Free the least recently used entries until the budget is kept,
+ * the most recently used entry is always kept
+ */
+void PdfCache::evict() {
+    while (this->usedBytes > this->maxBytes && this->data.size() > 1) {
+        Entry& e = this->data.back();
+
+        auto page = this->index.find(std::get<0>(e.key));
+        auto resolution = page->second.find(std::get<1>(e.key));
+        resolution->second.erase({std::get<2>(e.key), std::get<3>(e.key)});
+        if (resolution->second.empty()) {
+            page->second.erase(resolution);
+        }
+        if (page->second.empty()) {
+            this->index.erase(page);
+        }
+
+        this->usedBytes -= e.bytes;
+        cairo_surface_destroy(e.rendered);
+        this->data.pop_back();
     }
+}
 
-    cairo_matrix_t mOriginal;
+void PdfCache::paint(cairo_t* cr, cairo_surface_t* img, double scale, int x, int y) {
+    cairo_save(cr);
+
+    // The tiles are in device pixels, they replace the zoom of cr
     cairo_matrix_t mScaled;
-    cairo_get_matrix(cr, &mOriginal);
     cairo_get_matrix(cr, &mScaled);
-    mScaled.xx = 1;
-    mScaled.yy = 1;
+    mScaled.xx = scale;
+    mScaled.yy = scale;
     mScaled.xy = 0;
     mScaled.yx = 0;
     cairo_set_matrix(cr, &mScaled);
-    cairo_set_source_surface(cr, img, 0, 0);
-    cairo_paint(cr);
-    cairo_set_matrix(cr, &mOriginal);
 
-    g_mutex_unlock(&this->renderMutex);
+    // Padded, so scaled tiles don't get transparent seams at their borders
+    cairo_set_source_surface(cr, img, x, y);
+    cairo_pattern_set_extend(cairo_get_source(cr), CAIRO_EXTEND_PAD);
+    cairo_rectangle(cr, x, y, cairo_image_surface_get_width(img), cairo_image_surface_get_height(img));
+    cairo_fill(cr);
+
+    cairo_restore(cr);
+}
+
+auto PdfCache::render(cairo_t* cr, const XojPdfPageSPtr& popplerPage, double zoom, bool allowApproximation) -> bool {
+    int pageId = popplerPage->getPageId();
+    int64_t zoomKey = quantizeZoom(zoom);
+
+    double x1 = 0;
+    double y1 = 0;
+    double x2 = 0;
+    double y2 = 0;
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+    TileRange range = getTiles(popplerPage, zoom, x1, y1, x2, y2);
+
+    if (allowApproximation) {
+        g_mutex_lock(&this->cacheMutex);
+
+        bool complete = true;
+        for (int ty = range.y1; ty <= range.y2 && complete; ty++) {
+            for (int tx = range.x1; tx <= range.x2 && complete; tx++) {
+                complete = lookup({pageId, zoomKey, tx, ty}) != nullptr;
+            }
+        }
+
+        if (!complete) {
+            double tileZoom = zoom;
+            std::vector<Tile> tiles = lookupApproximation(popplerPage, zoomKey, x1, y1, x2, y2, tileZoom);
+            g_mutex_unlock(&this->cacheMutex);
+
+            if (!tiles.empty()) {
+                // The tiles are referenced, another thread may evict them while they are painted
+                for (Tile& t: tiles) {
+                    paint(cr, t.img, zoom / tileZoom, t.x * TILE_SIZE, t.y * TILE_SIZE);
+                    cairo_surface_destroy(t.img);
+                }
+                return false;
+            }
+        } else {
+            g_mutex_unlock(&this->cacheMutex);
+        }
+    }
+
+    for (int ty = range.y1; ty <= range.y2; ty++) {
+        for (int tx = range.x1; tx <= range.x2; tx++) {
+            renderTile(cr, popplerPage, zoomKey, zoom, tx, ty);
+        }
+    }
+    return true;
+}
+
+void PdfCache::renderTile(cairo_t* cr, const XojPdfPageSPtr& popplerPage, int64_t zoomKey, double zoom, int tileX,
+                          int tileY) {
+    TileKey key{popplerPage->getPageId(), zoomKey, tileX, tileY};
+    int x = tileX * TILE_SIZE;
+    int y = tileY * TILE_SIZE;
+
+    g_mutex_lock(&this->cacheMutex);
+
+    while (true) {
+        Entry* entry = lookup(key);
+        if (entry != nullptr) {
+            // The entry may be evicted by another thread while it's painted
+            cairo_surface_t* img = cairo_surface_reference(entry->rendered);
+            g_mutex_unlock(&this->cacheMutex);
+
+            paint(cr, img, 1, x, y);
+            cairo_surface_destroy(img);
+            return;
+        }
+
+        auto it = this->inFlight.find(key);
+        if (it == this->inFlight.end()) {
+            break;
+        }
+
+        // Another thread renders this tile, wait for it and take it from the cache
+        std::shared_ptr<InFlight> flight = it->second;
+        while (!flight->done) {
+            g_cond_wait(&this->renderedCond, &this->cacheMutex);
+        }
+    }
+
+    auto flight = std::make_shared<InFlight>();
+    this->inFlight[key] = flight;
+    uint64_t generation = this->generation;
+
+    g_mutex_unlock(&this->cacheMutex);
+
+    // The tile is cut at the page border
+    int width = std::min(TILE_SIZE, static_cast<int>(std::ceil(popplerPage->getWidth() * zoom)) - x);
+    int height = std::min(TILE_SIZE, static_cast<int>(std::ceil(popplerPage->getHeight() * zoom)) - y);
+
+    cairo_surface_t* img = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_t* cr2 = cairo_create(img);
+
+    cairo_translate(cr2, -x, -y);
+    cairo_scale(cr2, zoom, zoom);
+    popplerPage->render(cr2, false);
+    cairo_destroy(cr2);
+
+    paint(cr, img, 1, x, y);
+
+    g_mutex_lock(&this->cacheMutex);
+
+    if (generation == this->generation && lookup(key) == nullptr) {
+        cache(key, zoom, img);
+    } else {
+        // The cache was cleared meanwhile, the page may belong to another document
+        cairo_surface_destroy(img);
+    }
+
+    flight->done = true;
+    this->inFlight.erase(key);
+    g_cond_broadcast(&this->renderedCond);
+
+    g_mutex_unlock(&this->cacheMutex);
 }
@@ -11,8 +11,13 @@
 
 #pragma once
 
+#include <cstdint>
 #include <list>
+#include <map>
+#include <memory>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include <cairo/cairo.h>
@@ -20,13 +25,19 @@
 #include "pdf/base/XojPdfPage.h"
 
 #include "XournalType.h"
-using std::list;
-
-class PdfCacheEntry;
 
+/**
+ * Keeps rendered PDF pages of several resolutions, so zooming back and forth
+ * doesn't render the pages again. The pages are rendered and cached in tiles,
+ * so painting a part of a page only renders that part. The least recently used
+ * tiles are freed if the memory budget is exceeded.
+ */
 class PdfCache {
 public:
-    PdfCache(int size);
+    /**
+     * @param maxBytes The memory the rendered tiles may use
+     */
+    explicit PdfCache(size_t maxBytes);
     virtual ~PdfCache();
 
 private:
@@ -34,19 +45,125 @@ private:
     void operator=(const PdfCache& cache);
 
 public:
-    void render(cairo_t* cr, const XojPdfPageSPtr& popplerPage, double zoom);
+    /**
+     * Paints the part of the page within the clip of cr, which has to be scaled by zoom
+     *
+     * @param allowApproximation If the area is not cached with this zoom, but with another one,
+     *                           the other resolution is painted scaled instead of rendering the page
+     * @return true if the page was painted with the requested resolution
+     */
+    bool render(cairo_t* cr, const XojPdfPageSPtr& popplerPage, double zoom, bool allowApproximation = false);
     void clearCache();
 
+    /**
+     * Edge length of the rendered tiles, in pixels
+     */
+    static constexpr int TILE_SIZE = 512;
+
 private:
-    void setZoom(double zoom);
-    cairo_surface_t* lookup(const XojPdfPageSPtr& popplerPage);
-    void cache(XojPdfPageSPtr popplerPage, cairo_surface_t* img);
+    /**
+     * Page id, quantized zoom, tile column and tile row
+     */
+    using TileKey = std::tuple<int, int64_t, int, int>;
+
+    struct Entry {
+        TileKey key;
+        double zoom;
+        cairo_surface_t* rendered;
+        size_t bytes;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    /**
+     * Tiles of a page at one zoom, inclusive
+     */
+    struct TileRange {
+        int x1 = 0;
+        int y1 = 0;
+        int x2 = -1;
+        int y2 = -1;
+    };
+
+    /**
+     * A cached tile taken out of the cache to be painted
+     */
+    struct Tile {
+        cairo_surface_t* img;
+        int x;
+        int y;
+    };
+
+    /**
+     * A tile which is currently rendered by one thread, the others wait for it
+     */
+    struct InFlight {
+        bool done = false;
+    };
+
+    /**
+     * Zooms which differ only by rounding errors use the same entry
+     */
+    static int64_t quantizeZoom(double zoom);
+
+    /**
+     * The tiles covering the given area of the page, in page coordinates
+     */
+    static TileRange getTiles(const XojPdfPageSPtr& popplerPage, double zoom, double x1, double y1, double x2,
+                              double y2);
+
+    Entry* lookup(const TileKey& key);
+
+    /**
+     * Finds the tiles of the cached zoom closest to zoomKey, which cover the area completely
+     *
+     * @return the referenced tiles and their zoom, no tiles if there is no such zoom
+     */
+    std::vector<Tile> lookupApproximation(const XojPdfPageSPtr& popplerPage, int64_t zoomKey, double x1, double y1,
+                                          double x2, double y2, double& tileZoom);
+
+    void renderTile(cairo_t* cr, const XojPdfPageSPtr& popplerPage, int64_t zoomKey, double zoom, int tileX,
+                    int tileY);
+    void cache(const TileKey& key, double zoom, cairo_surface_t* img);
+    void evict();
+
+    /**
+     * Paints a tile whose top left corner is at (x, y) pixels, scaled by scale
+     */
+    static void paint(cairo_t* cr, cairo_surface_t* img, double scale, int x, int y);
 
 private:
-    GMutex renderMutex{};
+    /**
+     * Protects the cache data, but is not held while a tile is rendered, so cached tiles
+     * are painted while another tile is rendered. The pages of one document are rendered one at a time.
+     */
+    GMutex cacheMutex{};
+
+    /**
+     * Signaled if a tile is rendered
+     */
+    GCond renderedCond{};
+
+    /**
+     * Tiles currently rendered
+     */
+    std::map<TileKey, std::shared_ptr<InFlight>> inFlight;
+
+    /**
+     * Incremented by clearCache(), tiles started before are not cached
+     */
+    uint64_t generation = 0;
+
+    /**
+     * The most recently used entry is at the front
+     */
+    EntryList data;
 
-    list<PdfCacheEntry*> data;
-    list<PdfCacheEntry*>::size_type size = 0;
+    /**
+     * Page id => quantized zoom => (tile column, tile row) => entry
+     */
+    std::unordered_map<int, std::map<int64_t, std::map<std::pair<int, int>, EntryList::iterator>>> index;
 
-    double zoom = -1;
+    size_t maxBytes = 0;
+    size_t usedBytes = 0;
 };
@@ -0,0 +1,232 @@
+#include "ThumbnailCache.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "model/Document.h"
+#include "model/Image.h"
+#include "model/Layer.h"
+#include "model/XojPage.h"
+#include "serializing/ChecksumObjectEncoding.h"
+#include "serializing/ObjectOutputStream.h"
+
+#include "PathUtil.h"
+
+/**
+ * Previews stored before the cache directory is scanned for the size limit
+ */
+constexpr int PRUNE_INTERVAL = 64;
+
+/**
+ * Layer hashes kept, the versions of edited layers are dropped when this is reached
+ */
+constexpr size_t MAX_LAYER_HASHES = 4096;
+
+ThumbnailCache::ThumbnailCache(fs::path dir, uintmax_t maxBytes): dir(std::move(dir)), maxBytes(maxBytes) {
+    g_mutex_init(&this->pruneMutex);
+    g_mutex_init(&this->hashMutex);
+    Util::ensureFolderExists(this->dir);
+}
+
+ThumbnailCache::~ThumbnailCache() {
+    g_mutex_clear(&this->pruneMutex);
+    g_mutex_clear(&this->hashMutex);
+}
+
+/**
+ * Images are hashed by their PNG data or pixels, their serialized form would encode them as PNG again
+ */
+static void writeImage(ObjectOutputStream& out, Image* img) {
+    out.writeDouble(img->getX());
+    out.writeDouble(img->getY());
+    out.writeDouble(img->getElementWidth());
+    out.writeDouble(img->getElementHeight());
+
+    // Decoding the PNG data is only needed to draw it
+    if (!img->getPngData().empty()) {
+        out.writeString(img->getPngData());
+        return;
+    }
+
+    cairo_surface_t* surface = img->loadImage();
+    if (surface == nullptr) {
+        out.writeString("");
+        return;
+    }
+
+    cairo_surface_flush(surface);
+    out.writeInt(cairo_image_surface_get_width(surface));
+    out.writeData(cairo_image_surface_get_data(surface),
+                  cairo_image_surface_get_stride(surface) * cairo_image_surface_get_height(surface), 1);
+    cairo_surface_destroy(surface);
+}
+
+/**
+ * A file used by the page is identified by its path, size and modification time, so a replaced file gets another key
+ */
+static void writeFile(ObjectOutputStream& out, fs::path const& path) {
+    out.writeString(path.u8string());
+
+    std::error_code ec;
+    uintmax_t size = fs::file_size(path, ec);
+    out.writeSizeT(ec ? 0 : static_cast<size_t>(size));
+
+    fs::file_time_type time = fs::last_write_time(path, ec);
+    auto ticks = ec ? 0 : time.time_since_epoch().count();
+    out.writeData(&ticks, 1, sizeof(ticks));
+}
+
+auto ThumbnailCache::makeKey(Document* doc, const PageRef& page, int width, int height) -> std::string {
+    fs::path filepath = doc->getFilepath();
+    if (filepath.empty()) {
+        return "";
+    }
+
+    auto* encoding = new ChecksumObjectEncoding();
+    ObjectOutputStream out(encoding);
+
+    out.writeString(filepath.u8string());
+    out.writeSizeT(doc->indexOf(page));
+    out.writeInt(width);
+    out.writeInt(height);
+
+    out.writeDouble(page->getWidth());
+    out.writeDouble(page->getHeight());
+    out.writeInt(static_cast<int>(page->getBackgroundType().format));
+    out.writeString(page->getBackgroundType().config);
+    out.writeInt(static_cast<int>(uint32_t(page->getBackgroundColor())));
+    if (page->getBackgroundType().isPdfPage()) {
+        writeFile(out, doc->getPdfFilepath());
+        out.writeSizeT(page->getPdfPageNr());
+    }
+    if (page->getBackgroundType().isImagePage()) {
+        writeFile(out, page->getBackgroundImage().getFilepath());
+    }
+
+    for (Layer* layer: *page->getLayers()) {
+        if (!layer->isVisible()) {
+            continue;
+        }
+
+        out.writeObject("Layer");
+        out.writeString(getLayerHash(layer));
+        out.endObject();
+    }
+
+    return encoding->getChecksum();
+}
+
+auto ThumbnailCache::getLayerHash(Layer* layer) -> std::string {
+    uint64_t version = layer->getVersion();
+
+    g_mutex_lock(&this->hashMutex);
+    auto it = this->layerHashes.find(version);
+    if (it != this->layerHashes.end()) {
+        std::string hash = it->second;
+        g_mutex_unlock(&this->hashMutex);
+        return hash;
+    }
+    g_mutex_unlock(&this->hashMutex);
+
+    auto* encoding = new ChecksumObjectEncoding();
+    ObjectOutputStream out(encoding);
+    for (Element* e: *layer->getElements()) {
+        if (e->getType() == ELEMENT_IMAGE) {
+            writeImage(out, dynamic_cast<Image*>(e));
+        } else {
+            e->serialize(out);
+        }
+    }
+    std::string hash = encoding->getChecksum();
+
+    g_mutex_lock(&this->hashMutex);
+    if (this->layerHashes.size() >= MAX_LAYER_HASHES) {
+        this->layerHashes.clear();
+    }
+    this->layerHashes[version] = hash;
+    g_mutex_unlock(&this->hashMutex);
+
+    return hash;
+}
+
+auto ThumbnailCache::getPath(const std::string& key) const -> fs::path { return this->dir / (key + ".png"); }
+
+auto ThumbnailCache::lookup(const std::string& key, int width, int height) -> cairo_surface_t* {
+    fs::path path = getPath(key);
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) {
+        return nullptr;
+    }
+
+    cairo_surface_t* preview = cairo_image_surface_create_from_png(path.u8string().c_str());
+    if (cairo_surface_status(preview) != CAIRO_STATUS_SUCCESS ||
+        cairo_image_surface_get_format(preview) != CAIRO_FORMAT_ARGB32 ||
+        cairo_image_surface_get_width(preview) != width || cairo_image_surface_get_height(preview) != height) {
+        cairo_surface_destroy(preview);
+        return nullptr;
+    }
+
+    // The modification time is the time of the last use
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return preview;
+}
+
+void ThumbnailCache::store(const std::string& key, cairo_surface_t* preview) {
+    fs::path path = getPath(key);
+    fs::path tmp = path;
+    tmp += ".tmp";
+
+    // Written to a temporary file and renamed, so no other instance reads a partial file
+    if (cairo_surface_write_to_png(preview, tmp.u8string().c_str()) != CAIRO_STATUS_SUCCESS) {
+        g_warning("Could not cache the page preview %s", path.u8string().c_str());
+        return;
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return;
+    }
+
+    g_mutex_lock(&this->pruneMutex);
+    bool doPrune = ++this->storedSincePrune >= PRUNE_INTERVAL;
+    if (doPrune) {
+        this->storedSincePrune = 0;
+        prune();
+    }
+    g_mutex_unlock(&this->pruneMutex);
+}
+
+void ThumbnailCache::prune() {
+    std::vector<std::tuple<fs::file_time_type, uintmax_t, fs::path>> files;
+    uintmax_t total = 0;
+
+    std::error_code ec;
+    for (auto const& entry: fs::directory_iterator(this->dir, ec)) {
+        if (!entry.is_regular_file(ec) || entry.path().extension() != ".png") {
+            continue;
+        }
+        uintmax_t size = entry.file_size(ec);
+        if (ec) {
+            continue;
+        }
+        files.emplace_back(entry.last_write_time(ec), size, entry.path());
+        total += size;
+    }
+
+    if (total <= this->maxBytes) {
+        return;
+    }
+
+    std::sort(files.begin(), files.end());
+    for (auto const& [time, size, path]: files) {
+        if (total <= this->maxBytes) {
+            break;
+        }
+        if (fs::remove(path, ec)) {
+            total -= size;
+        }
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * Xournal++
+ *
+ * Rendered sidebar previews, kept on disk between sessions
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <cairo/cairo.h>
+#include <glib.h>
+
+#include "model/PageRef.h"
+
+#include "filesystem.h"
+
+class Document;
+class Layer;
+
+/**
+ * Stores each preview as PNG file, named by a hash of the document path, the page index,
+ * the page content and the preview size. The PDF and the background image are hashed by
+ * their path, size and modification time. A changed page gets another name, so only
+ * changed pages are rendered again. The least recently used files are deleted over the size limit.
+ *
+ * Thread safe, used by the preview jobs.
+ */
+class ThumbnailCache {
+public:
+    /**
+     * @param dir The directory of the cache, created if needed
+     * @param maxBytes The size the cached files may have together
+     */
+    ThumbnailCache(fs::path dir, uintmax_t maxBytes);
+    virtual ~ThumbnailCache();
+
+private:
+    ThumbnailCache(const ThumbnailCache& cache);
+    void operator=(const ThumbnailCache& cache);
+
+public:
+    /**
+     * Has to be called with the document locked. The elements of a layer are only hashed again
+     * if its version changed, see Layer::getVersion().
+     *
+     * @return the key of the preview, empty if the document was not saved yet
+     */
+    std::string makeKey(Document* doc, const PageRef& page, int width, int height);
+
+    /**
+     * @return a new surface with the cached preview, nullptr if there is none of this size
+     */
+    cairo_surface_t* lookup(const std::string& key, int width, int height);
+
+    void store(const std::string& key, cairo_surface_t* preview);
+
+private:
+    fs::path getPath(const std::string& key) const;
+
+    /**
+     * @return the hash of the elements of the layer, cached by the layer version
+     */
+    std::string getLayerHash(Layer* layer);
+
+    /**
+     * Deletes the least recently used files until the size limit is kept
+     */
+    void prune();
+
+private:
+    fs::path dir;
+    uintmax_t maxBytes;
+
+    /**
+     * Protects storedSincePrune, the files are written atomically
+     */
+    GMutex pruneMutex{};
+
+    /**
+     * The directory is only scanned every few stored previews, opening a document stores one per page
+     */
+    int storedSincePrune = 0;
+
+    /**
+     * Protects layerHashes
+     */
+    GMutex hashMutex{};
+
+    /**
+     * The content hash by layer version, the versions are unique among all layers
+     */
+    std::unordered_map<uint64_t, std::string> layerHashes;
+};
@@ -35,6 +35,8 @@ void Job::execute() { this->run(); }
 
 auto Job::getSource() -> void* { return nullptr; }
 
+auto Job::getPage() -> XojPage* { return nullptr; }
+
 auto Job::callAfterCallback(Job* job) -> bool {
     job->afterRun();
 
@@ -16,6 +16,8 @@
 
 #include "XournalType.h"
 
+class XojPage;
+
 enum JobType { JOB_TYPE_BLOCKING, JOB_TYPE_PREVIEW, JOB_TYPE_RENDER, JOB_TYPE_AUTOSAVE };
 
 class Job {
@@ -52,6 +54,14 @@ public:
 
     virtual void* getSource();
 
+    /**
+     * The page which is drawn by the job, jobs of the same page don't run in parallel
+     * as they share the lazily created data of the page, e.g. element sizes and images
+     *
+     * @return nullptr if the job doesn't draw a page
+     */
+    virtual XojPage* getPage();
+
 protected:
     /**
      * override this method
@@ -1,7 +1,13 @@
 #include "PreviewJob.h"
 
+#include <memory>
+
 #include "control/Control.h"
+#include "control/ThumbnailCache.h"
+#include "gui/MainWindow.h"
+#include "gui/PageBufferSnapshot.h"
 #include "gui/Shadow.h"
+#include "gui/XournalView.h"
 #include "gui/sidebar/previews/base/SidebarPreviewBase.h"
 #include "gui/sidebar/previews/base/SidebarPreviewBaseEntry.h"
 #include "gui/sidebar/previews/layer/SidebarPreviewLayerEntry.h"
@@ -15,6 +21,8 @@ PreviewJob::~PreviewJob() { this->sidebarPreview = nullptr; }
 
 auto PreviewJob::getSource() -> void* { return this->sidebarPreview; }
 
+auto PreviewJob::getPage() -> XojPage* { return this->sidebarPreview->page.get(); }
+
 auto PreviewJob::getType() -> JobType { return JOB_TYPE_PREVIEW; }
 
 void PreviewJob::initGraphics() {
@@ -83,6 +91,36 @@ void PreviewJob::drawPage(int layer) {
     cairo_destroy(cr2);
 }
 
+auto PreviewJob::loadCached(const std::string& key) -> bool {
+    ThumbnailCache* cache = this->sidebarPreview->sidebar->getThumbnailCache();
+    cairo_surface_t* cached = cache->lookup(key, cairo_image_surface_get_width(crBuffer),
+                                            cairo_image_surface_get_height(crBuffer));
+    if (cached == nullptr) {
+        return false;
+    }
+
+    cairo_destroy(cr2);
+    cairo_surface_destroy(crBuffer);
+    crBuffer = cached;
+    return true;
+}
+
+auto PreviewJob::drawFromPageBuffer() -> bool {
+    MainWindow* win = this->sidebarPreview->sidebar->getControl()->getWindow();
+    if (win == nullptr) {
+        return false;
+    }
+
+    auto snapshot = win->getXournal()->takePageSnapshot(this->sidebarPreview->page.get());
+    if (!snapshot) {
+        return false;
+    }
+
+    snapshot->paint(cr2);
+    cairo_destroy(cr2);
+    return true;
+}
+
 void PreviewJob::run() {
     initGraphics();
     drawBorder();
@@ -91,6 +129,29 @@ void PreviewJob::run() {
     doc->lock();
 
     PreviewRenderType type = this->sidebarPreview->getRenderType();
+
+    // Page previews of saved documents are rendered only once, until the page changes
+    std::string key;
+    if (RENDER_TYPE_PAGE_PREVIEW == type) {
+        ThumbnailCache* cache = this->sidebarPreview->sidebar->getThumbnailCache();
+        key = cache->makeKey(doc, this->sidebarPreview->page, cairo_image_surface_get_width(crBuffer),
+                             cairo_image_surface_get_height(crBuffer));
+    }
+    if (!key.empty() && loadCached(key)) {
+        doc->unlock();
+        finishPaint();
+        return;
+    }
+
+    if (RENDER_TYPE_PAGE_PREVIEW == type && drawFromPageBuffer()) {
+        doc->unlock();
+        if (!key.empty()) {
+            this->sidebarPreview->sidebar->getThumbnailCache()->store(key, crBuffer);
+        }
+        finishPaint();
+        return;
+    }
+
     int layer = -100;  // all layer
 
     if (RENDER_TYPE_PAGE_LAYER == type) {
@@ -105,5 +166,9 @@ void PreviewJob::run() {
 
     doc->unlock();
 
+    if (!key.empty()) {
+        this->sidebarPreview->sidebar->getThumbnailCache()->store(key, crBuffer);
+    }
+
     finishPaint();
 }
@@ -35,6 +35,8 @@ protected:
 public:
     virtual void* getSource();
 
+    virtual XojPage* getPage();
+
     virtual void run();
 
     virtual JobType getType();
@@ -46,6 +48,20 @@ private:
     void drawBackgroundPdf(Document* doc);
     void drawPage(int layer);
 
+    /**
+     * Scales the page down from the main view, if it is completely rendered there
+     *
+     * @return false if the page has to be rendered
+     */
+    bool drawFromPageBuffer();
+
+    /**
+     * Replaces the buffer by the preview cached on disk
+     *
+     * @return false if it is not cached
+     */
+    bool loadCached(const std::string& key);
+
 private:
     /**
      * Graphics buffer
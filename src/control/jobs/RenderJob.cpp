@@ -1,145 +1,459 @@
 #include "RenderJob.h"
 
 #include <cmath>
+#include <memory>
+#include <utility>
 
 #include "control/Control.h"
 #include "control/ToolHandler.h"
+#include "control/settings/Settings.h"
+#include "gui/CompressedTileCache.h"
+#include "gui/PageBufferSnapshot.h"
 #include "gui/PageView.h"
 #include "gui/XournalView.h"
 #include "model/Document.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
 #include "view/DocumentView.h"
 #include "view/PdfView.h"
+#include "view/RenderSnapshot.h"
 
 #include "Rectangle.h"
 #include "Util.h"
 
-RenderJob::RenderJob(XojPageView* view): view(view) {}
+/**
+ * Pages with more buffer pixels don't get a layer composite, it would need two more page buffers
+ */
+constexpr int64_t MAX_COMPOSITE_PIXELS = static_cast<int64_t>(8) * 1024 * 1024;
+
+RenderJob::RenderJob(XojPageView* view, bool prefetch): view(view), prefetch(prefetch) {}
 
 auto RenderJob::getSource() -> void* { return this->view; }
 
-void RenderJob::rerenderRectangle(Rectangle<double> const& rect) {
-    double zoom = view->xournal->getZoom();
+auto RenderJob::getPage() -> XojPage* { return this->view->page.get(); }
+
+auto RenderJob::isPrefetch() const -> bool { return this->prefetch; }
+
+/**
+ * Renders an area of the page, in buffer pixels at the given zoom
+ */
+auto RenderJob::renderArea(Rectangle<int> const& area, double zoom, bool* exactPdf, cairo_region_t const* clip)
+        -> cairo_surface_t* {
     Document* doc = view->xournal->getDocument();
     doc->lock();
     double pageWidth = view->page->getWidth();
     double pageHeight = view->page->getHeight();
+    bool pdfBackground = view->page->isLayerVisible(0) && view->page->getBackgroundType().isPdfPage();
+    XojPdfPageSPtr popplerPage;
+    if (pdfBackground) {
+        popplerPage = doc->getPdfPage(view->page->getPdfPageNr());
+    }
     doc->unlock();
 
-    auto x = int(std::lround(rect.x * zoom));
-    auto y = int(std::lround(rect.y * zoom));
-    auto width = int(std::lround(rect.width * zoom));
-    auto height = int(std::lround(rect.height * zoom));
-
-    cairo_surface_t* rectBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_surface_t* rectBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, area.width, area.height);
     cairo_t* crRect = cairo_create(rectBuffer);
-    cairo_translate(crRect, -x, -y);
+    cairo_translate(crRect, -area.x, -area.y);
+    if (clip) {
+        for (int i = 0; i < cairo_region_num_rectangles(clip); i++) {
+            cairo_rectangle_int_t r;
+            cairo_region_get_rectangle(clip, i, &r);
+            cairo_rectangle(crRect, r.x, r.y, r.width, r.height);
+        }
+        cairo_clip(crRect);
+    }
     cairo_scale(crRect, zoom, zoom);
 
-    DocumentView v;
     Control* control = view->getXournal()->getControl();
-    v.setMarkAudioStroke(control->getToolHandler()->getToolType() == TOOL_PLAY_OBJECT);
-    v.limitArea(rect.x, rect.y, rect.width, rect.height);
+    bool markAudioStroke = control->getToolHandler()->getToolType() == TOOL_PLAY_OBJECT;
+    if (renderFromComposite(crRect, area, zoom, markAudioStroke)) {
+        cairo_destroy(crRect);
+        return rectBuffer;
+    }
 
-    bool backgroundVisible = view->page->isLayerVisible(0);
-    if (backgroundVisible && view->page->getBackgroundType().isPdfPage()) {
-        int pgNo = view->page->getPdfPageNr();
-        XojPdfPageSPtr popplerPage = doc->getPdfPage(pgNo);
+    DocumentView v;
+    v.setMarkAudioStroke(markAudioStroke);
+    v.limitArea(area.x / zoom, area.y / zoom, area.width / zoom, area.height / zoom);
+
+    // The PDF is rendered without holding the document lock
+    if (pdfBackground) {
         PdfCache* cache = view->xournal->getCache();
-        PdfView::drawPage(cache, popplerPage, crRect, zoom, pageWidth, pageHeight);
+        bool exact = PdfView::drawPage(cache, popplerPage, crRect, zoom, pageWidth, pageHeight, false,
+                                       exactPdf != nullptr);
+        if (exactPdf) {
+            *exactPdf = exact;
+        }
     }
 
+    // Only the copy of the elements is made with the document locked, the page can be edited while it's drawn
     doc->lock();
-    v.drawPage(view->page, crRect, false);
+    v.initDrawing(view->page, crRect, false);
+    if (view->page->isLayerVisible(0)) {
+        v.drawBackground();
+    } else {
+        v.drawTransparentBackgroundPattern();
+    }
+    RenderSnapshot snapshot(view->page, 0, view->page->getLayerCount(), area.x / zoom, area.y / zoom,
+                            area.width / zoom, area.height / zoom);
     doc->unlock();
 
+    snapshot.draw(crRect, v, doc);
+    v.finializeDrawing();
+
     cairo_destroy(crRect);
 
-    g_mutex_lock(&view->drawingMutex);
+    return rectBuffer;
+}
 
-    cairo_t* crPageBuffer = cairo_create(view->crBuffer);
+auto RenderJob::getCompositeState(double zoom, bool markAudioStroke) -> LayerComposite::State {
+    LayerComposite::State state;
+    state.zoom = zoom;
+    state.width = static_cast<int>(std::ceil(view->page->getWidth() * zoom));
+    state.height = static_cast<int>(std::ceil(view->page->getHeight() * zoom));
+    state.selectedLayer = view->page->getSelectedLayerId();
+    state.backgroundVisible = view->page->isLayerVisible(0);
+    state.markAudioStroke = markAudioStroke;
+
+    int layerId = 1;
+    for (Layer* l: *view->page->getLayers()) {
+        bool changing = layerId == state.selectedLayer || !l->isVisible();
+        state.layerVersions.push_back(changing ? 0 : l->getVersion());
+        layerId++;
+    }
 
-    cairo_set_operator(crPageBuffer, CAIRO_OPERATOR_SOURCE);
-    cairo_set_source_surface(crPageBuffer, rectBuffer, x, y);
-    cairo_rectangle(crPageBuffer, x, y, width, height);
-    cairo_fill(crPageBuffer);
+    return state;
+}
 
-    cairo_destroy(crPageBuffer);
+/**
+ * The highlighter multiplies with the pixels below, on a transparent surface it would look different
+ */
+static auto containsHighlighter(Layer* l) -> bool {
+    for (Element* e: *l->getElements()) {
+        if (e->getType() == ELEMENT_STROKE && dynamic_cast<Stroke*>(e)->getToolType() == STROKE_TOOL_HIGHLIGHTER) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    cairo_surface_destroy(rectBuffer);
+void RenderJob::updateComposite(double zoom, bool markAudioStroke) {
+    Control* control = view->getXournal()->getControl();
+    if (!control->getSettings()->isCacheLayerComposites()) {
+        view->layerComposite.clear();
+        return;
+    }
 
-    g_mutex_unlock(&view->drawingMutex);
+    Document* doc = view->xournal->getDocument();
+    doc->lock();
+
+    LayerComposite::State state = getCompositeState(zoom, markAudioStroke);
+    if (view->layerComposite.matches(state)) {
+        doc->unlock();
+        return;
+    }
+
+    PageType background = view->page->getBackgroundType();
+    bool pdfBackground = state.backgroundVisible && background.isPdfPage();
+    bool otherContent = state.backgroundVisible && (pdfBackground || background.isImagePage());
+    for (uint64_t version: state.layerVersions) {
+        otherContent = otherContent || version != 0;
+    }
+
+    XojPdfPageSPtr popplerPage;
+    if (pdfBackground) {
+        popplerPage = doc->getPdfPage(view->page->getPdfPageNr());
+    }
+    double pageWidth = view->page->getWidth();
+    double pageHeight = view->page->getHeight();
+    doc->unlock();
+
+    if (state.selectedLayer == 0 || !otherContent ||
+        static_cast<int64_t>(state.width) * state.height > MAX_COMPOSITE_PIXELS) {
+        view->layerComposite.clear();
+        return;
+    }
+
+    cairo_surface_t* below = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, state.width, state.height);
+    cairo_t* crBelow = cairo_create(below);
+    cairo_scale(crBelow, zoom, zoom);
+
+    // Like renderArea(), the PDF is rendered without holding the document lock
+    if (pdfBackground) {
+        PdfView::drawPage(view->xournal->getCache(), popplerPage, crBelow, zoom, pageWidth, pageHeight, false, false);
+    }
+
+    cairo_surface_t* above = nullptr;
+    bool aboveCached = true;
+
+    doc->lock();
+
+    // The page may have changed while the PDF was rendered
+    LayerComposite::State current = getCompositeState(zoom, markAudioStroke);
+    if (current.width != state.width || current.height != state.height) {
+        doc->unlock();
+        cairo_destroy(crBelow);
+        cairo_surface_destroy(below);
+        return;
+    }
+    state = std::move(current);
+
+    DocumentView v;
+    v.setMarkAudioStroke(markAudioStroke);
+    v.initDrawing(view->page, crBelow, false);
+    if (state.backgroundVisible) {
+        v.drawBackground();
+    } else {
+        v.drawTransparentBackgroundPattern();
+    }
+
+    std::vector<Layer*> const& layers = *view->page->getLayers();
+    size_t selected = state.selectedLayer - 1;
+    RenderSnapshot belowSnapshot(view->page, 0, selected, 0, 0, pageWidth, pageHeight);
+
+    bool aboveEmpty = true;
+    for (size_t i = selected + 1; i < layers.size(); i++) {
+        if (layers[i]->isVisible() && layers[i]->isAnnotated()) {
+            aboveEmpty = false;
+            aboveCached = aboveCached && !containsHighlighter(layers[i]);
+        }
+    }
+
+    std::unique_ptr<RenderSnapshot> aboveSnapshot;
+    if (aboveCached && !aboveEmpty) {
+        aboveSnapshot = std::make_unique<RenderSnapshot>(view->page, selected + 1, layers.size(), 0, 0, pageWidth,
+                                                         pageHeight);
+    }
+
+    doc->unlock();
+
+    belowSnapshot.draw(crBelow, v, doc);
+    v.finializeDrawing();
+    cairo_destroy(crBelow);
+
+    if (aboveSnapshot) {
+        above = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, state.width, state.height);
+        cairo_t* crAbove = cairo_create(above);
+        cairo_scale(crAbove, zoom, zoom);
+
+        DocumentView vAbove;
+        vAbove.setMarkAudioStroke(markAudioStroke);
+        vAbove.initDrawing(view->page, crAbove, false);
+        aboveSnapshot->draw(crAbove, vAbove, doc);
+        vAbove.finializeDrawing();
+
+        cairo_destroy(crAbove);
+    }
+
+    view->layerComposite.set(std::move(state), below, above, aboveCached);
 }
 
-void RenderJob::run() {
-    double zoom = this->view->xournal->getZoom();
+/**
+ * Paints a composite surface in buffer pixels to cr, which is scaled by zoom
+ */
+static void paintCompositeSurface(cairo_t* cr, cairo_surface_t* surface, double zoom, cairo_operator_t op) {
+    cairo_save(cr);
+    cairo_scale(cr, 1 / zoom, 1 / zoom);
+    cairo_set_operator(cr, op);
+    cairo_set_source_surface(cr, surface, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
 
-    g_mutex_lock(&this->view->repaintRectMutex);
+auto RenderJob::renderFromComposite(cairo_t* cr, Rectangle<int> const& area, double zoom, bool markAudioStroke)
+        -> bool {
+    Document* doc = view->xournal->getDocument();
+    doc->lock();
 
-    bool rerenderComplete = this->view->rerenderComplete;
-    auto rerenderRects = std::move(this->view->rerenderRects);
+    cairo_surface_t* below = nullptr;
+    cairo_surface_t* above = nullptr;
+    bool aboveCached = false;
+    LayerComposite::State state = getCompositeState(zoom, markAudioStroke);
+    if (!view->layerComposite.get(state, below, above, aboveCached)) {
+        doc->unlock();
+        return false;
+    }
 
-    this->view->rerenderComplete = false;
+    DocumentView v;
+    v.setMarkAudioStroke(markAudioStroke);
+    v.initDrawing(view->page, cr, false);
 
-    g_mutex_unlock(&this->view->repaintRectMutex);
+    // The selected layer, and the layers above if they are not in the composite
+    size_t selected = state.selectedLayer - 1;
+    size_t end = aboveCached ? selected + 1 : view->page->getLayerCount();
+    RenderSnapshot snapshot(view->page, selected, end, area.x / zoom, area.y / zoom, area.width / zoom,
+                            area.height / zoom);
 
-    int dpiScaleFactor = this->view->xournal->getDpiScaleFactor();
+    doc->unlock();
 
-    if (rerenderComplete || dpiScaleFactor > 1) {
-        Document* doc = this->view->xournal->getDocument();
+    paintCompositeSurface(cr, below, zoom, CAIRO_OPERATOR_SOURCE);
+    snapshot.draw(cr, v, doc);
+    v.finializeDrawing();
 
-        int dispWidth = this->view->getDisplayWidth();
-        int dispHeight = this->view->getDisplayHeight();
+    if (above) {
+        paintCompositeSurface(cr, above, zoom, CAIRO_OPERATOR_OVER);
+        cairo_surface_destroy(above);
+    }
+    cairo_surface_destroy(below);
 
-        dispWidth *= dpiScaleFactor;
-        dispHeight *= dpiScaleFactor;
-        zoom *= dpiScaleFactor;
+    return true;
+}
 
-        cairo_surface_t* crBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, dispWidth, dispHeight);
-        cairo_t* cr2 = cairo_create(crBuffer);
-        cairo_scale(cr2, zoom, zoom);
+void RenderJob::rerenderRegion(cairo_region_t* region, double zoom) {
+    if (cairo_region_is_empty(region)) {
+        return;
+    }
 
-        XojPdfPageSPtr popplerPage;
+    // To buffer pixels, rounded outwards
+    cairo_region_t* pixels = cairo_region_create();
+    for (int i = 0; i < cairo_region_num_rectangles(region); i++) {
+        cairo_rectangle_int_t r;
+        cairo_region_get_rectangle(region, i, &r);
+
+        int x1 = static_cast<int>(std::floor(r.x * zoom));
+        int y1 = static_cast<int>(std::floor(r.y * zoom));
+        cairo_rectangle_int_t scaled = {x1, y1, static_cast<int>(std::ceil((r.x + r.width) * zoom)) - x1,
+                                        static_cast<int>(std::ceil((r.y + r.height) * zoom)) - y1};
+        cairo_region_union_rectangle(pixels, &scaled);
+    }
 
-        doc->lock();
+    cairo_rectangle_int_t extents;
+    cairo_region_get_extents(pixels, &extents);
+    Rectangle<int> area(extents.x, extents.y, extents.width, extents.height);
 
-        if (this->view->page->getBackgroundType().isPdfPage()) {
-            int pgNo = this->view->page->getPdfPageNr();
-            popplerPage = doc->getPdfPage(pgNo);
-        }
+    Control* control = view->getXournal()->getControl();
+    updateComposite(zoom, control->getToolHandler()->getToolType() == TOOL_PLAY_OBJECT);
 
-        Control* control = view->getXournal()->getControl();
-        DocumentView localView;
-        localView.setMarkAudioStroke(control->getToolHandler()->getToolType() == TOOL_PLAY_OBJECT);
-        int width = this->view->page->getWidth();
-        int height = this->view->page->getHeight();
+    cairo_surface_t* rectBuffer = renderArea(area, zoom, nullptr, pixels);
 
-        bool backgroundVisible = this->view->page->isLayerVisible(0);
-        if (backgroundVisible) {
-            PdfView::drawPage(this->view->xournal->getCache(), popplerPage, cr2, zoom, width, height);
+    g_mutex_lock(&view->drawingMutex);
+
+    // Only update the tiles which are already there, missing tiles are rendered completely if they get visible
+    view->buffer.drawOnTiles(zoom, area, [&](cairo_t* crTile) {
+        cairo_set_operator(crTile, CAIRO_OPERATOR_SOURCE);
+        cairo_set_source_surface(crTile, rectBuffer, area.x, area.y);
+        for (int i = 0; i < cairo_region_num_rectangles(pixels); i++) {
+            cairo_rectangle_int_t r;
+            cairo_region_get_rectangle(pixels, i, &r);
+            cairo_rectangle(crTile, r.x, r.y, r.width, r.height);
         }
-        localView.drawPage(this->view->page, cr2, false);
+        cairo_fill(crTile);
+    });
+    view->buffer.dropOtherZooms(zoom);
+
+    // Tiles stored by the memory cleanup while the region was rendered are outdated
+    CompressedTileCache::getInstance().invalidate(view);
+
+    g_mutex_unlock(&view->drawingMutex);
+
+    cairo_surface_destroy(rectBuffer);
+    cairo_region_destroy(pixels);
+}
+
+void RenderJob::run() {
+    // The buffer is rendered with the DPI scale factor, so it is sharp on HiDPI screens
+    double zoom = this->view->getBufferZoom();
 
-        cairo_destroy(cr2);
+    g_mutex_lock(&this->view->repaintRectMutex);
 
+    bool rerenderComplete = this->view->rerenderComplete;
+    cairo_region_t* region = this->view->rerenderRegion;
+
+    this->view->rerenderRegion = cairo_region_create();
+    this->view->rerenderComplete = false;
+
+    g_mutex_unlock(&this->view->repaintRectMutex);
+
+    if (rerenderComplete) {
+        // The outdated tiles are still shown until they are replaced
         g_mutex_lock(&this->view->drawingMutex);
+        this->view->buffer.invalidateAll();
+        g_mutex_unlock(&this->view->drawingMutex);
+    } else {
+        rerenderRegion(region, zoom);
+    }
+    cairo_region_destroy(region);
+
+    // Render the missing and outdated tiles in the visible area
+    g_mutex_lock(&this->view->drawingMutex);
+    std::vector<TiledPageBuffer::TileKey> tiles = this->view->buffer.getTilesToRender(zoom);
+    std::vector<Rectangle<int>> areas;
+    for (auto const& key: tiles) {
+        areas.push_back(this->view->buffer.getTileArea(key));
+    }
+    g_mutex_unlock(&this->view->drawingMutex);
+
+    // The PDF background may be taken from another zoom at first, it's shown until the exact resolution is rendered
+    std::vector<size_t> approximated;
+    gint64 renderStart = g_get_monotonic_time();
+    int64_t renderedPixels = 0;
+    for (size_t i = 0; i < tiles.size(); i++) {
+        cairo_surface_t* restored =
+                CompressedTileCache::getInstance().restore(this->view, tiles[i], areas[i].width, areas[i].height);
+        if (restored) {
+            g_mutex_lock(&this->view->drawingMutex);
+            this->view->buffer.setTile(tiles[i], restored);
+            g_mutex_unlock(&this->view->drawingMutex);
+            continue;
+        }
 
-        if (this->view->crBuffer) {
-            cairo_surface_destroy(this->view->crBuffer);
+        bool exactPdf = true;
+        cairo_surface_t* tile = renderArea(areas[i], zoom, &exactPdf);
+        if (!exactPdf) {
+            approximated.push_back(i);
         }
-        this->view->crBuffer = crBuffer;
 
+        g_mutex_lock(&this->view->drawingMutex);
+        this->view->buffer.setTile(tiles[i], tile);
         g_mutex_unlock(&this->view->drawingMutex);
-        doc->unlock();
-    } else {
-        for (Rectangle<double> const& rect: rerenderRects) {
-            rerenderRectangle(rect);
+
+        renderedPixels += static_cast<int64_t>(areas[i].width) * areas[i].height;
+    }
+
+    // The memory cleanup prefers to keep pages which are expensive to render
+    if (renderedPixels > 0) {
+        double micros = static_cast<double>(g_get_monotonic_time() - renderStart) / renderedPixels;
+        g_mutex_lock(&this->view->drawingMutex);
+        this->view->renderMicrosPerPixel = micros;
+        g_mutex_unlock(&this->view->drawingMutex);
+    }
+
+    if (!approximated.empty()) {
+        repaintWidget(this->view->getXournal()->getWidget());
+
+        for (size_t i: approximated) {
+            cairo_surface_t* tile = renderArea(areas[i], zoom);
+
+            g_mutex_lock(&this->view->drawingMutex);
+            this->view->buffer.setTile(tiles[i], tile);
+            g_mutex_unlock(&this->view->drawingMutex);
         }
     }
 
+    publishSnapshot(zoom);
+
     // Schedule a repaint of the widget
     repaintWidget(this->view->getXournal()->getWidget());
 }
 
+void RenderJob::publishSnapshot(double zoom) {
+    g_mutex_lock(&this->view->drawingMutex);
+    std::shared_ptr<PageBufferSnapshot> snapshot = this->view->buffer.createSnapshot(zoom);
+    g_mutex_unlock(&this->view->drawingMutex);
+
+    if (!snapshot) {
+        return;
+    }
+
+    // addRerenderRect() marks the change with this lock before it removes the snapshot,
+    // so a snapshot of outdated tiles is either not published or removed afterwards
+    g_mutex_lock(&this->view->repaintRectMutex);
+    bool pending = this->view->rerenderComplete || !cairo_region_is_empty(this->view->rerenderRegion);
+    if (!pending) {
+        this->view->getXournal()->setPageSnapshot(this->view->getPage().get(), std::move(snapshot));
+    }
+    // Otherwise another render job follows
+    g_mutex_unlock(&this->view->repaintRectMutex);
+}
+
 /**
  * Repaint the widget in UI Thread
  */
@@ -16,6 +16,8 @@
 
 #include <gtk/gtk.h>
 
+#include "gui/LayerComposite.h"
+
 #include "Job.h"
 #include "Rectangle.h"
 #include "XournalType.h"
@@ -24,7 +26,10 @@ class XojPageView;
 
 class RenderJob: public Job {
 public:
-    RenderJob(XojPageView* view);
+    /**
+     * @param prefetch The page is rendered before it gets visible, the job may be removed if it's not needed anymore
+     */
+    RenderJob(XojPageView* view, bool prefetch = false);
 
 protected:
     virtual ~RenderJob() = default;
@@ -34,6 +39,10 @@ public:
 
     void* getSource();
 
+    XojPage* getPage();
+
+    bool isPrefetch() const;
+
     void run();
 
 private:
@@ -42,8 +51,45 @@ private:
      */
     static void repaintWidget(GtkWidget* widget);
 
-    void rerenderRectangle(Rectangle<double> const& rect);
+    /**
+     * Offers the page buffer to the sidebar preview, if the whole page is rendered and up to date
+     */
+    void publishSnapshot(double zoom);
+
+    /**
+     * Rerenders a region in page coordinates on the tiles, in one pass
+     */
+    void rerenderRegion(cairo_region_t* region, double zoom);
+
+    /**
+     * Renders an area of the page, in buffer pixels at the given zoom
+     *
+     * @param exactPdf If not nullptr, the PDF background may be painted with another cached resolution,
+     *                 exactPdf is set to false in this case
+     * @param clip If not nullptr, only this region (in buffer pixels) is rendered
+     */
+    cairo_surface_t* renderArea(Rectangle<int> const& area, double zoom, bool* exactPdf = nullptr,
+                                cairo_region_t const* clip = nullptr);
+
+    /**
+     * @return the state of the page which the layer composite has to match, called with the document locked
+     */
+    LayerComposite::State getCompositeState(double zoom, bool markAudioStroke);
+
+    /**
+     * Renders the layers below and above the selected layer again, if they changed
+     * and the page has content besides the selected layer
+     */
+    void updateComposite(double zoom, bool markAudioStroke);
+
+    /**
+     * Paints the layer composite with the selected layer in between to cr, which is scaled by zoom
+     *
+     * @return false if there is no composite for the current state of the page, nothing is painted then
+     */
+    bool renderFromComposite(cairo_t* cr, Rectangle<int> const& area, double zoom, bool markAudioStroke);
 
 private:
     XojPageView* view;
+    bool prefetch;
 };
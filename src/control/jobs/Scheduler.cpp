@@ -1,5 +1,6 @@
 #include "Scheduler.h"
 
+#include <algorithm>
 #include <cinttypes>
 
 #include <config-debug.h>
@@ -10,15 +11,26 @@
 #define SDEBUG(msg, ...)
 #endif
 
-Scheduler::Scheduler() {
+/**
+ * Upper limit for the automatically chosen count of worker threads
+ */
+constexpr int MAX_AUTO_THREAD_COUNT = 4;
+
+Scheduler::Scheduler(int threadCount) {
     this->name = "Scheduler";
 
+    if (threadCount <= 0) {
+        // Keep one processor for the UI thread
+        threadCount = std::clamp(static_cast<int>(g_get_num_processors()) - 1, 1, MAX_AUTO_THREAD_COUNT);
+    }
+    this->threadCount = threadCount;
+
     // Thread
     g_cond_init(&this->jobQueueCond);
+    g_cond_init(&this->jobFinishedCond);
 
     g_mutex_init(&this->jobQueueMutex);
-    g_mutex_init(&this->jobRunningMutex);
-    g_mutex_init(&this->schedulerMutex);
+    g_rw_lock_init(&this->schedulerLock);
     g_mutex_init(&this->blockRenderMutex);
 
     // Queue
@@ -36,13 +48,13 @@ Scheduler::Scheduler() {
 Scheduler::~Scheduler() {
     SDEBUG("Destroy scheduler");
 
+    stop();
+
     if (this->jobRenderThreadTimerId) {
         g_source_remove(this->jobRenderThreadTimerId);
         this->jobRenderThreadTimerId = 0;
     }
 
-    stop();
-
     Job* job = nullptr;
     while ((job = getNextJobUnlocked()) != nullptr) {
         job->unref();
@@ -51,13 +63,22 @@ Scheduler::~Scheduler() {
     if (this->blockRenderZoomTime) {
         g_free(this->blockRenderZoomTime);
     }
+
+    g_cond_clear(&this->jobQueueCond);
+    g_cond_clear(&this->jobFinishedCond);
+    g_mutex_clear(&this->jobQueueMutex);
+    g_rw_lock_clear(&this->schedulerLock);
+    g_mutex_clear(&this->blockRenderMutex);
 }
 
 void Scheduler::start() {
     SDEBUG("Starting scheduler");
-    g_return_if_fail(this->thread == nullptr);
+    g_return_if_fail(this->threads.empty());
 
-    this->thread = g_thread_new(name.c_str(), reinterpret_cast<GThreadFunc>(jobThreadCallback), this);
+    for (int i = 0; i < this->threadCount; i++) {
+        this->threads.push_back(
+                g_thread_new(name.c_str(), reinterpret_cast<GThreadFunc>(jobThreadCallback), this));
+    }
 }
 
 void Scheduler::stop() {
@@ -66,12 +87,15 @@ void Scheduler::stop() {
     if (!this->threadRunning) {
         return;
     }
+    g_mutex_lock(&this->jobQueueMutex);
     this->threadRunning = false;
     g_cond_broadcast(&this->jobQueueCond);
+    g_mutex_unlock(&this->jobQueueMutex);
 
-    if (this->thread) {
-        g_thread_join(this->thread);
+    for (GThread* thread: this->threads) {
+        g_thread_join(thread);
     }
+    this->threads.clear();
 }
 
 void Scheduler::addJob(Job* job, JobPriority priority) {
@@ -88,42 +112,82 @@ void Scheduler::addJob(Job* job, JobPriority priority) {
     g_mutex_unlock(&this->jobQueueMutex);
 }
 
+auto Scheduler::isParallelJob(Job* job) -> bool {
+    JobType type = job->getType();
+    return type == JOB_TYPE_RENDER || type == JOB_TYPE_PREVIEW;
+}
+
+/**
+ * Returns the job with the highest priority which may be started now:
+ * no job runs beside an exclusive job, and a source or a page is never processed by two threads at once
+ */
 auto Scheduler::getNextJobUnlocked(bool onlyNotRender, bool* hasRenderJobs) -> Job* {
-    Job* job = nullptr;
+    if (this->exclusiveJobRunning || this->lockRequests > 0) {
+        return nullptr;
+    }
 
     for (int i = JOB_PRIORITY_URGENT; i < JOB_N_PRIORITIES; i++) {
-        if (onlyNotRender) {
-            for (GList* l = this->jobQueue[i]->head; l != nullptr; l = l->next) {
-                job = static_cast<Job*>(l->data);
+        for (GList* l = this->jobQueue[i]->head; l != nullptr; l = l->next) {
+            auto* job = static_cast<Job*>(l->data);
 
-                if (job->getType() != JOB_TYPE_RENDER) {
-                    g_queue_delete_link(this->jobQueue[i], l);
-                    return job;
-                }
+            if (onlyNotRender && job->getType() == JOB_TYPE_RENDER) {
                 if (hasRenderJobs) {
                     *hasRenderJobs = true;
                 }
+                continue;
             }
-        } else {
-            job = static_cast<Job*>(g_queue_pop_head(this->jobQueue[i]));
-            if (job) {
-                return job;
+
+            if (isParallelJob(job)) {
+                if (job->getSource() && this->runningSources.count(job->getSource())) {
+                    continue;
+                }
+                if (job->getPage() && this->runningPages.count(job->getPage())) {
+                    continue;
+                }
+            } else if (this->runningJobs > 0) {
+                continue;
             }
+
+            g_queue_delete_link(this->jobQueue[i], l);
+            return job;
         }
     }
 
     return nullptr;
 }
 
+void Scheduler::waitForRunningJobsUnlocked(void* source) {
+    while (source == nullptr ? this->runningJobs > 0 : this->runningSources.count(source) > 0) {
+        g_cond_wait(&this->jobFinishedCond, &this->jobQueueMutex);
+    }
+}
+
 /**
  * Locks the complete scheduler
  */
-void Scheduler::lock() { g_mutex_lock(&this->schedulerMutex); }
+void Scheduler::lock() {
+    // Don't start new jobs, else the workers may keep the lock shared forever
+    g_mutex_lock(&this->jobQueueMutex);
+    this->lockRequests++;
+    g_mutex_unlock(&this->jobQueueMutex);
+
+    g_rw_lock_writer_lock(&this->schedulerLock);
+
+    g_mutex_lock(&this->jobQueueMutex);
+    this->lockRequests--;
+    g_mutex_unlock(&this->jobQueueMutex);
+}
 
 /**
  * Unlocks the complete scheduler
  */
-void Scheduler::unlock() { g_mutex_unlock(&this->schedulerMutex); }
+void Scheduler::unlock() {
+    g_rw_lock_writer_unlock(&this->schedulerLock);
+
+    g_mutex_lock(&this->jobQueueMutex);
+    g_cond_broadcast(&this->jobQueueCond);
+    g_mutex_unlock(&this->jobQueueMutex);
+}
 
 #define ZOOM_WAIT_US_TIMEOUT 300000  // 0.3s
 
@@ -145,14 +209,16 @@ void Scheduler::unblockRerenderZoom() {
 
     g_free(this->blockRenderZoomTime);
     this->blockRenderZoomTime = nullptr;
+
+    g_mutex_unlock(&this->blockRenderMutex);
+
+    g_mutex_lock(&this->jobQueueMutex);
     if (this->jobRenderThreadTimerId) {
         g_source_remove(this->jobRenderThreadTimerId);
         this->jobRenderThreadTimerId = 0;
     }
-
-    g_mutex_unlock(&this->blockRenderMutex);
-
     g_cond_broadcast(&this->jobQueueCond);
+    g_mutex_unlock(&this->jobQueueMutex);
 }
 
 /**
@@ -177,22 +243,26 @@ auto g_time_val_diff(GTimeVal* t1, GTimeVal* t2) -> glong {
  * we need to wakeup it later
  */
 auto Scheduler::jobRenderThreadTimer(Scheduler* scheduler) -> bool {
-    scheduler->jobRenderThreadTimerId = 0;
-
     g_mutex_lock(&scheduler->blockRenderMutex);
     g_free(scheduler->blockRenderZoomTime);
     scheduler->blockRenderZoomTime = nullptr;
     g_mutex_unlock(&scheduler->blockRenderMutex);
 
+    g_mutex_lock(&scheduler->jobQueueMutex);
+    // A worker may have replaced the timer meanwhile
+    if (scheduler->jobRenderThreadTimerId == g_source_get_id(g_main_current_source())) {
+        scheduler->jobRenderThreadTimerId = 0;
+    }
     g_cond_broadcast(&scheduler->jobQueueCond);
+    g_mutex_unlock(&scheduler->jobQueueMutex);
 
     return false;
 }
 
 auto Scheduler::jobThreadCallback(Scheduler* scheduler) -> gpointer {
     while (scheduler->threadRunning) {
-        // lock the whole scheduler
-        g_mutex_lock(&scheduler->schedulerMutex);
+        // lock the whole scheduler, the other worker threads share this lock
+        g_rw_lock_reader_lock(&scheduler->schedulerLock);
 
         g_mutex_lock(&scheduler->blockRenderMutex);
         bool onlyNoneRenderJobs = false;
@@ -212,6 +282,12 @@ auto Scheduler::jobThreadCallback(Scheduler* scheduler) -> gpointer {
         g_mutex_unlock(&scheduler->blockRenderMutex);
 
         g_mutex_lock(&scheduler->jobQueueMutex);
+        if (!scheduler->threadRunning) {
+            g_mutex_unlock(&scheduler->jobQueueMutex);
+            g_rw_lock_reader_unlock(&scheduler->schedulerLock);
+            break;
+        }
+
         bool hasOnlyRenderJobs = false;
         Job* job = scheduler->getNextJobUnlocked(onlyNoneRenderJobs, &hasOnlyRenderJobs);
         if (job != nullptr) {
@@ -222,7 +298,7 @@ auto Scheduler::jobThreadCallback(Scheduler* scheduler) -> gpointer {
 
         if (job == nullptr) {
             // unlock the whole scheduler
-            g_mutex_unlock(&scheduler->schedulerMutex);
+            g_rw_lock_reader_unlock(&scheduler->schedulerLock);
 
             if (hasOnlyRenderJobs) {
                 if (scheduler->jobRenderThreadTimerId) {
@@ -240,17 +316,34 @@ auto Scheduler::jobThreadCallback(Scheduler* scheduler) -> gpointer {
 
         SDEBUG("do job: %" PRId64, (uint64_t)job);
 
-        g_mutex_unlock(&scheduler->jobQueueMutex);
+        void* source = job->getSource();
+        XojPage* page = job->getPage();
+        bool exclusive = !isParallelJob(job);
+        scheduler->runningJobs++;
+        scheduler->exclusiveJobRunning = exclusive;
+        scheduler->runningSources.insert(source);
+        scheduler->runningPages.insert(page);
 
-        g_mutex_lock(&scheduler->jobRunningMutex);
+        g_mutex_unlock(&scheduler->jobQueueMutex);
 
         job->execute();
 
         job->unref();
-        g_mutex_unlock(&scheduler->jobRunningMutex);
+
+        g_mutex_lock(&scheduler->jobQueueMutex);
+        scheduler->runningJobs--;
+        if (exclusive) {
+            scheduler->exclusiveJobRunning = false;
+        }
+        scheduler->runningSources.erase(scheduler->runningSources.find(source));
+        scheduler->runningPages.erase(scheduler->runningPages.find(page));
+        g_cond_broadcast(&scheduler->jobFinishedCond);
+        // Jobs skipped while this one was running may be started now
+        g_cond_broadcast(&scheduler->jobQueueCond);
+        g_mutex_unlock(&scheduler->jobQueueMutex);
 
         // unlock the whole scheduler
-        g_mutex_unlock(&scheduler->schedulerMutex);
+        g_rw_lock_reader_unlock(&scheduler->schedulerLock);
 
         SDEBUG("next");
     }
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -61,7 +62,10 @@ enum JobPriority {
 
 class Scheduler {
 public:
-    Scheduler();
+    /**
+     * @param threadCount The count of worker threads, 0 to use a count depending on the processor count
+     */
+    explicit Scheduler(int threadCount = 1);
     virtual ~Scheduler();
 
 public:
@@ -79,7 +83,7 @@ public:
     void stop();
 
     /**
-     * Locks the complete scheduler
+     * Locks the complete scheduler, blocks until no job is running anymore
      */
     void lock();
 
@@ -102,24 +106,55 @@ private:
     static gpointer jobThreadCallback(Scheduler* scheduler);
     Job* getNextJobUnlocked(bool onlyNotRender = false, bool* hasRenderJobs = nullptr);
 
+    /**
+     * Render and preview jobs of different pages may run in parallel, all other jobs (saving, autosave...) run alone
+     */
+    static bool isParallelJob(Job* job);
+
     static bool jobRenderThreadTimer(Scheduler* scheduler);
 
+protected:
+    /**
+     * Blocks until no job of this source is running anymore, jobQueueMutex has to be locked
+     *
+     * @param source The source, nullptr to wait for all jobs
+     */
+    void waitForRunningJobsUnlocked(void* source);
+
 protected:
     bool threadRunning = true;
 
-    int jobRenderThreadTimerId = 0;
+    /**
+     * Protected by jobQueueMutex
+     */
+    guint jobRenderThreadTimerId = 0;
 
-    GThread* thread = nullptr;
+    int threadCount = 1;
+    std::vector<GThread*> threads;
 
     GCond jobQueueCond{};
     GMutex jobQueueMutex{};
 
-    GMutex schedulerMutex{};
+    /**
+     * Held for reading by the worker threads while they take and execute a job,
+     * and for writing by lock()
+     */
+    GRWLock schedulerLock{};
+
+    /**
+     * Count of threads waiting in lock(), no new job is started meanwhile
+     */
+    int lockRequests = 0;
 
     /**
      * This is need to be sure there is no job running if we delete a page, else we may access delete memory...
+     * Protected by jobQueueMutex, jobFinishedCond is signaled if a job is done
      */
-    GMutex jobRunningMutex{};
+    int runningJobs = 0;
+    bool exclusiveJobRunning = false;
+    std::multiset<void*> runningSources;
+    std::multiset<XojPage*> runningPages;
+    GCond jobFinishedCond{};
 
     GQueue queueUrgent{};
     GQueue queueHigh{};
@@ -3,11 +3,7 @@
 #include "PreviewJob.h"
 #include "RenderJob.h"
 
-XournalScheduler::XournalScheduler()
-
-{
-    this->name = "XournalScheduler";
-}
+XournalScheduler::XournalScheduler(int threadCount): Scheduler(threadCount) { this->name = "XournalScheduler"; }
 
 XournalScheduler::~XournalScheduler() = default;
 
@@ -15,7 +11,10 @@ void XournalScheduler::removeSidebar(SidebarPreviewBaseEntry* preview) {
     removeSource(preview, JOB_TYPE_PREVIEW, JOB_PRIORITY_HIGH);
 }
 
-void XournalScheduler::removePage(XojPageView* view) { removeSource(view, JOB_TYPE_RENDER, JOB_PRIORITY_URGENT); }
+void XournalScheduler::removePage(XojPageView* view) {
+    removeSource(view, JOB_TYPE_RENDER, JOB_PRIORITY_URGENT);
+    removeSource(view, JOB_TYPE_RENDER, JOB_PRIORITY_LOW);
+}
 
 void XournalScheduler::removeAllJobs() {
     g_mutex_lock(&this->jobQueueMutex);
@@ -38,8 +37,9 @@ void XournalScheduler::removeAllJobs() {
 }
 
 void XournalScheduler::finishTask() {
-    g_mutex_lock(&this->jobRunningMutex);
-    g_mutex_unlock(&this->jobRunningMutex);
+    g_mutex_lock(&this->jobQueueMutex);
+    waitForRunningJobsUnlocked(nullptr);
+    g_mutex_unlock(&this->jobQueueMutex);
 }
 
 void XournalScheduler::removeSource(void* source, JobType type, JobPriority priority) {
@@ -59,9 +59,9 @@ void XournalScheduler::removeSource(void* source, JobType type, JobPriority prio
         }
     }
 
-    // wait until the last job is done
+    // wait until the running job of this source is done
     // we can be sure we don't access "source"
-    finishTask();
+    waitForRunningJobsUnlocked(source);
 
     g_mutex_unlock(&this->jobQueueMutex);
 }
@@ -106,3 +106,35 @@ void XournalScheduler::addRerenderPage(XojPageView* view) {
     addJob(job, JOB_PRIORITY_URGENT);
     job->unref();
 }
+
+void XournalScheduler::addPrefetchPage(XojPageView* view) {
+    if (existsSource(view, JOB_TYPE_RENDER, JOB_PRIORITY_URGENT) ||
+        existsSource(view, JOB_TYPE_RENDER, JOB_PRIORITY_LOW)) {
+        return;
+    }
+
+    auto* job = new RenderJob(view, true);
+    addJob(job, JOB_PRIORITY_LOW);
+    job->unref();
+}
+
+void XournalScheduler::removePrefetchJobs() {
+    g_mutex_lock(&this->jobQueueMutex);
+
+    GQueue* queue = this->jobQueue[JOB_PRIORITY_LOW];
+    for (GList* l = queue->head; l != nullptr;) {
+        auto* job = static_cast<Job*>(l->data);
+        GList* next = l->next;
+
+        if (job->getType() == JOB_TYPE_RENDER && static_cast<RenderJob*>(job)->isPrefetch()) {
+            // Not rendered, so it doesn't count for the prefetch memory anymore
+            static_cast<XojPageView*>(job->getSource())->clearPrefetch();
+            job->deleteJob();
+            g_queue_delete_link(queue, l);
+            job->unref();
+        }
+        l = next;
+    }
+
+    g_mutex_unlock(&this->jobQueueMutex);
+}
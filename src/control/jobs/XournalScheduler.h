@@ -24,7 +24,7 @@
 
 class XournalScheduler: public Scheduler {
 public:
-    XournalScheduler();
+    explicit XournalScheduler(int threadCount);
     virtual ~XournalScheduler();
 
 public:
@@ -42,6 +42,16 @@ public:
     void addRepaintSidebar(SidebarPreviewBaseEntry* preview);
     void addRerenderPage(XojPageView* view);
 
+    /**
+     * Renders a page with low priority, before it gets visible
+     */
+    void addPrefetchPage(XojPageView* view);
+
+    /**
+     * Removes the queued prefetch jobs, e.g. if the scroll direction changed
+     */
+    void removePrefetchJobs();
+
     /**
      * Blocks until all currently running Job%s have been executed
      */
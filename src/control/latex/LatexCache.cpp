@@ -0,0 +1,90 @@
+#include "LatexCache.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <glib.h>
+
+#include "PathUtil.h"
+
+LatexCache::LatexCache(fs::path dir, uintmax_t maxBytes): dir(std::move(dir)), maxBytes(maxBytes) {
+    Util::ensureFolderExists(this->dir);
+}
+
+auto LatexCache::makeKey(const std::string& texContents, const std::string& genCmd) -> std::string {
+    GChecksum* checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(checksum, reinterpret_cast<const guchar*>(genCmd.c_str()), genCmd.length());
+    // Separate the command from the file, so different splits don't give the same hash
+    g_checksum_update(checksum, reinterpret_cast<const guchar*>(""), 1);
+    g_checksum_update(checksum, reinterpret_cast<const guchar*>(texContents.c_str()), texContents.length());
+    std::string key = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+    return key;
+}
+
+auto LatexCache::getPath(const std::string& key) const -> fs::path { return this->dir / (key + ".pdf"); }
+
+auto LatexCache::lookup(const std::string& key) -> std::optional<std::string> {
+    fs::path path = getPath(key);
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) {
+        return std::nullopt;
+    }
+
+    auto contents = Util::readString(path, false);
+    if (contents) {
+        // The modification time is the time of the last use
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    }
+    return contents;
+}
+
+void LatexCache::store(const std::string& key, const std::string& pdf) {
+    if (this->maxBytes == 0) {
+        return;
+    }
+
+    GError* err = nullptr;
+    // Written to a temporary file and renamed, so no other instance reads a partial file
+    if (!g_file_set_contents(getPath(key).u8string().c_str(), pdf.c_str(), pdf.length(), &err)) {
+        g_warning("Could not cache LaTeX PDF: %s", err->message);
+        g_error_free(err);
+        return;
+    }
+
+    prune();
+}
+
+void LatexCache::prune() {
+    std::vector<std::tuple<fs::file_time_type, uintmax_t, fs::path>> files;
+    uintmax_t total = 0;
+
+    std::error_code ec;
+    for (auto const& entry: fs::directory_iterator(this->dir, ec)) {
+        if (!entry.is_regular_file(ec) || entry.path().extension() != ".pdf") {
+            continue;
+        }
+        uintmax_t size = entry.file_size(ec);
+        if (ec) {
+            continue;
+        }
+        files.emplace_back(entry.last_write_time(ec), size, entry.path());
+        total += size;
+    }
+
+    if (total <= this->maxBytes) {
+        return;
+    }
+
+    std::sort(files.begin(), files.end());
+    for (auto const& [time, size, path]: files) {
+        if (total <= this->maxBytes) {
+            break;
+        }
+        if (fs::remove(path, ec)) {
+            total -= size;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * Xournal++
+ *
+ * Cache of compiled LaTeX formulas, shared by all documents
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "filesystem.h"
+
+/**
+ * Stores the PDF of each compiled formula in a directory, named by a hash of the LaTeX source
+ * and the generator command. The least recently used files are deleted over the size limit.
+ */
+class LatexCache {
+public:
+    /**
+     * @param dir The directory of the cache, created if needed
+     * @param maxBytes The size the cached files may have together, 0 disables storing
+     */
+    LatexCache(fs::path dir, uintmax_t maxBytes);
+
+public:
+    /**
+     * @param texContents The LaTeX file, with the template already filled in
+     * @param genCmd The command compiling it
+     */
+    static std::string makeKey(const std::string& texContents, const std::string& genCmd);
+
+    /**
+     * @return the cached PDF, or std::nullopt if the formula was not compiled before
+     */
+    std::optional<std::string> lookup(const std::string& key);
+
+    void store(const std::string& key, const std::string& pdf);
+
+private:
+    fs::path getPath(const std::string& key) const;
+
+    /**
+     * Deletes the least recently used files until the size limit is kept
+     */
+    void prune();
+
+private:
+    fs::path dir;
+    uintmax_t maxBytes;
+};
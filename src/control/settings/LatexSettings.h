@@ -20,4 +20,9 @@ public:
     bool autoCheckDependencies{true};
     fs::path globalTemplatePath{};
     std::string genCmd{"pdflatex -interaction=nonstopmode '{}'"};
+
+    /**
+     * The size of the compiled formulas kept for reuse, in MiB, 0 disables the cache
+     */
+    int cacheSizeLimit{64};
 };
@@ -1,5 +1,6 @@
 #include "Settings.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "model/FormatDefinitions.h"
@@ -13,6 +14,12 @@
 constexpr auto const* DEFAULT_FONT = "Sans";
 constexpr auto DEFAULT_FONT_SIZE = 12;
 
+/**
+ * Migration of pdfPageCacheSize, the former count of cached PDF pages: its default, and the memory of a page in MiB
+ */
+constexpr auto OLD_PDF_PAGE_CACHE_SIZE_DEFAULT = 10;
+constexpr auto PDF_PAGE_CACHE_MIB_PER_PAGE = 8;
+
 #define WRITE_BOOL_PROP(var) xmlNode = saveProperty((const char*)#var, (var) ? "true" : "false", root)
 #define WRITE_STRING_PROP(var) xmlNode = saveProperty((const char*)#var, (var).empty() ? "" : (var).c_str(), root)
 #define WRITE_INT_PROP(var) xmlNode = saveProperty((const char*)#var, var, root)
@@ -130,7 +137,15 @@ void Settings::loadDefault() {
     this->fullscreenHideElements = "mainMenubar";
     this->presentationHideElements = "mainMenubar,sidebarContents";
 
-    this->pdfPageCacheSize = 10;
+    this->pdfCacheMemoryLimit = 128;
+    this->renderThreadCount = 0;
+    this->prefetchPageCount = 2;
+    this->prefetchMemoryLimit = 64;
+    this->imageCacheMemoryLimit = 256;
+    this->pageBufferMemoryLimit = 256;
+    this->compressedPageBufferMemoryLimit = 64;
+    this->thumbnailCacheSizeLimit = 128;
+    this->cacheLayerComposites = true;
 
     this->selectionBorderColor = 0xff0000U;  // red
     this->selectionMarkerColor = 0x729fcfU;  // light blue
@@ -380,8 +395,30 @@ void Settings::parseItem(xmlDocPtr doc, xmlNodePtr cur) {
         this->fullscreenHideElements = reinterpret_cast<const char*>(value);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("presentationHideElements")) == 0) {
         this->presentationHideElements = reinterpret_cast<const char*>(value);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pdfCacheMemoryLimit")) == 0) {
+        this->pdfCacheMemoryLimit = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pdfPageCacheSize")) == 0) {
-        this->pdfPageCacheSize = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+        // Settings of older versions: keep a changed page count as about the same memory, the default stays
+        int pages = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+        if (pages != OLD_PDF_PAGE_CACHE_SIZE_DEFAULT) {
+            this->pdfCacheMemoryLimit = std::max(pages, 1) * PDF_PAGE_CACHE_MIB_PER_PAGE;
+        }
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("renderThreadCount")) == 0) {
+        this->renderThreadCount = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("prefetchPageCount")) == 0) {
+        this->prefetchPageCount = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("prefetchMemoryLimit")) == 0) {
+        this->prefetchMemoryLimit = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("imageCacheMemoryLimit")) == 0) {
+        this->imageCacheMemoryLimit = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pageBufferMemoryLimit")) == 0) {
+        this->pageBufferMemoryLimit = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("compressedPageBufferMemoryLimit")) == 0) {
+        this->compressedPageBufferMemoryLimit = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("thumbnailCacheSizeLimit")) == 0) {
+        this->thumbnailCacheSizeLimit = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("cacheLayerComposites")) == 0) {
+        this->cacheLayerComposites = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("selectionBorderColor")) == 0) {
         this->selectionBorderColor = Color(g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10));
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("selectionMarkerColor")) == 0) {
@@ -462,6 +499,10 @@ void Settings::parseItem(xmlDocPtr doc, xmlNodePtr cur) {
         this->latexSettings.globalTemplatePath = fs::u8path(v);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("latexSettings.genCmd")) == 0) {
         this->latexSettings.genCmd = reinterpret_cast<char*>(value);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("latexSettings.cacheSizeLimit")) == 0) {
+        // Negative sizes would be an unlimited cache
+        this->latexSettings.cacheSizeLimit =
+                std::max<int>(g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10), 0);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("snapRecognizedShapesEnabled")) == 0) {
         this->snapRecognizedShapesEnabled = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("restoreLineWidthEnabled")) == 0) {
@@ -813,8 +854,24 @@ void Settings::save() {
     WRITE_UINT_PROP(backgroundColor);
     WRITE_UINT_PROP(selectionMarkerColor);
 
-    WRITE_INT_PROP(pdfPageCacheSize);
-    WRITE_COMMENT("The count of rendered PDF pages which will be cached.");
+    WRITE_INT_PROP(pdfCacheMemoryLimit);
+    WRITE_COMMENT("The memory in MiB which rendered PDF pages may use.");
+    WRITE_INT_PROP(renderThreadCount);
+    WRITE_COMMENT("The count of threads rendering pages, 0 to choose by the processor count. Applied after a restart.");
+    WRITE_INT_PROP(prefetchPageCount);
+    WRITE_COMMENT("The count of pages rendered ahead while scrolling, 0 to disable.");
+    WRITE_INT_PROP(prefetchMemoryLimit);
+    WRITE_COMMENT("The memory in MiB which pages rendered ahead while scrolling may use.");
+    WRITE_INT_PROP(imageCacheMemoryLimit);
+    WRITE_COMMENT("The memory in MiB which decoded and downscaled images may use.");
+    WRITE_INT_PROP(pageBufferMemoryLimit);
+    WRITE_COMMENT("The memory in MiB which the rendered pages of the main view may use.");
+    WRITE_INT_PROP(compressedPageBufferMemoryLimit);
+    WRITE_COMMENT("The memory in MiB which compressed copies of freed rendered pages may use.");
+    WRITE_INT_PROP(thumbnailCacheSizeLimit);
+    WRITE_COMMENT("The size in MiB which the sidebar previews cached on disk may have.");
+    WRITE_BOOL_PROP(cacheLayerComposites);
+    WRITE_COMMENT("Keep the layers below and above the selected layer rendered, so writing redraws only one layer.");
 
     WRITE_COMMENT("Config for new pages");
     WRITE_STRING_PROP(pageTemplate);
@@ -856,6 +913,8 @@ void Settings::save() {
     fs::path& p = latexSettings.globalTemplatePath;
     xmlNode = saveProperty("latexSettings.globalTemplatePath", p.empty() ? "" : p.u8string().c_str(), root);
     WRITE_STRING_PROP(latexSettings.genCmd);
+    WRITE_INT_PROP(latexSettings.cacheSizeLimit);
+    WRITE_COMMENT("The size in MiB of the compiled LaTeX formulas kept for reuse.");
 
     xmlNodePtr xmlFont = nullptr;
     xmlFont = xmlNewChild(root, nullptr, reinterpret_cast<const xmlChar*>("property"), nullptr);
@@ -1534,13 +1593,93 @@ void Settings::setPresentationHideElements(string elements) {
     save();
 }
 
-auto Settings::getPdfPageCacheSize() const -> int { return this->pdfPageCacheSize; }
+auto Settings::getPdfCacheMemoryLimit() const -> int { return this->pdfCacheMemoryLimit; }
+
+void Settings::setPdfCacheMemoryLimit(int megabytes) {
+    if (this->pdfCacheMemoryLimit == megabytes) {
+        return;
+    }
+    this->pdfCacheMemoryLimit = megabytes;
+    save();
+}
+
+auto Settings::getRenderThreadCount() const -> int { return this->renderThreadCount; }
+
+void Settings::setRenderThreadCount(int count) {
+    if (this->renderThreadCount == count) {
+        return;
+    }
+    this->renderThreadCount = count;
+    save();
+}
+
+auto Settings::getPrefetchPageCount() const -> int { return this->prefetchPageCount; }
+
+void Settings::setPrefetchPageCount(int count) {
+    if (this->prefetchPageCount == count) {
+        return;
+    }
+    this->prefetchPageCount = count;
+    save();
+}
+
+auto Settings::getPrefetchMemoryLimit() const -> int { return this->prefetchMemoryLimit; }
+
+void Settings::setPrefetchMemoryLimit(int megabytes) {
+    if (this->prefetchMemoryLimit == megabytes) {
+        return;
+    }
+    this->prefetchMemoryLimit = megabytes;
+    save();
+}
+
+auto Settings::getImageCacheMemoryLimit() const -> int { return this->imageCacheMemoryLimit; }
+
+void Settings::setImageCacheMemoryLimit(int megabytes) {
+    if (this->imageCacheMemoryLimit == megabytes) {
+        return;
+    }
+    this->imageCacheMemoryLimit = megabytes;
+    save();
+}
+
+auto Settings::getPageBufferMemoryLimit() const -> int { return this->pageBufferMemoryLimit; }
+
+void Settings::setPageBufferMemoryLimit(int megabytes) {
+    if (this->pageBufferMemoryLimit == megabytes) {
+        return;
+    }
+    this->pageBufferMemoryLimit = megabytes;
+    save();
+}
+
+auto Settings::getCompressedPageBufferMemoryLimit() const -> int { return this->compressedPageBufferMemoryLimit; }
+
+void Settings::setCompressedPageBufferMemoryLimit(int megabytes) {
+    if (this->compressedPageBufferMemoryLimit == megabytes) {
+        return;
+    }
+    this->compressedPageBufferMemoryLimit = megabytes;
+    save();
+}
+
+auto Settings::getThumbnailCacheSizeLimit() const -> int { return this->thumbnailCacheSizeLimit; }
+
+void Settings::setThumbnailCacheSizeLimit(int megabytes) {
+    if (this->thumbnailCacheSizeLimit == megabytes) {
+        return;
+    }
+    this->thumbnailCacheSizeLimit = megabytes;
+    save();
+}
+
+auto Settings::isCacheLayerComposites() const -> bool { return this->cacheLayerComposites; }
 
-void Settings::setPdfPageCacheSize(int size) {
-    if (this->pdfPageCacheSize == size) {
+void Settings::setCacheLayerComposites(bool cache) {
+    if (this->cacheLayerComposites == cache) {
         return;
     }
-    this->pdfPageCacheSize = size;
+    this->cacheLayerComposites = cache;
     save();
 }
 
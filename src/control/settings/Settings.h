@@ -313,8 +313,53 @@ public:
     Color getBackgroundColor() const;
     void setBackgroundColor(Color color);
 
-    int getPdfPageCacheSize() const;
-    [[maybe_unused]] void setPdfPageCacheSize(int size);
+    /**
+     * @return the memory limit for rendered PDF pages, in MiB
+     */
+    int getPdfCacheMemoryLimit() const;
+    [[maybe_unused]] void setPdfCacheMemoryLimit(int megabytes);
+
+    int getRenderThreadCount() const;
+    [[maybe_unused]] void setRenderThreadCount(int count);
+
+    int getPrefetchPageCount() const;
+    [[maybe_unused]] void setPrefetchPageCount(int count);
+
+    /**
+     * @return the memory limit for pages rendered ahead while scrolling, in MiB
+     */
+    int getPrefetchMemoryLimit() const;
+    [[maybe_unused]] void setPrefetchMemoryLimit(int megabytes);
+
+    /**
+     * @return the memory limit for decoded and downscaled images, in MiB
+     */
+    int getImageCacheMemoryLimit() const;
+    [[maybe_unused]] void setImageCacheMemoryLimit(int megabytes);
+
+    /**
+     * @return the memory limit for the rendered pages shown in the main view, in MiB
+     */
+    int getPageBufferMemoryLimit() const;
+    [[maybe_unused]] void setPageBufferMemoryLimit(int megabytes);
+
+    /**
+     * @return the memory limit for the compressed copies of freed rendered pages, in MiB
+     */
+    int getCompressedPageBufferMemoryLimit() const;
+    [[maybe_unused]] void setCompressedPageBufferMemoryLimit(int megabytes);
+
+    /**
+     * @return the size limit of the sidebar previews cached on disk, in MiB
+     */
+    int getThumbnailCacheSizeLimit() const;
+    [[maybe_unused]] void setThumbnailCacheSizeLimit(int megabytes);
+
+    /**
+     * @return true if the layers below and above the selected layer are kept rendered while writing
+     */
+    bool isCacheLayerComposites() const;
+    [[maybe_unused]] void setCacheLayerComposites(bool cache);
 
     string const& getPageTemplate() const;
     void setPageTemplate(const string& pageTemplate);
@@ -754,9 +799,49 @@ private:
     string presentationHideElements;
 
     /**
-     *  The count of pages which will be cached
+     *  The memory which rendered PDF pages may use, in MiB
+     */
+    int pdfCacheMemoryLimit{};
+
+    /**
+     * The count of threads rendering pages and previews, 0 to choose it by the processor count
+     */
+    int renderThreadCount{};
+
+    /**
+     * The count of pages rendered ahead in scroll direction, 0 to disable
+     */
+    int prefetchPageCount{};
+
+    /**
+     * The memory which pages rendered ahead may use, in MiB
+     */
+    int prefetchMemoryLimit{};
+
+    /**
+     * The memory which decoded and downscaled images may use, in MiB
+     */
+    int imageCacheMemoryLimit{};
+
+    /**
+     * The memory which the rendered pages of the main view may use, in MiB
+     */
+    int pageBufferMemoryLimit{};
+
+    /**
+     * The memory which the compressed copies of freed rendered pages may use, in MiB
+     */
+    int compressedPageBufferMemoryLimit{};
+
+    /**
+     * The size which the sidebar previews cached on disk may have, in MiB
+     */
+    int thumbnailCacheSizeLimit{};
+
+    /**
+     * Keep the layers below and above the selected layer rendered, so only the selected layer is redrawn
      */
-    int pdfPageCacheSize{};
+    bool cacheLayerComposites{};
 
     /**
      * The color to draw borders on selected elements
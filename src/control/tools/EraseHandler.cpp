@@ -1,5 +1,6 @@
 #include "EraseHandler.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 
@@ -38,22 +39,47 @@ EraseHandler::~EraseHandler() {
     }
 }
 
+void EraseHandler::start(double x, double y) {
+    // Not connected to the end of the last eraser stroke, even if it wasn't finalized
+    this->hasLastPosition = false;
+    erase(x, y);
+}
+
 /**
  * Handle eraser event: "Delete Stroke" and "Standard", Whiteout is not handled here
  */
 void EraseHandler::erase(double x, double y) {
     this->halfEraserSize = this->handler->getThickness();
-    GdkRectangle eraserRect = {gint(x - halfEraserSize), gint(y - halfEraserSize), gint(halfEraserSize * 2),
-                               gint(halfEraserSize * 2)};
+
+    utl::Point<double> from = this->hasLastPosition ? this->lastPosition : utl::Point<double>(x, y);
+    utl::Point<double> to(x, y);
+    this->lastPosition = to;
+    this->hasLastPosition = true;
+
+    // The eraser square is swept along the motion, so fast movements don't skip strokes
+    int steps = 1;
+    if (this->halfEraserSize > 0) {
+        steps = std::max(1, static_cast<int>(std::ceil(from.distance(to) / this->halfEraserSize)));
+    }
+
+    this->positions.clear();
+    for (int i = 1; i <= steps; i++) {
+        this->positions.push_back(from + (to - from) * (static_cast<double>(i) / steps));
+    }
+
+    double x1 = std::min(from.x, to.x) - this->halfEraserSize;
+    double y1 = std::min(from.y, to.y) - this->halfEraserSize;
+    double width = std::abs(to.x - from.x) + 2 * this->halfEraserSize;
+    double height = std::abs(to.y - from.y) + 2 * this->halfEraserSize;
 
     auto* range = new Range(x, y);
 
     Layer* l = page->getSelectedLayer();
 
-    vector<Element*> tmp(*l->getElements());
-    for (Element* e: tmp) {
-        if (e->getType() == ELEMENT_STROKE && e->intersectsArea(&eraserRect)) {
-            eraseStroke(l, dynamic_cast<Stroke*>(e), x, y, range);
+    // Only the elements near the motion, eraseStroke may remove elements from the layer
+    for (Element* e: l->getElementsInArea(x1, y1, width, height)) {
+        if (e->getType() == ELEMENT_STROKE && e->intersectsArea(x1, y1, width, height)) {
+            eraseStroke(l, dynamic_cast<Stroke*>(e), range);
         }
     }
 
@@ -61,8 +87,18 @@ void EraseHandler::erase(double x, double y) {
     delete range;
 }
 
-void EraseHandler::eraseStroke(Layer* l, Stroke* s, double x, double y, Range* range) {
-    if (!s->intersects(x, y, halfEraserSize)) {
+void EraseHandler::eraseStroke(Layer* l, Stroke* s, Range* range) {
+    // Most strokes near the motion are missed by the whole swept eraser, and aren't tested at each position
+    utl::Point<double> const& from = this->positions.front();
+    utl::Point<double> const& to = this->positions.back();
+    if (!s->mayIntersectMotion(from.x, from.y, to.x, to.y, this->halfEraserSize)) {
+        return;
+    }
+
+    auto touches = [&](utl::Point<double> const& p) { return s->intersects(p.x, p.y, this->halfEraserSize); };
+
+    auto first = std::find_if(this->positions.begin(), this->positions.end(), touches);
+    if (first == this->positions.end()) {
         return;
     }
 
@@ -113,11 +149,17 @@ void EraseHandler::eraseStroke(Layer* l, Stroke* s, double x, double y, Range* r
             eraseable = s->getEraseable();
         }
 
-        eraseable->erase(x, y, halfEraserSize, range);
+        for (auto p = first; p != this->positions.end(); p++) {
+            if (p == first || touches(*p)) {
+                eraseable->erase(p->x, p->y, this->halfEraserSize, range);
+            }
+        }
     }
 }
 
 void EraseHandler::finalize() {
+    this->hasLastPosition = false;
+
     if (this->eraseUndoAction) {
         this->eraseUndoAction->finalize();
         this->eraseUndoAction = nullptr;
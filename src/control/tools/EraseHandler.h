@@ -16,6 +16,7 @@
 
 #include "model/PageRef.h"
 
+#include "Point.h"
 #include "XournalType.h"
 
 class DeleteUndoAction;
@@ -34,11 +35,19 @@ public:
     virtual ~EraseHandler();
 
 public:
+    /**
+     * Starts a new eraser stroke at x, y
+     */
+    void start(double x, double y);
+
+    /**
+     * Erases along the motion from the last position of this eraser stroke to x, y
+     */
     void erase(double x, double y);
     void finalize();
 
 private:
-    void eraseStroke(Layer* l, Stroke* s, double x, double y, Range* range);
+    void eraseStroke(Layer* l, Stroke* s, Range* range);
 
 private:
     PageRef page;
@@ -51,4 +60,15 @@ private:
     EraseUndoAction* eraseUndoAction;
 
     double halfEraserSize;
+
+    /**
+     * The last position of the current eraser stroke
+     */
+    bool hasLastPosition = false;
+    utl::Point<double> lastPosition;
+
+    /**
+     * The eraser positions of the current motion, close enough that the eraser squares overlap
+     */
+    std::vector<utl::Point<double>> positions;
 };
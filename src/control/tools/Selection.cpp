@@ -44,7 +44,7 @@ auto RectSelection::finalize(PageRef page) -> bool {
     this->page = page;
 
     Layer* l = page->getSelectedLayer();
-    for (Element* e: *l->getElements()) {
+    for (Element* e: l->getElementsInArea(this->x1, this->y1, this->x2 - this->x1, this->y2 - this->y1)) {
         if (e->isInSelection(this)) {
             this->selectedElements.push_back(e);
         }
@@ -66,6 +66,10 @@ auto RectSelection::contains(double x, double y) -> bool {
     return true;
 }
 
+auto RectSelection::containsAll(const double* xs, const double* ys, size_t count) -> bool {
+    return HitTest::allInBox(xs, ys, count, this->x1, this->y1, this->x2, this->y2);
+}
+
 void RectSelection::currentPos(double x, double y) {
     double aX = std::min(x, this->ex);
     aX = std::min(aX, this->sx) - 10;
@@ -197,77 +201,14 @@ void RegionSelect::currentPos(double x, double y) {
     }
 }
 
-auto RegionSelect::contains(double x, double y) -> bool {
-    if (x < this->x1Box || x > this->x2Box) {
-        return false;
-    }
-    if (y < this->y1Box || y > this->y2Box) {
-        return false;
-    }
-    if (this->points == nullptr || this->points->next == nullptr) {
-        return false;
-    }
-
-    int hits = 0;
-
-    auto* last = static_cast<RegionPoint*>(g_list_last(this->points)->data);
-
-    double lastx = last->x;
-    double lasty = last->y;
-    double curx = NAN, cury = NAN;
-
-    // Walk the edges of the polygon
-    for (GList* l = this->points; l != nullptr; lastx = curx, lasty = cury, l = l->next) {
-        auto* last = static_cast<RegionPoint*>(l->data);
-        curx = last->x;
-        cury = last->y;
-
-        if (cury == lasty) {
-            continue;
-        }
+auto RegionSelect::contains(double x, double y) -> bool { return containsAll(&x, &y, 1); }
 
-        int leftx = 0;
-        if (curx < lastx) {
-            if (x >= lastx) {
-                continue;
-            }
-            leftx = curx;
-        } else {
-            if (x >= curx) {
-                continue;
-            }
-            leftx = lastx;
-        }
-
-        double test1 = NAN, test2 = NAN;
-        if (cury < lasty) {
-            if (y < cury || y >= lasty) {
-                continue;
-            }
-            if (x < leftx) {
-                hits++;
-                continue;
-            }
-            test1 = x - curx;
-            test2 = y - cury;
-        } else {
-            if (y < lasty || y >= cury) {
-                continue;
-            }
-            if (x < leftx) {
-                hits++;
-                continue;
-            }
-            test1 = x - lastx;
-            test2 = y - lasty;
-        }
-
-        if (test1 < (test2 / (lasty - cury) * (lastx - curx))) {
-            hits++;
-        }
+auto RegionSelect::containsAll(const double* xs, const double* ys, size_t count) -> bool {
+    if (!HitTest::allInBox(xs, ys, count, this->x1Box, this->y1Box, this->x2Box, this->y2Box)) {
+        return false;
     }
 
-    return (hits & 1) != 0;
+    return HitTest::allInPolygon(xs, ys, count, this->edges);
 }
 
 auto RegionSelect::finalize(PageRef page) -> bool {
@@ -278,8 +219,12 @@ auto RegionSelect::finalize(PageRef page) -> bool {
     this->y1Box = 0;
     this->y2Box = 0;
 
+    std::vector<double> xs;
+    std::vector<double> ys;
     for (GList* l = this->points; l != nullptr; l = l->next) {
         auto* p = static_cast<RegionPoint*>(l->data);
+        xs.push_back(p->x);
+        ys.push_back(p->y);
 
         if (p->x < this->x1Box) {
             this->x1Box = p->x;
@@ -294,8 +239,11 @@ auto RegionSelect::finalize(PageRef page) -> bool {
         }
     }
 
+    this->edges = HitTest::polygonEdges(xs.data(), ys.data(), xs.size());
+
     Layer* l = page->getSelectedLayer();
-    for (Element* e: *l->getElements()) {
+    for (Element* e: l->getElementsInArea(this->x1Box, this->y1Box, this->x2Box - this->x1Box,
+                                          this->y2Box - this->y1Box)) {
         if (e->isInSelection(this)) {
             this->selectedElements.push_back(e);
         }
@@ -18,6 +18,7 @@
 #include "model/Element.h"
 #include "model/PageRef.h"
 
+#include "HitTest.h"
 #include "Util.h"
 #include "XournalType.h"
 
@@ -56,6 +57,7 @@ public:
     virtual void paint(cairo_t* cr, GdkRectangle* rect, double zoom);
     virtual void currentPos(double x, double y);
     virtual bool contains(double x, double y);
+    virtual bool containsAll(const double* xs, const double* ys, size_t count);
     virtual bool userTapped(double zoom);
 
 private:
@@ -84,8 +86,14 @@ public:
     virtual void paint(cairo_t* cr, GdkRectangle* rect, double zoom);
     virtual void currentPos(double x, double y);
     virtual bool contains(double x, double y);
+    virtual bool containsAll(const double* xs, const double* ys, size_t count);
     virtual bool userTapped(double zoom);
 
 private:
     GList* points;
+
+    /**
+     * The edges of the polygon through the points, built by finalize()
+     */
+    std::vector<HitTest::PolygonEdge> edges;
 };
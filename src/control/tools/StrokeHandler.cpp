@@ -159,15 +159,13 @@ void StrokeHandler::onButtonReleaseEvent(const PositionInputData& pos) {
     // Backward compatibility and also easier to handle for me;-)
     // I cannot draw a line with one point, to draw a visible line I need two points,
     // twice the same Point is also OK
-    if (auto const& pv = stroke->getPointVector(); pv.size() == 1) {
-        stroke->addPoint(pv.front());
+    if (stroke->getPointCount() == 1) {
+        stroke->addPoint(stroke->getPoint(0));
         // Todo: check if the following is the reason for a bug, that single points have no pressure:
         // No pressure sensitivity,
         stroke->clearPressure();
     }
 
-    stroke->freeUnusedPointItems();
-
     control->getLayerController()->ensureLayerExists(page);
 
     Layer* layer = page->getSelectedLayer();
@@ -196,6 +194,9 @@ void StrokeHandler::onButtonReleaseEvent(const PositionInputData& pos) {
         }
     }
 
+    // After the recognizer, which converts the points to one array
+    stroke->freeUnusedPointItems();
+
     if (stroke->getFill() != -1 && stroke->getToolType() == STROKE_TOOL_HIGHLIGHTER) {
         // The stroke is not filled on drawing time
         // If the stroke has fill values, it needs to be re-rendered
@@ -180,7 +180,10 @@ void SaveHandler::visitLayer(XmlNode* page, Layer* l) {
             auto* image = new XmlImageNode("image");
             layer->addChild(image);
 
-            image->setImage(i->getImage());
+            // Decoded only for writing, the element doesn't keep it
+            cairo_surface_t* img = i->loadImage();
+            image->setImage(img);
+            cairo_surface_destroy(img);
 
             image->setAttrib("left", i->getX());
             image->setAttrib("top", i->getY());
@@ -0,0 +1,154 @@
+#include "CompressedTileCache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+CompressedTileCache::CompressedTileCache() { g_mutex_init(&this->cacheMutex); }
+
+CompressedTileCache::~CompressedTileCache() { g_mutex_clear(&this->cacheMutex); }
+
+auto CompressedTileCache::getInstance() -> CompressedTileCache& {
+    static CompressedTileCache instance;
+    return instance;
+}
+
+void CompressedTileCache::remove(EntryList::iterator it) {
+    this->usedBytes -= it->bytes;
+    this->index.erase(it->key);
+    this->entries.erase(it);
+}
+
+void CompressedTileCache::setMemoryLimit(size_t bytes) {
+    g_mutex_lock(&this->cacheMutex);
+    this->maxBytes = bytes;
+    while (this->usedBytes > this->maxBytes) {
+        remove(std::prev(this->entries.end()));
+    }
+    g_mutex_unlock(&this->cacheMutex);
+}
+
+void CompressedTileCache::store(const void* owner, TiledPageBuffer::TileKey const& key, cairo_surface_t* tile) {
+    cairo_surface_flush(tile);
+
+    int width = cairo_image_surface_get_width(tile);
+    int height = cairo_image_surface_get_height(tile);
+    int stride = cairo_image_surface_get_stride(tile);
+    unsigned char* pixels = cairo_image_surface_get_data(tile);
+    size_t plainSize = static_cast<size_t>(width) * height;
+
+    Entry e{{owner, key.zoom, key.col, key.row}, width, height, {}, false, 0};
+
+    // Runs continue over the end of a row, most rows end with the same background as the next one starts
+    uint32_t runPixel = 0;
+    uint32_t runLength = 0;
+    for (int y = 0; y < height && e.data.size() < plainSize; y++) {
+        auto* row = reinterpret_cast<uint32_t*>(pixels + static_cast<ptrdiff_t>(y) * stride);
+        for (int x = 0; x < width; x++) {
+            if (runLength > 0 && row[x] == runPixel) {
+                runLength++;
+                continue;
+            }
+            if (runLength > 0) {
+                e.data.push_back(runLength);
+                e.data.push_back(runPixel);
+            }
+            runPixel = row[x];
+            runLength = 1;
+        }
+    }
+    e.data.push_back(runLength);
+    e.data.push_back(runPixel);
+
+    // Complex content, e.g. photos, doesn't get smaller, but copying it back is still cheaper than rendering
+    if (e.data.size() >= plainSize) {
+        e.plain = true;
+        e.data.resize(plainSize);
+        for (int y = 0; y < height; y++) {
+            std::memcpy(e.data.data() + static_cast<size_t>(y) * width, pixels + static_cast<ptrdiff_t>(y) * stride,
+                        static_cast<size_t>(width) * sizeof(uint32_t));
+        }
+    }
+    e.data.shrink_to_fit();
+    e.bytes = e.data.capacity() * sizeof(uint32_t);
+
+    g_mutex_lock(&this->cacheMutex);
+
+    auto it = this->index.find(e.key);
+    if (it != this->index.end()) {
+        remove(it->second);
+    }
+
+    this->usedBytes += e.bytes;
+    this->entries.push_front(std::move(e));
+    this->index[this->entries.front().key] = this->entries.begin();
+
+    while (this->usedBytes > this->maxBytes) {
+        remove(std::prev(this->entries.end()));
+    }
+
+    g_mutex_unlock(&this->cacheMutex);
+}
+
+auto CompressedTileCache::restore(const void* owner, TiledPageBuffer::TileKey const& key, int width, int height)
+        -> cairo_surface_t* {
+    g_mutex_lock(&this->cacheMutex);
+
+    auto it = this->index.find({owner, key.zoom, key.col, key.row});
+    if (it == this->index.end()) {
+        g_mutex_unlock(&this->cacheMutex);
+        return nullptr;
+    }
+
+    Entry e = std::move(*it->second);
+    remove(it->second);
+    g_mutex_unlock(&this->cacheMutex);
+
+    // The page size changed meanwhile
+    if (e.width != width || e.height != height) {
+        return nullptr;
+    }
+
+    cairo_surface_t* tile = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    int stride = cairo_image_surface_get_stride(tile);
+    unsigned char* pixels = cairo_image_surface_get_data(tile);
+
+    if (e.plain) {
+        for (int y = 0; y < height; y++) {
+            std::memcpy(pixels + static_cast<ptrdiff_t>(y) * stride, e.data.data() + static_cast<size_t>(y) * width,
+                        static_cast<size_t>(width) * sizeof(uint32_t));
+        }
+    } else {
+        size_t run = 0;
+        uint32_t remaining = e.data[0];
+        for (int y = 0; y < height; y++) {
+            auto* row = reinterpret_cast<uint32_t*>(pixels + static_cast<ptrdiff_t>(y) * stride);
+            for (int x = 0; x < width;) {
+                if (remaining == 0) {
+                    run += 2;
+                    remaining = e.data[run];
+                }
+                int count = std::min(static_cast<int>(remaining), width - x);
+                std::fill(row + x, row + x + count, e.data[run + 1]);
+                x += count;
+                remaining -= count;
+            }
+        }
+    }
+
+    cairo_surface_mark_dirty(tile);
+    return tile;
+}
+
+void CompressedTileCache::invalidate(const void* owner) {
+    g_mutex_lock(&this->cacheMutex);
+
+    auto it = this->index.lower_bound({owner, -1.0, 0, 0});
+    while (it != this->index.end() && std::get<0>(it->first) == owner) {
+        auto entry = it->second;
+        ++it;
+        remove(entry);
+    }
+
+    g_mutex_unlock(&this->cacheMutex);
+}
@@ -0,0 +1,98 @@
+/*
+ * Xournal++
+ *
+ * Run length coded copies of freed page tiles
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include <gtk/gtk.h>
+
+#include "TiledPageBuffer.h"
+
+/**
+ * If the memory cleanup frees the tiles of a page, they are kept here compressed,
+ * so scrolling back to the page only needs to decompress them instead of rendering the page again.
+ *
+ * Pages are mostly of a few colors, a run length coding of the pixels compresses them well
+ * and is much faster than rendering. Thread safe, the tiles are restored by the render jobs.
+ */
+class CompressedTileCache {
+private:
+    CompressedTileCache();
+    virtual ~CompressedTileCache();
+
+public:
+    CompressedTileCache(const CompressedTileCache&) = delete;
+    CompressedTileCache& operator=(const CompressedTileCache&) = delete;
+
+    static CompressedTileCache& getInstance();
+
+public:
+    /**
+     * Compresses the tile, the surface is not changed
+     *
+     * @param owner The page view the tile belongs to
+     */
+    void store(const void* owner, TiledPageBuffer::TileKey const& key, cairo_surface_t* tile);
+
+    /**
+     * Removes the tile from the cache
+     *
+     * @return A new surface with the tile, nullptr if it's not cached with this size
+     */
+    cairo_surface_t* restore(const void* owner, TiledPageBuffer::TileKey const& key, int width, int height);
+
+    /**
+     * Removes all tiles of owner, has to be called if the page changes
+     */
+    void invalidate(const void* owner);
+
+    /**
+     * The memory the compressed tiles may use
+     */
+    void setMemoryLimit(size_t bytes);
+
+private:
+    using Key = std::tuple<const void*, double, int, int>;
+
+    struct Entry {
+        Key key;
+        int width;
+        int height;
+
+        /**
+         * Pairs of count and pixel, or the plain pixels if that's smaller
+         */
+        std::vector<uint32_t> data;
+        bool plain;
+        size_t bytes;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    void remove(EntryList::iterator it);
+
+private:
+    GMutex cacheMutex{};
+
+    /**
+     * The most recently stored tile is at the front
+     */
+    EntryList entries;
+    std::map<Key, EntryList::iterator> index;
+
+    size_t usedBytes = 0;
+    size_t maxBytes = static_cast<size_t>(64) * 1024 * 1024;
+};
@@ -0,0 +1,85 @@
+#include "LayerComposite.h"
+
+#include <initializer_list>
+#include <utility>
+
+auto LayerComposite::State::operator==(State const& other) const -> bool {
+    return zoom == other.zoom && width == other.width && height == other.height &&
+           selectedLayer == other.selectedLayer && backgroundVisible == other.backgroundVisible &&
+           markAudioStroke == other.markAudioStroke && layerVersions == other.layerVersions;
+}
+
+auto LayerComposite::State::operator!=(State const& other) const -> bool { return !(*this == other); }
+
+LayerComposite::LayerComposite() { g_mutex_init(&this->mutex); }
+
+LayerComposite::~LayerComposite() {
+    freeSurfaces();
+    g_mutex_clear(&this->mutex);
+}
+
+void LayerComposite::freeSurfaces() {
+    if (this->below) {
+        cairo_surface_destroy(this->below);
+        this->below = nullptr;
+    }
+    if (this->above) {
+        cairo_surface_destroy(this->above);
+        this->above = nullptr;
+    }
+    this->state = State();
+}
+
+void LayerComposite::clear() {
+    g_mutex_lock(&this->mutex);
+    freeSurfaces();
+    g_mutex_unlock(&this->mutex);
+}
+
+void LayerComposite::set(State state, cairo_surface_t* below, cairo_surface_t* above, bool aboveCached) {
+    g_mutex_lock(&this->mutex);
+    freeSurfaces();
+    this->state = std::move(state);
+    this->below = below;
+    this->above = above;
+    this->aboveCached = aboveCached;
+    g_mutex_unlock(&this->mutex);
+}
+
+auto LayerComposite::matches(State const& state) -> bool {
+    g_mutex_lock(&this->mutex);
+    bool result = this->below != nullptr && this->state == state;
+    g_mutex_unlock(&this->mutex);
+    return result;
+}
+
+auto LayerComposite::get(State const& state, cairo_surface_t*& below, cairo_surface_t*& above, bool& aboveCached)
+        -> bool {
+    g_mutex_lock(&this->mutex);
+
+    if (this->below == nullptr || this->state != state) {
+        g_mutex_unlock(&this->mutex);
+        return false;
+    }
+
+    below = cairo_surface_reference(this->below);
+    above = this->above ? cairo_surface_reference(this->above) : nullptr;
+    aboveCached = this->aboveCached;
+
+    g_mutex_unlock(&this->mutex);
+    return true;
+}
+
+auto LayerComposite::getPixels() -> int {
+    g_mutex_lock(&this->mutex);
+
+    int pixels = 0;
+    for (cairo_surface_t* surface: {this->below, this->above}) {
+        if (surface) {
+            pixels += cairo_image_surface_get_width(surface) * cairo_image_surface_get_height(surface);
+        }
+    }
+
+    g_mutex_unlock(&this->mutex);
+    return pixels;
+}
@@ -0,0 +1,105 @@
+/*
+ * Xournal++
+ *
+ * The rendered layers below and above the selected layer of a page
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <cairo/cairo.h>
+#include <glib.h>
+
+/**
+ * While writing on one layer, the other layers don't change. They are rendered once to two surfaces,
+ * so a rerender only draws the selected layer between them. Used by the render jobs of one page and cleared
+ * by the UI thread, so all methods lock.
+ */
+class LayerComposite {
+public:
+    /**
+     * Everything the composite depends on, it's only used if the state still matches
+     */
+    struct State {
+        double zoom = 0;
+
+        /**
+         * The size of the page in buffer pixels
+         */
+        int width = 0;
+        int height = 0;
+
+        /**
+         * Layer ID as in XojPage, 0 if no layer is selected
+         */
+        int selectedLayer = 0;
+
+        bool backgroundVisible = true;
+        bool markAudioStroke = false;
+
+        /**
+         * The version of each layer, 0 for invisible layers and for the selected layer
+         */
+        std::vector<uint64_t> layerVersions;
+
+        bool operator==(State const& other) const;
+        bool operator!=(State const& other) const;
+    };
+
+public:
+    LayerComposite();
+    virtual ~LayerComposite();
+
+    LayerComposite(const LayerComposite&) = delete;
+    LayerComposite& operator=(const LayerComposite&) = delete;
+
+public:
+    /**
+     * Frees the surfaces
+     */
+    void clear();
+
+    /**
+     * Replaces the composite, takes the references of the surfaces
+     *
+     * @param below The background and the layers below the selected layer, opaque
+     * @param above The layers above the selected layer on a transparent surface, nullptr if they have to be drawn
+     *              directly (aboveCached false) or if there is nothing to draw (aboveCached true)
+     */
+    void set(State state, cairo_surface_t* below, cairo_surface_t* above, bool aboveCached);
+
+    /**
+     * @return true if there is a composite for this state
+     */
+    bool matches(State const& state);
+
+    /**
+     * Returns new references to the surfaces, which are released with cairo_surface_destroy, if the state matches
+     *
+     * @return false if the composite is outdated, nothing is returned then
+     */
+    bool get(State const& state, cairo_surface_t*& below, cairo_surface_t*& above, bool& aboveCached);
+
+    /**
+     * @return the pixels of both surfaces, for the page buffer memory limit
+     */
+    int getPixels();
+
+private:
+    void freeSurfaces();
+
+private:
+    GMutex mutex{};
+
+    State state;
+    cairo_surface_t* below = nullptr;
+    cairo_surface_t* above = nullptr;
+    bool aboveCached = false;
+};
@@ -6,6 +6,8 @@
 #include <optional>
 
 #include "control/Control.h"
+#include "control/jobs/XournalScheduler.h"
+#include "control/settings/Settings.h"
 #include "gui/scroll/ScrollHandling.h"
 #include "widgets/XournalWidget.h"
 
@@ -25,6 +27,16 @@ constexpr size_t const XOURNAL_ROOM_FOR_SHADOW = 3;
  */
 constexpr size_t const XOURNAL_PADDING_BETWEEN = 15;
 
+/**
+ * Pages are prefetched for the distance scrolled within this time, at least for one screen
+ */
+constexpr double PREFETCH_LOOKAHEAD_SECONDS = 1.0;
+
+/**
+ * Scroll events further apart than this (in µs) don't count as continuous scrolling
+ */
+constexpr gint64 SCROLL_VELOCITY_TIMEOUT = 500000;
+
 
 Layout::Layout(XournalView* view, ScrollHandling* scrollHandling): view(view), scrollHandling(scrollHandling) {
     this->hadjHandler = g_signal_connect(scrollHandling->getHorizontal(), "value-changed",
@@ -40,24 +52,111 @@ Layout::Layout(XournalView* view, ScrollHandling* scrollHandling): view(view), s
 
 void Layout::horizontalScrollChanged(GtkAdjustment* adjustment, Layout* layout) {
     g_signal_handler_block(layout->scrollHandling->getHorizontal(), layout->hadjHandler);
-    Layout::checkScroll(adjustment, layout->lastScrollHorizontal);
+    double delta = layout->checkScroll(adjustment, layout->lastScrollHorizontal);
     layout->updateVisibility();
+    layout->prefetchPages(adjustment, true, delta);
     layout->scrollHandling->scrollChanged();
     g_signal_handler_unblock(layout->scrollHandling->getHorizontal(), layout->hadjHandler);
 }
 
 void Layout::verticalScrollChanged(GtkAdjustment* adjustment, Layout* layout) {
     g_signal_handler_block(layout->scrollHandling->getVertical(), layout->vadjHandler);
-    Layout::checkScroll(adjustment, layout->lastScrollVertical);
+    double delta = layout->checkScroll(adjustment, layout->lastScrollVertical);
     layout->updateVisibility();
+    layout->prefetchPages(adjustment, false, delta);
     layout->scrollHandling->scrollChanged();
     g_signal_handler_unblock(layout->scrollHandling->getVertical(), layout->vadjHandler);
 }
 
 Layout::~Layout() = default;
 
-void Layout::checkScroll(GtkAdjustment* adjustment, double& lastScroll) {
-    lastScroll = gtk_adjustment_get_value(adjustment);
+auto Layout::checkScroll(GtkAdjustment* adjustment, double& lastScroll) -> double {
+    double value = gtk_adjustment_get_value(adjustment);
+    double delta = value - lastScroll;
+    lastScroll = value;
+
+    gint64 now = g_get_monotonic_time();
+    gint64 elapsed = now - this->lastScrollTime;
+    this->lastScrollTime = now;
+
+    if (elapsed > 0 && elapsed < SCROLL_VELOCITY_TIMEOUT) {
+        double velocity = std::abs(delta) * G_USEC_PER_SEC / elapsed;
+        this->scrollVelocity = 0.7 * this->scrollVelocity + 0.3 * velocity;
+    } else {
+        this->scrollVelocity = 0;
+    }
+
+    return delta;
+}
+
+void Layout::prefetchPages(GtkAdjustment* adjustment, bool horizontal, double delta) {
+    if (delta == 0 || !this->firstVisibleRow || !this->firstVisibleCol) {
+        return;
+    }
+
+    XournalScheduler* scheduler = this->view->getControl()->getScheduler();
+    Settings* settings = this->view->getControl()->getSettings();
+
+    int direction = delta > 0 ? 1 : -1;
+    if (direction != this->prefetchDirection || horizontal != this->prefetchHorizontal) {
+        scheduler->removePrefetchJobs();
+        this->prefetchDirection = direction;
+        this->prefetchHorizontal = horizontal;
+    }
+
+    int depth = settings->getPrefetchPageCount();
+    if (depth <= 0) {
+        return;
+    }
+
+    // The limit is for all prefetched pages which didn't get visible yet, not only for the pages of this call
+    auto memoryLimit = static_cast<size_t>(settings->getPrefetchMemoryLimit()) * 1024 * 1024;
+    size_t memory = 0;
+    for (XojPageView* pageView: this->view->viewPages) {
+        memory += pageView->getPrefetchedBytes();
+    }
+
+    int dpiScaleFactor = this->view->getDpiScaleFactor();
+    double screen = gtk_adjustment_get_page_size(adjustment);
+
+    // The faster the scrolling, the more pages are needed soon
+    double distance = std::max(screen, this->scrollVelocity * PREFETCH_LOOKAHEAD_SECONDS);
+
+    // The next pages are the neighbors in the grid, the next rows / columns within the visible columns / rows
+    std::vector<unsigned> const& edges = horizontal ? this->widthCols : this->heightRows;
+    size_t line = direction > 0 ? (horizontal ? *this->lastVisibleCol : *this->lastVisibleRow)
+                                : (horizontal ? *this->firstVisibleCol : *this->firstVisibleRow);
+    size_t first = horizontal ? *this->firstVisibleRow : *this->firstVisibleCol;
+    size_t last = horizontal ? *this->lastVisibleRow : *this->lastVisibleCol;
+
+    for (int i = 0; i < depth && distance > 0; i++) {
+        if (direction > 0 ? line + 1 >= edges.size() : line == 0) {
+            break;
+        }
+        line += direction;
+
+        for (size_t across = first; across <= last; across++) {
+            auto index = horizontal ? this->mapper.at({line, across}) : this->mapper.at({across, line});
+            if (!index) {
+                continue;
+            }
+
+            XojPageView* pageView = this->view->viewPages[*index];
+            int pageLength = horizontal ? pageView->getDisplayWidth() : pageView->getDisplayHeight();
+            int pageBreadth = horizontal ? pageView->getDisplayHeight() : pageView->getDisplayWidth();
+            int length = static_cast<int>(std::min<double>(pageLength, screen));
+
+            size_t bytes = static_cast<size_t>(length) * pageBreadth * dpiScaleFactor * dpiScaleFactor * 4;
+            if (memory - pageView->getPrefetchedBytes() + bytes > memoryLimit) {
+                return;
+            }
+            memory += bytes - pageView->getPrefetchedBytes();
+
+            pageView->prefetch(horizontal, direction < 0, length);
+        }
+
+        distance -= edges[line] - (line > 0 ? edges[line - 1] : 0);
+    }
 }
 
 void Layout::updateVisibility() {
@@ -72,6 +171,11 @@ void Layout::updateVisibility() {
     std::optional<size_t> mostPageNr;
     double mostPagePercent = 0;
 
+    this->firstVisibleRow.reset();
+    this->lastVisibleRow.reset();
+    this->firstVisibleCol.reset();
+    this->lastVisibleCol.reset();
+
     for (size_t row = 0; row < this->heightRows.size(); ++row) {
         int y2 = this->heightRows[row];
         for (size_t col = 0; col < this->widthCols.size(); ++col) {
@@ -90,6 +194,17 @@ void Layout::updateVisibility() {
                     auto const& pageRect = pageView->getRect();
                     if (auto intersection = pageRect.intersects(visRect); intersection) {
                         pageView->setIsVisible(true);
+
+                        if (!this->firstVisibleRow) {
+                            this->firstVisibleRow = row;
+                        }
+                        this->lastVisibleRow = row;
+                        if (!this->firstVisibleCol || col < *this->firstVisibleCol) {
+                            this->firstVisibleCol = col;
+                        }
+                        if (!this->lastVisibleCol || col > *this->lastVisibleCol) {
+                            this->lastVisibleCol = col;
+                        }
                         // Set the selected page
                         double percent = intersection->area() / pageRect.area();
 
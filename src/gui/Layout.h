@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -109,7 +110,18 @@ protected:
     static void verticalScrollChanged(GtkAdjustment* adjustment, Layout* layout);
 
 private:
-    static void checkScroll(GtkAdjustment* adjustment, double& lastScroll);
+    /**
+     * Updates the scroll velocity
+     *
+     * @return The scrolled distance since the last call
+     */
+    double checkScroll(GtkAdjustment* adjustment, double& lastScroll);
+
+    /**
+     * Renders the next pages in scroll direction before they get visible,
+     * the queued prefetch jobs are cancelled if the direction changes
+     */
+    void prefetchPages(GtkAdjustment* adjustment, bool horizontal, double delta);
 
     /**
      * Calls either the ScrollHandlingGtk or (when the Touch Workaround is enabled) the ScrollHandlingXournalpp
@@ -129,6 +141,26 @@ private:
     double lastScrollHorizontal = -1;
     double lastScrollVertical = -1;
 
+    /**
+     * Smoothed scroll speed in pixel per second, and the time of the last scroll event in µs
+     */
+    double scrollVelocity = 0;
+    gint64 lastScrollTime = 0;
+
+    /**
+     * Direction of the current prefetch jobs: -1 up / left, 1 down / right, 0 none
+     */
+    int prefetchDirection = 0;
+    bool prefetchHorizontal = false;
+
+    /**
+     * Range of the grid rows and columns with visible pages after the last updateVisibility()
+     */
+    std::optional<size_t> firstVisibleRow;
+    std::optional<size_t> lastVisibleRow;
+    std::optional<size_t> firstVisibleCol;
+    std::optional<size_t> lastVisibleCol;
+
     guint hadjHandler = -1;
     guint vadjHandler = -1;
 
@@ -0,0 +1,155 @@
+#include "PageBufferSnapshot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "HitTest.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SNAPSHOT_X86
+#include <immintrin.h>
+#endif
+
+PageBufferSnapshot::PageBufferSnapshot(double zoom, int bufferWidth, int bufferHeight):
+        zoom(zoom), bufferWidth(bufferWidth), bufferHeight(bufferHeight) {}
+
+PageBufferSnapshot::~PageBufferSnapshot() {
+    for (auto& tile: this->tiles) {
+        cairo_surface_destroy(tile.second);
+    }
+}
+
+void PageBufferSnapshot::addTile(Rectangle<int> const& area, cairo_surface_t* tile) {
+    this->tiles.emplace_back(area, cairo_surface_reference(tile));
+}
+
+/**
+ * Adds the channels of count pixels at src to sum[0] ... sum[3]
+ */
+static void sumPixelsScalar(unsigned char const* src, int count, uint32_t* sum) {
+    for (int x = 0; x < count; x++) {
+        sum[0] += src[x * 4];
+        sum[1] += src[x * 4 + 1];
+        sum[2] += src[x * 4 + 2];
+        sum[3] += src[x * 4 + 3];
+    }
+}
+
+#ifdef SNAPSHOT_X86
+
+/**
+ * The four channels of a pixel are summed as four 32 bit lanes. The runs are only factor pixels long,
+ * so AVX2 doesn't pay off.
+ */
+__attribute__((target("sse2"))) static void sumPixelsSse2(unsigned char const* src, int count, uint32_t* sum) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_loadu_si128(reinterpret_cast<__m128i const*>(sum));
+
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        // Pixels 0 + 2 and 1 + 3 in 16 bit, then both in 32 bit
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + x * 4));
+        __m128i pairs = _mm_add_epi16(_mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero));
+        acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(pairs, zero));
+        acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(pairs, zero));
+    }
+    for (; x < count; x++) {
+        int32_t value = 0;
+        std::memcpy(&value, src + x * 4, 4);
+        __m128i pixel = _mm_cvtsi32_si128(value);
+        acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(_mm_unpacklo_epi8(pixel, zero), zero));
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sum), acc);
+}
+
+#endif
+
+auto PageBufferSnapshot::boxDownscale(int factor) const -> cairo_surface_t* {
+    int width = (this->bufferWidth + factor - 1) / factor;
+    int height = (this->bufferHeight + factor - 1) / factor;
+
+    // Sum of each channel, premultiplied alpha can be averaged directly
+    std::vector<uint32_t> sums(static_cast<size_t>(width) * height * 4, 0);
+
+    auto sumPixels = sumPixelsScalar;
+#ifdef SNAPSHOT_X86
+    if (HitTest::getIsa() != HitTest::Isa::SCALAR) {
+        sumPixels = sumPixelsSse2;
+    }
+#endif
+
+    for (auto const& [area, tile]: this->tiles) {
+        cairo_surface_flush(tile);
+        unsigned char const* data = cairo_image_surface_get_data(tile);
+        int stride = cairo_image_surface_get_stride(tile);
+
+        for (int y = 0; y < area.height; y++) {
+            unsigned char const* src = data + static_cast<ptrdiff_t>(y) * stride;
+            uint32_t* rowSums = sums.data() + static_cast<size_t>((area.y + y) / factor) * width * 4;
+
+            // Each run of pixels falling into the same destination pixel is summed at once
+            for (int x = 0; x < area.width;) {
+                int dx = (area.x + x) / factor;
+                int end = std::min(area.width, (dx + 1) * factor - area.x);
+                sumPixels(src + x * 4, end - x, rowSums + static_cast<size_t>(dx) * 4);
+                x = end;
+            }
+        }
+    }
+
+    cairo_surface_t* result = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    unsigned char* data = cairo_image_surface_get_data(result);
+    int stride = cairo_image_surface_get_stride(result);
+
+    for (int y = 0; y < height; y++) {
+        // The last row and column may cover less buffer pixels
+        int rows = std::min(factor, this->bufferHeight - y * factor);
+        unsigned char* dst = data + static_cast<ptrdiff_t>(y) * stride;
+        uint32_t const* rowSums = sums.data() + static_cast<size_t>(y) * width * 4;
+
+        for (int x = 0; x < width; x++) {
+            uint32_t count = static_cast<uint32_t>(rows * std::min(factor, this->bufferWidth - x * factor));
+            for (int c = 0; c < 4; c++) {
+                dst[x * 4 + c] = static_cast<unsigned char>((rowSums[x * 4 + c] + count / 2) / count);
+            }
+        }
+    }
+
+    cairo_surface_mark_dirty(result);
+    return result;
+}
+
+void PageBufferSnapshot::paint(cairo_t* cr) const {
+    double deviceX = 1;
+    double deviceY = 0;
+    cairo_user_to_device_distance(cr, &deviceX, &deviceY);
+    double deviceZoom = std::hypot(deviceX, deviceY);
+
+    int factor = std::max(1, static_cast<int>(this->zoom / deviceZoom));
+
+    cairo_save(cr);
+    cairo_rectangle(cr, 0, 0, this->bufferWidth / this->zoom, this->bufferHeight / this->zoom);
+    cairo_clip(cr);
+
+    if (factor == 1) {
+        cairo_scale(cr, 1 / this->zoom, 1 / this->zoom);
+        for (auto const& [area, tile]: this->tiles) {
+            cairo_set_source_surface(cr, tile, area.x, area.y);
+            cairo_paint(cr);
+        }
+    } else {
+        // The remaining scale is less than 2, which the cairo filter handles well
+        cairo_surface_t* scaled = boxDownscale(factor);
+        cairo_scale(cr, factor / this->zoom, factor / this->zoom);
+        cairo_set_source_surface(cr, scaled, 0, 0);
+        cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+        cairo_paint(cr);
+        cairo_surface_destroy(scaled);
+    }
+
+    cairo_restore(cr);
+}
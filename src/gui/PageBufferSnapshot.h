@@ -0,0 +1,62 @@
+/*
+ * Xournal++
+ *
+ * The tiles of a completely rendered page, for the sidebar previews
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <gtk/gtk.h>
+
+#include "Rectangle.h"
+
+/**
+ * Holds references to the tiles, the page buffer copies a tile before it's changed while a snapshot uses it.
+ * Immutable, so it may be used by several threads.
+ */
+class PageBufferSnapshot {
+public:
+    /**
+     * @param zoom The zoom of the buffer (including the DPI scale factor)
+     * @param bufferWidth The width of the whole page in buffer pixels
+     * @param bufferHeight The height of the whole page in buffer pixels
+     */
+    PageBufferSnapshot(double zoom, int bufferWidth, int bufferHeight);
+    virtual ~PageBufferSnapshot();
+
+    PageBufferSnapshot(const PageBufferSnapshot&) = delete;
+    PageBufferSnapshot& operator=(const PageBufferSnapshot&) = delete;
+
+public:
+    /**
+     * Adds a new reference to the tile, which covers area of the buffer
+     */
+    void addTile(Rectangle<int> const& area, cairo_surface_t* tile);
+
+    /**
+     * Paints the page to cr, which is in page coordinates. Scaled down with a box filter
+     * to about the resolution of cr, so no pixel is skipped.
+     */
+    void paint(cairo_t* cr) const;
+
+private:
+    /**
+     * @return a new surface with the page, each pixel the average of factor x factor buffer pixels
+     */
+    cairo_surface_t* boxDownscale(int factor) const;
+
+private:
+    double zoom;
+    int bufferWidth;
+    int bufferHeight;
+
+    std::vector<std::pair<Rectangle<int>, cairo_surface_t*>> tiles;
+};
@@ -36,6 +36,7 @@
 #include "view/TextView.h"
 #include "widgets/XournalWidget.h"
 
+#include "CompressedTileCache.h"
 #include "PageViewFindObjectHelper.h"
 #include "Range.h"
 #include "Rectangle.h"
@@ -49,6 +50,16 @@
 #include "i18n.h"
 #include "pixbuf-utils.h"
 
+/**
+ * The rerender region is replaced by its bounding box if it consists of more rectangles
+ */
+constexpr int MAX_RERENDER_RECTANGLES = 16;
+
+/**
+ * The render time assumed for a page before it was measured, about an empty page
+ */
+constexpr double DEFAULT_RENDER_MICROS_PER_PIXEL = 0.005;
+
 XojPageView::XojPageView(XournalView* xournal, const PageRef& page) {
     this->page = page;
     this->registerListener(this->page);
@@ -58,6 +69,7 @@ XojPageView::XojPageView(XournalView* xournal, const PageRef& page) {
     g_mutex_init(&this->drawingMutex);
 
     g_mutex_init(&this->repaintRectMutex);
+    this->rerenderRegion = cairo_region_create();
 
     // this does not have to be deleted afterwards:
     // (we need it for undo commands)
@@ -75,13 +87,16 @@ XojPageView::~XojPageView() {
     delete this->inputHandler;
     delete this->eraser;
     endText();
-    deleteViewBuffer();
+    CompressedTileCache::getInstance().invalidate(this);
+    this->xournal->setPageSnapshot(this->page.get(), nullptr);
     delete this->search;
+    cairo_region_destroy(this->rerenderRegion);
 }
 
 void XojPageView::setIsVisible(bool visible) {
     if (visible) {
         this->lastVisibleTime = 0;
+        this->prefetchedBytes = 0;
     } else if (this->lastVisibleTime <= 0) {
         GTimeVal val;
         g_get_current_time(&val);
@@ -89,8 +104,47 @@ void XojPageView::setIsVisible(bool visible) {
     }
 }
 
+void XojPageView::prefetch(bool horizontal, bool fromEnd, int length) {
+    int dpiScaleFactor = xournal->getDpiScaleFactor();
+    int bufferWidth = getDisplayWidth() * dpiScaleFactor;
+    int bufferHeight = getDisplayHeight() * dpiScaleFactor;
+    length *= dpiScaleFactor;
+
+    Rectangle<int> area(0, 0, bufferWidth, bufferHeight);
+    if (horizontal) {
+        area.width = std::min(length, bufferWidth);
+        area.x = fromEnd ? bufferWidth - area.width : 0;
+    } else {
+        area.height = std::min(length, bufferHeight);
+        area.y = fromEnd ? bufferHeight - area.height : 0;
+    }
+
+    g_mutex_lock(&this->drawingMutex);
+    this->buffer.setWantedArea(getBufferZoom(), bufferWidth, bufferHeight, &area);
+    g_mutex_unlock(&this->drawingMutex);
+
+    this->prefetchedBytes = static_cast<size_t>(area.width) * area.height * 4;
+
+    if (this->lastVisibleTime < 0) {
+        // Let the memory cleanup free the buffer if the page doesn't get visible
+        GTimeVal val;
+        g_get_current_time(&val);
+        this->lastVisibleTime = val.tv_sec;
+    }
+
+    this->xournal->getControl()->getScheduler()->addPrefetchPage(this);
+}
+
+auto XojPageView::getPrefetchedBytes() const -> size_t { return this->prefetchedBytes; }
+
+void XojPageView::clearPrefetch() { this->prefetchedBytes = 0; }
+
 auto XojPageView::getLastVisibleTime() -> int {
-    if (this->crBuffer == nullptr) {
+    g_mutex_lock(&this->drawingMutex);
+    bool empty = this->buffer.isEmpty();
+    g_mutex_unlock(&this->drawingMutex);
+
+    if (empty) {
         return -1;
     }
 
@@ -99,11 +153,25 @@ auto XojPageView::getLastVisibleTime() -> int {
 
 void XojPageView::deleteViewBuffer() {
     g_mutex_lock(&this->drawingMutex);
-    if (this->crBuffer) {
-        cairo_surface_destroy(this->crBuffer);
-        this->crBuffer = nullptr;
+
+    // Locked while the tiles are stored, so no rerender can be added meanwhile
+    g_mutex_lock(&this->repaintRectMutex);
+    bool pending = this->rerenderComplete || !cairo_region_is_empty(this->rerenderRegion);
+
+    // Restored by the render job if the page gets visible again. Outdated tiles are not kept.
+    if (!pending) {
+        this->buffer.forEachTile([this](TiledPageBuffer::TileKey const& key, cairo_surface_t* tile) {
+            CompressedTileCache::getInstance().store(this, key, tile);
+        });
     }
+    g_mutex_unlock(&this->repaintRectMutex);
+
+    this->buffer.clear();
     g_mutex_unlock(&this->drawingMutex);
+
+    this->layerComposite.clear();
+    this->xournal->setPageSnapshot(this->page.get(), nullptr);
+    this->prefetchedBytes = 0;
 }
 
 auto XojPageView::containsPoint(int x, int y, bool local) const -> bool {
@@ -204,9 +272,10 @@ void XojPageView::startText(double x, double y) {
         // Is there already a textfield?
         Text* text = nullptr;
 
-        for (Element* e: *this->page->getSelectedLayer()->getElements()) {
+        GdkRectangle matchRect = {gint(x - 10), gint(y - 10), 20, 20};
+        for (Element* e: this->page->getSelectedLayer()->getElementsInArea(matchRect.x, matchRect.y, matchRect.width,
+                                                                          matchRect.height)) {
             if (e->getType() == ELEMENT_TEXT) {
-                GdkRectangle matchRect = {gint(x - 10), gint(y - 10), 20, 20};
                 if (e->intersectsArea(&matchRect)) {
                     text = dynamic_cast<Text*>(e);
                     break;
@@ -314,7 +383,7 @@ auto XojPageView::onButtonPressEvent(const PositionInputData& pos) -> bool {
         }
         this->inputHandler->onButtonPressEvent(pos);
     } else if (h->getToolType() == TOOL_ERASER) {
-        this->eraser->erase(x, y);
+        this->eraser->start(x, y);
         this->inEraser = true;
     } else if (h->getToolType() == TOOL_VERTICAL_SPACE) {
         this->verticalSpace = new VerticalToolHandler(this, this->page, this->settings, y, zoom);
@@ -600,10 +669,22 @@ auto XojPageView::onKeyReleaseEvent(GdkEventKey* event) -> bool {
 }
 
 void XojPageView::rerenderPage() {
+    g_mutex_lock(&this->repaintRectMutex);
     this->rerenderComplete = true;
+    g_mutex_unlock(&this->repaintRectMutex);
+
+    dropStaleCopies();
+    this->layerComposite.clear();
     this->xournal->getControl()->getScheduler()->addRerenderPage(this);
 }
 
+void XojPageView::dropStaleCopies() {
+    // After the rerender is marked, so deleteViewBuffer() doesn't store the old tiles again,
+    // and a render job doesn't publish a snapshot of them again
+    CompressedTileCache::getInstance().invalidate(this);
+    this->xournal->setPageSnapshot(this->page.get(), nullptr);
+}
+
 void XojPageView::repaintPage() { xournal->getRepaintHandler()->repaintPage(this); }
 
 void XojPageView::repaintArea(double x1, double y1, double x2, double y2) {
@@ -622,28 +703,36 @@ void XojPageView::rerenderRect(double x, double y, double width, double height)
 }
 
 void XojPageView::addRerenderRect(double x, double y, double width, double height) {
+    int x1 = static_cast<int>(std::floor(x));
+    int y1 = static_cast<int>(std::floor(y));
+    cairo_rectangle_int_t rect = {x1, y1, static_cast<int>(std::ceil(x + width)) - x1,
+                                  static_cast<int>(std::ceil(y + height)) - y1};
+    cairo_rectangle_int_t pageRect = {0, 0, static_cast<int>(std::ceil(this->page->getWidth())),
+                                      static_cast<int>(std::ceil(this->page->getHeight()))};
+
+    g_mutex_lock(&this->repaintRectMutex);
+
+    // The whole page is rendered anyway
     if (this->rerenderComplete) {
+        g_mutex_unlock(&this->repaintRectMutex);
         return;
     }
 
-    auto rect = Rectangle<double>{x, y, width, height};
-
-    g_mutex_lock(&this->repaintRectMutex);
+    // Overlapping rectangles are only rendered once
+    cairo_region_union_rectangle(this->rerenderRegion, &rect);
+    cairo_region_intersect_rectangle(this->rerenderRegion, &pageRect);
 
-    for (auto&& r: this->rerenderRects) {
-        // its faster to redraw only one rect than repaint twice the same area
-        // so loop through the rectangles to be redrawn, if new rectangle
-        // intersects any of them, replace it by the union with the new one
-        if (r.intersects(rect)) {
-            r.unite(rect);
-            g_mutex_unlock(&this->repaintRectMutex);
-            return;
-        }
+    // Many small pieces are slower to render than their bounding box
+    if (cairo_region_num_rectangles(this->rerenderRegion) > MAX_RERENDER_RECTANGLES) {
+        cairo_rectangle_int_t extents;
+        cairo_region_get_extents(this->rerenderRegion, &extents);
+        cairo_region_destroy(this->rerenderRegion);
+        this->rerenderRegion = cairo_region_create_rectangle(&extents);
     }
 
-    this->rerenderRects.push_back(rect);
     g_mutex_unlock(&this->repaintRectMutex);
 
+    dropStaleCopies();
     this->xournal->getControl()->getScheduler()->addRerenderPage(this);
 }
 
@@ -717,56 +806,50 @@ void XojPageView::drawLoadingPage(cairo_t* cr) {
  * Does the painting, called in synchronized block
  */
 void XojPageView::paintPageSync(cairo_t* cr, GdkRectangle* rect) {
-    if (this->crBuffer == nullptr) {
-        drawLoadingPage(cr);
-        return;
-    }
-
     double zoom = xournal->getZoom();
-    int dispWidth = getDisplayWidth();
-
-    cairo_save(cr);
+    int dpiScaleFactor = xournal->getDpiScaleFactor();
+    double bufferZoom = getBufferZoom();
 
-    double width = cairo_image_surface_get_width(this->crBuffer);
-
-    bool rerender = true;
-    if (width / xournal->getDpiScaleFactor() == dispWidth) {
-        rerender = false;
+    // Only the tiles in the visible part of the page are rendered
+    Rectangle<double>* visible = this->xournal->getVisibleRect(this);
+    bool isVisible = visible != nullptr;
+    Rectangle<int> visibleArea;
+    if (isVisible) {
+        int x1 = static_cast<int>(std::floor(visible->x * bufferZoom));
+        int y1 = static_cast<int>(std::floor(visible->y * bufferZoom));
+        int x2 = static_cast<int>(std::ceil((visible->x + visible->width) * bufferZoom));
+        int y2 = static_cast<int>(std::ceil((visible->y + visible->height) * bufferZoom));
+        visibleArea = Rectangle<int>(x1, y1, x2 - x1, y2 - y1);
+        delete visible;
     }
 
-    if (width != dispWidth) {
-        double scale = (static_cast<double>(dispWidth)) / (width);
-
-        // Scale current image to fit the zoom level
-        cairo_scale(cr, scale, scale);
-        cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_FAST);
+    bool empty = this->buffer.isEmpty();
 
-        cairo_set_source_surface(cr, this->crBuffer, 0, 0);
+    cairo_save(cr);
+    cairo_scale(cr, 1.0 / dpiScaleFactor, 1.0 / dpiScaleFactor);
+    bool complete = this->buffer.paint(cr, bufferZoom, getDisplayWidth() * dpiScaleFactor,
+                                       getDisplayHeight() * dpiScaleFactor, isVisible ? &visibleArea : nullptr);
+    cairo_restore(cr);
 
-        if (rerender) {
-            rerenderPage();
-        }
+    this->xournal->countBufferPaint(!empty && complete);
 
-        rect = nullptr;
-    } else {
-        cairo_set_source_surface(cr, this->crBuffer, 0, 0);
+    if (empty) {
+        drawLoadingPage(cr);
+        return;
     }
 
-    if (rect) {
-        cairo_rectangle(cr, rect->x, rect->y, rect->width, rect->height);
-        cairo_fill(cr);
+    if (!complete) {
+        this->xournal->getControl()->getScheduler()->addRerenderPage(this);
+    }
 
 #ifdef DEBUG_SHOW_PAINT_BOUNDS
+    if (rect) {
         cairo_set_source_rgb(cr, 1.0, 0.5, 1.0);
         cairo_set_line_width(cr, 1. / zoom);
         cairo_rectangle(cr, rect->x, rect->y, rect->width, rect->height);
         cairo_stroke(cr);
-#endif
-    } else {
-        cairo_paint(cr);
     }
-
-    cairo_restore(cr);
+#endif
 
     // don't paint this with scale, because it needs a 1:1 zoom
     if (this->verticalSpace) {
@@ -812,10 +895,29 @@ auto XojPageView::paintPage(cairo_t* cr, GdkRectangle* rect) -> bool {
 auto XojPageView::isSelected() const -> bool { return selected; }
 
 auto XojPageView::getBufferPixels() -> int {
-    if (crBuffer) {
-        return cairo_image_surface_get_width(crBuffer) * cairo_image_surface_get_height(crBuffer);
+    g_mutex_lock(&this->drawingMutex);
+    int pixels = this->buffer.getPixels();
+    g_mutex_unlock(&this->drawingMutex);
+    return pixels;
+}
+
+auto XojPageView::getCompositePixels() -> int { return this->layerComposite.getPixels(); }
+
+auto XojPageView::getRerenderCost() -> double {
+    g_mutex_lock(&this->drawingMutex);
+    int pixels = this->buffer.getPixels();
+    double micros = this->renderMicrosPerPixel;
+    g_mutex_unlock(&this->drawingMutex);
+
+    // Pages which were not measured yet are assumed to be simple
+    if (micros <= 0) {
+        micros = DEFAULT_RENDER_MICROS_PER_PIXEL;
     }
-    return 0;
+    return pixels * micros;
+}
+
+auto XojPageView::getBufferZoom() const -> double {
+    return this->xournal->getZoom() * this->xournal->getDpiScaleFactor();
 }
 
 auto XojPageView::getSelectionColor() -> GdkRGBA { return Util::rgb_to_GdkRGBA(settings->getSelectionColor()); }
@@ -900,11 +1002,9 @@ void XojPageView::elementChanged(Element* elem) {
     if (this->inputHandler && elem == this->inputHandler->getStroke()) {
         g_mutex_lock(&this->drawingMutex);
 
-        cairo_t* cr = cairo_create(this->crBuffer);
-
-        this->inputHandler->draw(cr);
-
-        cairo_destroy(cr);
+        int dpiScaleFactor = this->xournal->getDpiScaleFactor();
+        Rectangle<int> pageArea(0, 0, getDisplayWidth() * dpiScaleFactor, getDisplayHeight() * dpiScaleFactor);
+        this->buffer.drawOnTiles(getBufferZoom(), pageArea, [&](cairo_t* cr) { this->inputHandler->draw(cr); });
 
         g_mutex_unlock(&this->drawingMutex);
     } else {
@@ -16,9 +16,11 @@
 #include "model/PageRef.h"
 #include "model/TexImage.h"
 
+#include "LayerComposite.h"
 #include "Layout.h"
 #include "Range.h"
 #include "Redrawable.h"
+#include "TiledPageBuffer.h"
 
 class EditSelection;
 class EraseHandler;
@@ -49,6 +51,25 @@ public:
 
     void setIsVisible(bool visible);
 
+    /**
+     * Renders the part of the page which gets visible first if it's scrolled in, while it's not visible yet
+     *
+     * @param horizontal The page is scrolled in horizontally
+     * @param fromEnd The page is entered from its bottom / right end
+     * @param length The length of the area, in widget pixels in scroll direction
+     */
+    void prefetch(bool horizontal, bool fromEnd, int length);
+
+    /**
+     * @return the bytes of the area rendered by prefetch(), 0 if the page got visible or the buffer was freed
+     */
+    size_t getPrefetchedBytes() const;
+
+    /**
+     * The prefetched area isn't rendered, e.g. because the prefetch job was removed
+     */
+    void clearPrefetch();
+
     bool isSelected() const;
 
     void endText();
@@ -87,6 +108,16 @@ public:
     GdkRGBA getSelectionColor() override;
     int getBufferPixels();
 
+    /**
+     * @return the pixels of the cached layer composite, which is freed with the buffer
+     */
+    int getCompositePixels();
+
+    /**
+     * @return the estimated time in µs to render the buffer again, from the last render time of this page
+     */
+    double getRerenderCost();
+
     /**
      * 0 if currently visible
      * -1 if no image is saved (never visible or cleanup)
@@ -172,8 +203,18 @@ private:
 
     void addRerenderRect(double x, double y, double width, double height);
 
+    /**
+     * Drops the compressed tiles and the snapshot of the page, called after a rerender is marked
+     */
+    void dropStaleCopies();
+
     void drawLoadingPage(cairo_t* cr);
 
+    /**
+     * The zoom of the page buffer, including the DPI scale factor
+     */
+    double getBufferZoom() const;
+
     void setX(int x);
     void setY(int y);
 
@@ -204,7 +245,10 @@ private:
 
     bool selected = false;
 
-    cairo_surface_t* crBuffer = nullptr;
+    /**
+     * The rendered page, locked by drawingMutex
+     */
+    TiledPageBuffer buffer;
 
     bool inEraser = false;
 
@@ -223,12 +267,34 @@ private:
      */
     int lastVisibleTime = -1;
 
+    /**
+     * The bytes of the buffer area rendered by prefetch(), only used by the UI thread
+     */
+    size_t prefetchedBytes = 0;
+
+    /**
+     * Locked after drawingMutex if both are needed
+     */
     GMutex repaintRectMutex{};
-    vector<Rectangle<double>> rerenderRects;
+
+    /**
+     * The area to rerender, in page coordinates rounded outwards
+     */
+    cairo_region_t* rerenderRegion = nullptr;
     bool rerenderComplete = false;
 
     GMutex drawingMutex{};
 
+    /**
+     * Measured by the last render job, 0 if not known yet, guarded by drawingMutex
+     */
+    double renderMicrosPerPixel = 0;
+
+    /**
+     * The layers around the selected layer, so a partial rerender only draws the selected layer
+     */
+    LayerComposite layerComposite;
+
     int dispX{};  // position on display - set in Layout::layoutPages
     int dispY{};
 
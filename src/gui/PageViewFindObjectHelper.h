@@ -48,7 +48,7 @@ protected:
         double minDistSq = std::numeric_limits<double>::max();
         const double mX = matchRect.x + matchRect.width / 2.0;
         const double mY = matchRect.y + matchRect.height / 2.0;
-        for (Element* e: *l->getElements()) {
+        for (Element* e: l->getElementsInArea(matchRect.x, matchRect.y, matchRect.width, matchRect.height)) {
             const double eX = e->getX() + e->getElementWidth() / 2.0;
             const double eY = e->getY() + e->getElementHeight() / 2.0;
             const double dx = eX - mX;
@@ -0,0 +1,254 @@
+#include "TiledPageBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+/**
+ * Tiles within this count of tiles around the visible area are kept, the others are freed
+ */
+constexpr int TILE_KEEP_MARGIN = 2;
+
+auto TiledPageBuffer::TileKey::operator<(const TileKey& other) const -> bool {
+    return std::tie(zoom, col, row) < std::tie(other.zoom, other.col, other.row);
+}
+
+TiledPageBuffer::TiledPageBuffer() = default;
+
+TiledPageBuffer::~TiledPageBuffer() { clear(); }
+
+void TiledPageBuffer::clear() {
+    for (auto& entry: this->tiles) {
+        cairo_surface_destroy(entry.second.surface);
+    }
+    this->tiles.clear();
+}
+
+void TiledPageBuffer::invalidateAll() {
+    for (auto& entry: this->tiles) {
+        entry.second.dirty = true;
+    }
+}
+
+void TiledPageBuffer::dropOtherZooms(double zoom) {
+    for (auto it = this->tiles.begin(); it != this->tiles.end();) {
+        if (it->first.zoom != zoom) {
+            cairo_surface_destroy(it->second.surface);
+            it = this->tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+auto TiledPageBuffer::isEmpty() const -> bool { return this->tiles.empty(); }
+
+auto TiledPageBuffer::getPixels() const -> int {
+    int pixels = 0;
+    for (auto const& entry: this->tiles) {
+        pixels += cairo_image_surface_get_width(entry.second.surface) *
+                  cairo_image_surface_get_height(entry.second.surface);
+    }
+    return pixels;
+}
+
+auto TiledPageBuffer::getTileArea(TileKey const& key) const -> Rectangle<int> {
+    int x = key.col * TILE_SIZE;
+    int y = key.row * TILE_SIZE;
+    return Rectangle<int>(x, y, std::min(TILE_SIZE, this->bufferWidth - x), std::min(TILE_SIZE, this->bufferHeight - y));
+}
+
+void TiledPageBuffer::setWantedArea(double zoom, int bufferWidth, int bufferHeight, Rectangle<int> const* area) {
+    if (bufferWidth != this->bufferWidth || bufferHeight != this->bufferHeight) {
+        // The page size changed, the edge tiles don't fit anymore
+        clear();
+        this->bufferWidth = bufferWidth;
+        this->bufferHeight = bufferHeight;
+    }
+
+    if (area && area->width > 0 && area->height > 0) {
+        this->wantedZoom = zoom;
+        this->wantedCol1 = std::max(area->x, 0) / TILE_SIZE;
+        this->wantedRow1 = std::max(area->y, 0) / TILE_SIZE;
+        this->wantedCol2 = (std::min(area->x + area->width, bufferWidth) - 1) / TILE_SIZE;
+        this->wantedRow2 = (std::min(area->y + area->height, bufferHeight) - 1) / TILE_SIZE;
+    } else {
+        this->wantedCol2 = -1;
+        this->wantedRow2 = -1;
+    }
+}
+
+auto TiledPageBuffer::paint(cairo_t* cr, double zoom, int bufferWidth, int bufferHeight, Rectangle<int> const* visible)
+        -> bool {
+    setWantedArea(zoom, bufferWidth, bufferHeight, visible);
+
+    double x1 = NAN, y1 = NAN, x2 = NAN, y2 = NAN;
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+    x1 = std::max(x1, 0.0);
+    y1 = std::max(y1, 0.0);
+    x2 = std::min(x2, static_cast<double>(bufferWidth));
+    y2 = std::min(y2, static_cast<double>(bufferHeight));
+
+    bool complete = this->wantedCol2 < 0 || getTilesToRender(zoom).empty();
+
+    if (x2 <= x1 || y2 <= y1) {
+        return complete;
+    }
+
+    int col1 = static_cast<int>(x1) / TILE_SIZE;
+    int row1 = static_cast<int>(y1) / TILE_SIZE;
+    int col2 = (static_cast<int>(std::ceil(x2)) - 1) / TILE_SIZE;
+    int row2 = (static_cast<int>(std::ceil(y2)) - 1) / TILE_SIZE;
+
+    bool missing = false;
+    for (int col = col1; col <= col2 && !missing; col++) {
+        for (int row = row1; row <= row2; row++) {
+            if (this->tiles.find({zoom, col, row}) == this->tiles.end()) {
+                missing = true;
+                break;
+            }
+        }
+    }
+
+    if (missing) {
+        // Placeholder for the missing tiles: white, and the tiles of the last zoom scaled
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_rectangle(cr, x1, y1, x2 - x1, y2 - y1);
+        cairo_fill(cr);
+
+        for (auto const& entry: this->tiles) {
+            if (entry.first.zoom == zoom) {
+                continue;
+            }
+
+            double scale = zoom / entry.first.zoom;
+            cairo_save(cr);
+            cairo_scale(cr, scale, scale);
+            cairo_set_source_surface(cr, entry.second.surface, entry.first.col * TILE_SIZE,
+                                     entry.first.row * TILE_SIZE);
+            cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_FAST);
+            cairo_paint(cr);
+            cairo_restore(cr);
+        }
+    }
+
+    for (int col = col1; col <= col2; col++) {
+        for (int row = row1; row <= row2; row++) {
+            auto it = this->tiles.find({zoom, col, row});
+            if (it == this->tiles.end()) {
+                continue;
+            }
+
+            Rectangle<int> area = getTileArea(it->first);
+            cairo_set_source_surface(cr, it->second.surface, area.x, area.y);
+            cairo_rectangle(cr, area.x, area.y, area.width, area.height);
+            cairo_fill(cr);
+        }
+    }
+
+    if (complete && this->wantedCol2 >= 0) {
+        dropOtherZooms(zoom);
+        dropTilesOutside(zoom, this->wantedCol1 - TILE_KEEP_MARGIN, this->wantedRow1 - TILE_KEEP_MARGIN,
+                         this->wantedCol2 + TILE_KEEP_MARGIN, this->wantedRow2 + TILE_KEEP_MARGIN);
+    }
+
+    return complete;
+}
+
+auto TiledPageBuffer::getTilesToRender(double zoom) const -> std::vector<TileKey> {
+    std::vector<TileKey> result;
+    if (zoom != this->wantedZoom) {
+        return result;
+    }
+
+    for (int row = this->wantedRow1; row <= this->wantedRow2; row++) {
+        for (int col = this->wantedCol1; col <= this->wantedCol2; col++) {
+            auto it = this->tiles.find({zoom, col, row});
+            if (it == this->tiles.end() || it->second.dirty) {
+                result.push_back({zoom, col, row});
+            }
+        }
+    }
+    return result;
+}
+
+void TiledPageBuffer::setTile(TileKey const& key, cairo_surface_t* surface) {
+    Tile& tile = this->tiles[key];
+    if (tile.surface) {
+        cairo_surface_destroy(tile.surface);
+    }
+    tile.surface = surface;
+    tile.dirty = false;
+}
+
+void TiledPageBuffer::drawOnTiles(double zoom, Rectangle<int> const& area, std::function<void(cairo_t*)> const& fn) {
+    for (auto& entry: this->tiles) {
+        if (entry.first.zoom != zoom || entry.second.dirty) {
+            continue;
+        }
+
+        Rectangle<int> tileArea = getTileArea(entry.first);
+        if (!tileArea.intersects(area)) {
+            continue;
+        }
+
+        // The tile is used by a snapshot, which must not change
+        if (cairo_surface_get_reference_count(entry.second.surface) > 1) {
+            cairo_surface_t* copy = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, tileArea.width, tileArea.height);
+            cairo_t* crCopy = cairo_create(copy);
+            cairo_set_source_surface(crCopy, entry.second.surface, 0, 0);
+            cairo_set_operator(crCopy, CAIRO_OPERATOR_SOURCE);
+            cairo_paint(crCopy);
+            cairo_destroy(crCopy);
+
+            cairo_surface_destroy(entry.second.surface);
+            entry.second.surface = copy;
+        }
+
+        cairo_t* cr = cairo_create(entry.second.surface);
+        cairo_translate(cr, -tileArea.x, -tileArea.y);
+        fn(cr);
+        cairo_destroy(cr);
+    }
+}
+
+auto TiledPageBuffer::createSnapshot(double zoom) const -> std::shared_ptr<PageBufferSnapshot> {
+    if (this->bufferWidth <= 0 || this->bufferHeight <= 0) {
+        return nullptr;
+    }
+
+    auto snapshot = std::make_shared<PageBufferSnapshot>(zoom, this->bufferWidth, this->bufferHeight);
+
+    int cols = (this->bufferWidth + TILE_SIZE - 1) / TILE_SIZE;
+    int rows = (this->bufferHeight + TILE_SIZE - 1) / TILE_SIZE;
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            auto it = this->tiles.find({zoom, col, row});
+            if (it == this->tiles.end() || it->second.dirty) {
+                return nullptr;
+            }
+            snapshot->addTile(getTileArea(it->first), it->second.surface);
+        }
+    }
+    return snapshot;
+}
+
+void TiledPageBuffer::forEachTile(std::function<void(TileKey const&, cairo_surface_t*)> const& fn) const {
+    for (auto const& entry: this->tiles) {
+        if (!entry.second.dirty) {
+            fn(entry.first, entry.second.surface);
+        }
+    }
+}
+
+void TiledPageBuffer::dropTilesOutside(double zoom, int col1, int row1, int col2, int row2) {
+    for (auto it = this->tiles.begin(); it != this->tiles.end();) {
+        TileKey const& key = it->first;
+        if (key.zoom == zoom && (key.col < col1 || key.col > col2 || key.row < row1 || key.row > row2)) {
+            cairo_surface_destroy(it->second.surface);
+            it = this->tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
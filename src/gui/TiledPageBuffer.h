@@ -0,0 +1,148 @@
+/*
+ * Xournal++
+ *
+ * The rendered content of a page, split into tiles
+ * so that only the visible part of a page needs to be rendered and kept
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <gtk/gtk.h>
+
+#include "PageBufferSnapshot.h"
+#include "Rectangle.h"
+
+/**
+ * All methods have to be called with the drawing mutex of the page view locked
+ */
+class TiledPageBuffer {
+public:
+    /**
+     * Edge length of a tile, in buffer pixels
+     */
+    static constexpr int TILE_SIZE = 256;
+
+    struct TileKey {
+        double zoom;
+        int col;
+        int row;
+
+        bool operator<(const TileKey& other) const;
+    };
+
+public:
+    TiledPageBuffer();
+    virtual ~TiledPageBuffer();
+
+    TiledPageBuffer(const TiledPageBuffer&) = delete;
+    TiledPageBuffer& operator=(const TiledPageBuffer&) = delete;
+
+public:
+    /**
+     * Free all tiles
+     */
+    void clear();
+
+    /**
+     * Mark all tiles as outdated, they are still painted until they are replaced
+     */
+    void invalidateAll();
+
+    /**
+     * Free the tiles rendered with another zoom
+     */
+    void dropOtherZooms(double zoom);
+
+    /**
+     * @return true if there are no tiles
+     */
+    bool isEmpty() const;
+
+    /**
+     * @return the count of pixels of all tiles
+     */
+    int getPixels() const;
+
+    /**
+     * Sets the area which is rendered by getTilesToRender(), e.g. to render a page before it gets visible
+     *
+     * @param area The area in buffer pixels, nullptr if nothing should be rendered
+     */
+    void setWantedArea(double zoom, int bufferWidth, int bufferHeight, Rectangle<int> const* area);
+
+    /**
+     * Paints the tiles to cr, which is scaled to buffer pixels.
+     * The visible area is remembered as the area which should be rendered,
+     * tiles far away from it are freed.
+     *
+     * @param zoom The current zoom of the buffer (including the DPI scale factor)
+     * @param bufferWidth The width of the whole page in buffer pixels
+     * @param bufferHeight The height of the whole page in buffer pixels
+     * @param visible The visible part of the page in buffer pixels, nullptr if unknown
+     * @return true if all visible tiles are available and up to date
+     */
+    bool paint(cairo_t* cr, double zoom, int bufferWidth, int bufferHeight, Rectangle<int> const* visible);
+
+    /**
+     * @return the tiles in the last painted area which are missing or outdated
+     */
+    std::vector<TileKey> getTilesToRender(double zoom) const;
+
+    /**
+     * The area of a tile in buffer pixels
+     */
+    Rectangle<int> getTileArea(TileKey const& key) const;
+
+    /**
+     * Stores a rendered tile, takes the ownership of the surface
+     */
+    void setTile(TileKey const& key, cairo_surface_t* surface);
+
+    /**
+     * Calls fn for all up to date tiles with this zoom intersecting the area (in buffer pixels),
+     * with a context translated to buffer pixel coordinates
+     */
+    void drawOnTiles(double zoom, Rectangle<int> const& area, std::function<void(cairo_t*)> const& fn);
+
+    /**
+     * @return the tiles of the whole page, nullptr if not all tiles with this zoom are there and up to date
+     */
+    std::shared_ptr<PageBufferSnapshot> createSnapshot(double zoom) const;
+
+    /**
+     * Calls fn for all up to date tiles
+     */
+    void forEachTile(std::function<void(TileKey const&, cairo_surface_t*)> const& fn) const;
+
+private:
+    struct Tile {
+        cairo_surface_t* surface = nullptr;
+        bool dirty = false;
+    };
+
+    void dropTilesOutside(double zoom, int col1, int row1, int col2, int row2);
+
+private:
+    std::map<TileKey, Tile> tiles;
+
+    /**
+     * The tile range visible during the last paint, or set by setWantedArea()
+     */
+    double wantedZoom = 0;
+    int wantedCol1 = 0;
+    int wantedRow1 = 0;
+    int wantedCol2 = -1;
+    int wantedRow2 = -1;
+    int bufferWidth = 0;
+    int bufferHeight = 0;
+};
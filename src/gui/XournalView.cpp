@@ -1,8 +1,11 @@
 #include "XournalView.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include <gdk/gdk.h>
 
@@ -16,6 +19,7 @@
 #include "widgets/XournalWidget.h"
 
 #include "Layout.h"
+#include "PageBufferSnapshot.h"
 #include "PageView.h"
 #include "Rectangle.h"
 #include "RepaintHandler.h"
@@ -26,7 +30,8 @@
 
 XournalView::XournalView(GtkWidget* parent, Control* control, ScrollHandling* scrollHandling):
         scrollHandling(scrollHandling), control(control) {
-    this->cache = new PdfCache(control->getSettings()->getPdfPageCacheSize());
+    g_mutex_init(&this->snapshotMutex);
+    this->cache = new PdfCache(static_cast<size_t>(control->getSettings()->getPdfCacheMemoryLimit()) * 1024 * 1024);
     registerListener(control);
 
     InputContext* inputContext = nullptr;
@@ -75,10 +80,8 @@ XournalView::~XournalView() {
 
     delete this->handRecognition;
     this->handRecognition = nullptr;
-}
 
-auto pageViewIncreasingClockTime(XojPageView* a, XojPageView* b) -> gint {
-    return a->getLastVisibleTime() - b->getLastVisibleTime();  // >0 will put a after b
+    g_mutex_clear(&this->snapshotMutex);
 }
 
 void XournalView::staticLayoutPages(GtkWidget* widget, GtkAllocation* allocation, void* data) {
@@ -86,42 +89,114 @@ void XournalView::staticLayoutPages(GtkWidget* widget, GtkAllocation* allocation
     xv->layoutPages();
 }
 
+/**
+ * The gap between a page and the visible area, in widget pixels, 0 if the page is visible
+ */
+static auto distanceToViewport(XojPageView* v, Rectangle<double> const& viewport) -> double {
+    double dx = std::max({0.0, viewport.x - (v->getX() + v->getDisplayWidth()),
+                          v->getX() - (viewport.x + viewport.width)});
+    double dy = std::max({0.0, viewport.y - (v->getY() + v->getDisplayHeight()),
+                          v->getY() - (viewport.y + viewport.height)});
+    return std::hypot(dx, dy);
+}
+
 auto XournalView::clearMemoryTimer(XournalView* widget) -> gboolean {
-    GList* list = nullptr;
+    Rectangle<double> viewport = gtk_xournal_get_layout(widget->widget)->getVisibleRect();
+
+    struct Candidate {
+        XojPageView* view;
+        int64_t bytes;
+        double keepValue;
+    };
 
-    for (auto&& page: widget->viewPages) {
-        if (page->getLastVisibleTime() > 0) {
-            list = g_list_insert_sorted(list, page, reinterpret_cast<GCompareFunc>(pageViewIncreasingClockTime));
+    std::vector<Candidate> candidates;
+    int64_t usedBytes = 0;
+
+    for (auto&& v: widget->viewPages) {
+        if (v->getLastVisibleTime() < 0) {
+            continue;
         }
-    }
 
-    int pixel = 2884560;
-    int firstPages = 4;
+        // deleteViewBuffer frees the layer composite as well
+        int64_t bytes = (static_cast<int64_t>(v->getBufferPixels()) + v->getCompositePixels()) * 4;
+        usedBytes += bytes;
 
-    int i = 0;
+        double distance = distanceToViewport(v, viewport);
+        if (distance <= 0) {
+            // Visible pages would be rendered again right away
+            continue;
+        }
 
-    for (GList* l = g_list_last(list); l != nullptr; l = l->prev)  // older (higher time) to newer (lower time)
-    {
-        if (firstPages) {
-            firstPages--;
-        } else {
-            auto* v = static_cast<XojPageView*>(l->data);
+        // The tiles of a snapshot are copied once the buffer changes, which isn't counted above.
+        // The preview job renders the page itself without it.
+        widget->setPageSnapshot(v->getPage().get(), nullptr);
 
-            if (pixel <= 0) {
-                v->deleteViewBuffer();
-            } else {
-                pixel -= v->getBufferPixels();
-            }
+        // Far away pages which are fast to render again are freed first
+        candidates.push_back({v, bytes, v->getRerenderCost() / distance});
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](Candidate const& a, Candidate const& b) { return a.keepValue < b.keepValue; });
+
+    int64_t maxBytes = static_cast<int64_t>(widget->control->getSettings()->getPageBufferMemoryLimit()) * 1024 * 1024;
+    for (Candidate const& c: candidates) {
+        if (usedBytes <= maxBytes) {
+            break;
         }
-        i++;
+        c.view->deleteViewBuffer();
+        usedBytes -= c.bytes;
+        widget->bufferStatistics.evictions++;
     }
 
-    g_list_free(list);
+    BufferStatistics const& now = widget->bufferStatistics;
+    BufferStatistics& last = widget->lastBufferStatistics;
+    uint64_t paints = (now.hits - last.hits) + (now.misses - last.misses);
+    if (paints > 0 || now.evictions != last.evictions) {
+        g_debug("Page buffers: %.1f%% hits of %llu paints, %llu evictions, %lld KiB used",
+                paints ? 100.0 * (now.hits - last.hits) / paints : 0.0, static_cast<unsigned long long>(paints),
+                static_cast<unsigned long long>(now.evictions - last.evictions),
+                static_cast<long long>(usedBytes / 1024));
+    }
+    last = now;
 
     // call again
     return true;
 }
 
+void XournalView::countBufferPaint(bool hit) {
+    if (hit) {
+        this->bufferStatistics.hits++;
+    } else {
+        this->bufferStatistics.misses++;
+    }
+}
+
+auto XournalView::getBufferStatistics() const -> BufferStatistics const& { return this->bufferStatistics; }
+
+void XournalView::setPageSnapshot(const XojPage* page, std::shared_ptr<PageBufferSnapshot> snapshot) {
+    g_mutex_lock(&this->snapshotMutex);
+    if (snapshot) {
+        this->pageSnapshots[page] = std::move(snapshot);
+    } else {
+        this->pageSnapshots.erase(page);
+    }
+    g_mutex_unlock(&this->snapshotMutex);
+}
+
+auto XournalView::takePageSnapshot(const XojPage* page) -> std::shared_ptr<PageBufferSnapshot> {
+    std::shared_ptr<PageBufferSnapshot> snapshot;
+
+    g_mutex_lock(&this->snapshotMutex);
+    auto it = this->pageSnapshots.find(page);
+    if (it != this->pageSnapshots.end()) {
+        snapshot = std::move(it->second);
+        this->pageSnapshots.erase(it);
+    }
+    g_mutex_unlock(&this->snapshotMutex);
+
+    return snapshot;
+}
+
 auto XournalView::getCurrentPage() const -> size_t { return currentPage; }
 
 const int scrollKeySize = 30;
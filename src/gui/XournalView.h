@@ -11,6 +11,10 @@
 
 #pragma once
 
+#include <cstdint>
+#include <map>
+#include <memory>
+
 #include <gtk/gtk.h>
 
 #include "control/zoom/ZoomListener.h"
@@ -30,8 +34,21 @@ class RepaintHandler;
 class ScrollHandling;
 class TextEditor;
 class HandRecognition;
+class PageBufferSnapshot;
+class XojPage;
 
 class XournalView: public DocumentListener, public ZoomListener {
+public:
+    /**
+     * Counts how often pages were painted from a complete buffer (hits) or not (misses),
+     * and how often the memory cleanup freed a page buffer
+     */
+    struct BufferStatistics {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
 public:
     XournalView(GtkWidget* parent, Control* control, ScrollHandling* scrollHandling);
     virtual ~XournalView();
@@ -117,6 +134,27 @@ public:
      */
     ScrollHandling* getScrollHandling();
 
+    /**
+     * Called for each painted page, only from the UI thread
+     */
+    void countBufferPaint(bool hit);
+    BufferStatistics const& getBufferStatistics() const;
+
+    /**
+     * Stores the buffer of a completely rendered page, so the sidebar preview
+     * can be scaled down from it. Thread safe.
+     *
+     * @param snapshot nullptr if the page changed
+     */
+    void setPageSnapshot(const XojPage* page, std::shared_ptr<PageBufferSnapshot> snapshot);
+
+    /**
+     * Removes the snapshot of the page, it's only used once. Thread safe.
+     *
+     * @return the snapshot, nullptr if the page is not completely rendered
+     */
+    std::shared_ptr<PageBufferSnapshot> takePageSnapshot(const XojPage* page);
+
 public:
     // ZoomListener interface
     void zoomChanged();
@@ -175,6 +213,16 @@ private:
      */
     int cleanupTimeout = -1;
 
+    BufferStatistics bufferStatistics;
+
+    /**
+     * The statistics at the last memory cleanup, to log the rates since then
+     */
+    BufferStatistics lastBufferStatistics;
+
+    GMutex snapshotMutex{};
+    std::map<const XojPage*, std::shared_ptr<PageBufferSnapshot>> pageSnapshots;
+
     /**
      * Helper class for Touch specific fixes
      */
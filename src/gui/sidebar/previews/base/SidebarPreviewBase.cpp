@@ -1,8 +1,11 @@
 #include "SidebarPreviewBase.h"
 
 #include "control/Control.h"
-#include "control/PdfCache.h"
+#include "control/ThumbnailCache.h"
+#include "gui/MainWindow.h"
+#include "gui/XournalView.h"
 
+#include "PathUtil.h"
 #include "SidebarLayout.h"
 #include "SidebarPreviewBaseEntry.h"
 
@@ -11,7 +14,8 @@ SidebarPreviewBase::SidebarPreviewBase(Control* control, GladeGui* gui, SidebarT
         AbstractSidebarPage(control, toolbar) {
     this->layoutmanager = new SidebarLayout();
 
-    this->cache = new PdfCache(control->getSettings()->getPdfPageCacheSize());
+    auto thumbnailBytes = static_cast<uintmax_t>(control->getSettings()->getThumbnailCacheSizeLimit()) * 1024 * 1024;
+    this->thumbnailCache = new ThumbnailCache(Util::getCacheSubfolder("thumbnails"), thumbnailBytes);
 
     this->iconViewPreview = gtk_layout_new(nullptr, nullptr);
     g_object_ref(this->iconViewPreview);
@@ -41,8 +45,8 @@ SidebarPreviewBase::~SidebarPreviewBase() {
     gtk_widget_destroy(this->iconViewPreview);
     this->iconViewPreview = nullptr;
 
-    delete this->cache;
-    this->cache = nullptr;
+    delete this->thumbnailCache;
+    this->thumbnailCache = nullptr;
 
     delete this->layoutmanager;
     this->layoutmanager = nullptr;
@@ -74,7 +78,9 @@ void SidebarPreviewBase::sizeChanged(GtkWidget* widget, GtkAllocation* allocatio
 
 auto SidebarPreviewBase::getZoom() const -> double { return this->zoom; }
 
-auto SidebarPreviewBase::getCache() -> PdfCache* { return this->cache; }
+auto SidebarPreviewBase::getCache() -> PdfCache* { return this->control->getWindow()->getXournal()->getCache(); }
+
+auto SidebarPreviewBase::getThumbnailCache() -> ThumbnailCache* { return this->thumbnailCache; }
 
 void SidebarPreviewBase::layout() { SidebarLayout::layout(this); }
 
@@ -84,7 +90,7 @@ auto SidebarPreviewBase::getWidget() -> GtkWidget* { return this->scrollPreview;
 
 void SidebarPreviewBase::documentChanged(DocumentChangeType type) {
     if (type == DOCUMENT_CHANGE_COMPLETE || type == DOCUMENT_CHANGE_CLEARED) {
-        this->cache->clearCache();
+        // The PDF cache is cleared by the XournalView
         updatePreviews();
     }
 }
@@ -22,6 +22,7 @@
 #include "XournalType.h"
 
 class PdfCache;
+class ThumbnailCache;
 class SidebarLayout;
 class SidebarPreviewBaseEntry;
 class SidebarToolbar;
@@ -61,10 +62,15 @@ public:
     double getZoom() const;
 
     /**
-     * Gets the PDF cache for preview rendering
+     * Gets the PDF cache for preview rendering, shared with the main view so the memory limit holds for both
      */
     PdfCache* getCache();
 
+    /**
+     * Gets the previews cached on disk
+     */
+    ThumbnailCache* getThumbnailCache();
+
 public:
     // DocumentListener interface (only the part handled by SidebarPreviewBase)
     virtual void documentChanged(DocumentChangeType type);
@@ -94,9 +100,9 @@ private:
     double zoom = 0.15;
 
     /**
-     * For preview rendering
+     * Previews of earlier sessions
      */
-    PdfCache* cache = nullptr;
+    ThumbnailCache* thumbnailCache = nullptr;
 
     /**
      * The layouting class for the prviews
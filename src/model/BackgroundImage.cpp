@@ -32,6 +32,7 @@ struct BackgroundImage::Content {
     GdkPixbuf* pixbuf = nullptr;
     int pageId = -1;
     bool attach = false;
+    ImageMipmap mipmap;
 };
 
 BackgroundImage::BackgroundImage() = default;
@@ -85,4 +86,6 @@ void BackgroundImage::setAttach(bool attach) {
 
 auto BackgroundImage::getPixbuf() -> GdkPixbuf* { return this->img ? this->img->pixbuf : nullptr; }
 
+auto BackgroundImage::getMipmap() -> ImageMipmap* { return this->img ? &this->img->mipmap : nullptr; }
+
 auto BackgroundImage::isEmpty() -> bool { return !this->img; }
@@ -17,6 +17,7 @@
 
 #include <gtk/gtk.h>
 
+#include "ImageMipmap.h"
 #include "XournalType.h"
 #include "filesystem.h"
 
@@ -49,6 +50,11 @@ struct BackgroundImage {
 
     GdkPixbuf* getPixbuf();
 
+    /**
+     * The downscaled versions of the image used for drawing, nullptr if no image is loaded
+     */
+    ImageMipmap* getMipmap();
+
     bool isEmpty();
 
 private:
@@ -5,6 +5,17 @@
 #include "serializing/ObjectInputStream.h"
 #include "serializing/ObjectOutputStream.h"
 
+#include "Layer.h"
+
+auto ShapeContainer::containsAll(const double* xs, const double* ys, size_t count) -> bool {
+    for (size_t i = 0; i < count; i++) {
+        if (!contains(xs[i], ys[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
 Element::Element(ElementType type): type(type) {}
 
 Element::~Element() = default;
@@ -14,11 +25,13 @@ auto Element::getType() const -> ElementType { return this->type; }
 void Element::setX(double x) {
     this->x = x;
     this->sizeCalculated = false;
+    boundsChanged();
 }
 
 void Element::setY(double y) {
     this->y = y;
     this->sizeCalculated = false;
+    boundsChanged();
 }
 
 auto Element::getX() const -> double {
@@ -48,6 +61,13 @@ void Element::move(double dx, double dy) {
     this->x += dx;
     this->y += dy;
     this->snappedBounds = this->snappedBounds.translated(dx, dy);
+    boundsChanged();
+}
+
+void Element::boundsChanged() {
+    if (this->layerLink.layer) {
+        this->layerLink.layer->elementBoundsChanged(this);
+    }
 }
 
 auto Element::getElementWidth() const -> double {
@@ -22,12 +22,19 @@
 #include "Rectangle.h"
 #include "XournalType.h"
 
+class Layer;
+
 enum ElementType { ELEMENT_STROKE = 1, ELEMENT_IMAGE, ELEMENT_TEXIMAGE, ELEMENT_TEXT };
 
 class ShapeContainer {
 public:
     virtual bool contains(double x, double y) = 0;
 
+    /**
+     * @return true if all points are contained, the points are given as separate x and y arrays
+     */
+    virtual bool containsAll(const double* xs, const double* ys, size_t count);
+
     virtual ~ShapeContainer() = default;
 };
 
@@ -76,6 +83,12 @@ private:
 protected:
     virtual void calcSize() const = 0;
 
+    /**
+     * Has to be called whenever the bounding box may have changed,
+     * so the spatial index of the Layer containing this element is updated
+     */
+    void boundsChanged();
+
     void serializeElement(ObjectOutputStream& out) const;
     void readSerializedElement(ObjectInputStream& in);
 
@@ -103,4 +116,18 @@ private:
      * The color in RGB format
      */
     Color color{0U};
+
+    /**
+     * The Layer this element is added to, maintained by the Layer.
+     * A copy of an element is not on any layer, so the pointer is not copied.
+     */
+    struct LayerLink {
+        LayerLink() = default;
+        LayerLink(const LayerLink&) {}
+        LayerLink& operator=(const LayerLink&) { return *this; }
+
+        Layer* layer = nullptr;
+    } layerLink;
+
+    friend class Layer;
 };
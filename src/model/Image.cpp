@@ -35,23 +35,13 @@ auto Image::clone() -> Element* {
 void Image::setWidth(double width) {
     this->width = width;
     this->calcSize();
+    boundsChanged();
 }
 
 void Image::setHeight(double height) {
     this->height = height;
     this->calcSize();
-}
-
-auto Image::cairoReadFunction(Image* image, unsigned char* data, unsigned int length) -> cairo_status_t {
-    for (unsigned int i = 0; i < length; i++, image->read++) {
-        if (image->read >= image->data.length()) {
-            return CAIRO_STATUS_READ_ERROR;
-        }
-
-        data[i] = image->data[image->read];
-    }
-
-    return CAIRO_STATUS_SUCCESS;
+    boundsChanged();
 }
 
 void Image::setImage(string data) {
@@ -60,6 +50,7 @@ void Image::setImage(string data) {
         this->image = nullptr;
     }
     this->data = std::move(data);
+    this->mipmap.invalidate();
 }
 
 void Image::setImage(GdkPixbuf* img) { setImage(f_pixbuf_to_cairo_surface(img)); }
@@ -71,18 +62,45 @@ void Image::setImage(cairo_surface_t* image) {
     }
 
     this->image = image;
+    this->mipmap.invalidate();
 }
 
-auto Image::getImage() -> cairo_surface_t* {
-    if (this->image == nullptr && this->data.length()) {
-        this->read = 0;
-        this->image = cairo_image_surface_create_from_png_stream(
-                reinterpret_cast<cairo_read_func_t>(&cairoReadFunction), this);
+auto Image::getImage() -> cairo_surface_t* { return this->image; }
+
+namespace {
+struct PngReader {
+    string const& data;
+    string::size_type read;
+};
+}  // namespace
+
+static auto readPng(PngReader* reader, unsigned char* data, unsigned int length) -> cairo_status_t {
+    if (reader->data.length() - reader->read < length) {
+        return CAIRO_STATUS_READ_ERROR;
     }
 
-    return this->image;
+    reader->data.copy(reinterpret_cast<char*>(data), length, reader->read);
+    reader->read += length;
+    return CAIRO_STATUS_SUCCESS;
 }
 
+auto Image::loadImage() -> cairo_surface_t* {
+    if (this->image) {
+        return cairo_surface_reference(this->image);
+    }
+    if (this->data.empty()) {
+        return nullptr;
+    }
+
+    // Not kept, drawing uses the levels of the mipmap, which may be freed again
+    PngReader reader{this->data, 0};
+    return cairo_image_surface_create_from_png_stream(reinterpret_cast<cairo_read_func_t>(&readPng), &reader);
+}
+
+auto Image::getPngData() const -> string const& { return this->data; }
+
+auto Image::getMipmap() -> ImageMipmap& { return this->mipmap; }
+
 void Image::scale(double x0, double y0, double fx, double fy, double rotation,
                   bool) {  // line width scaling option is not used
     this->x -= x0;
@@ -95,6 +113,7 @@ void Image::scale(double x0, double y0, double fx, double fy, double rotation,
     this->width *= fx;
     this->height *= fy;
     this->calcSize();
+    boundsChanged();
 }
 
 void Image::rotate(double x0, double y0, double th) {}
@@ -107,7 +126,9 @@ void Image::serialize(ObjectOutputStream& out) {
     out.writeDouble(this->width);
     out.writeDouble(this->height);
 
-    out.writeImage(this->image);
+    cairo_surface_t* img = loadImage();
+    out.writeImage(img);
+    cairo_surface_destroy(img);
 
     out.endObject();
 }
@@ -126,6 +147,7 @@ void Image::readSerialized(ObjectInputStream& in) {
     }
 
     this->image = in.readImage();
+    this->mipmap.invalidate();
 
     in.endObject();
     this->calcSize();
@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "Element.h"
+#include "ImageMipmap.h"
 #include "XournalType.h"
 
 class Image: public Element {
@@ -29,8 +30,27 @@ public:
     void setImage(string data);
     void setImage(cairo_surface_t* image);
     void setImage(GdkPixbuf* img);
+    /**
+     * @return the image if it's kept decoded, nullptr if it's only available as PNG data, see loadImage()
+     */
     cairo_surface_t* getImage();
 
+    /**
+     * @return a new reference to the decoded image. If it's only available as PNG data,
+     *         the data is decoded without keeping the result.
+     */
+    cairo_surface_t* loadImage();
+
+    /**
+     * @return the PNG data, empty if the image was not loaded from PNG data
+     */
+    string const& getPngData() const;
+
+    /**
+     * The downscaled versions of the image used for drawing
+     */
+    ImageMipmap& getMipmap();
+
     virtual void scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth);
     virtual void rotate(double x0, double y0, double th);
 
@@ -47,12 +67,10 @@ public:
 private:
     void calcSize() const override;
 
-    static cairo_status_t cairoReadFunction(Image* image, unsigned char* data, unsigned int length);
-
 private:
     cairo_surface_t* image = nullptr;
 
     string data;
 
-    string::size_type read = false;
+    ImageMipmap mipmap;
 };
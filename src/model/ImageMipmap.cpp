@@ -0,0 +1,286 @@
+#include "ImageMipmap.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * The levels are halved at most this often
+ */
+constexpr int MAX_LEVEL = 16;
+
+// Statically allocated, doesn't need to be initialized
+GMutex ImageMipmap::budgetMutex{};
+std::list<ImageMipmap*> ImageMipmap::usage;
+int64_t ImageMipmap::usedBytes = 0;
+int64_t ImageMipmap::maxBytes = static_cast<int64_t>(256) * 1024 * 1024;
+
+/**
+ * The size of a level, rounded up so no pixel row or column is lost
+ */
+static auto levelSize(int size, int level) -> int { return std::max(1, (size + (1 << level) - 1) >> level); }
+
+static auto surfaceBytes(cairo_surface_t* surface) -> int64_t {
+    return static_cast<int64_t>(cairo_image_surface_get_stride(surface)) * cairo_image_surface_get_height(surface);
+}
+
+/**
+ * @return a new surface with src scaled to width x height
+ */
+static auto downscale(cairo_surface_t* src, int width, int height) -> cairo_surface_t* {
+    cairo_surface_t* dst = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_t* cr = cairo_create(dst);
+
+    cairo_scale(cr, static_cast<double>(width) / cairo_image_surface_get_width(src),
+                static_cast<double>(height) / cairo_image_surface_get_height(src));
+    cairo_set_source_surface(cr, src, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+    cairo_paint(cr);
+
+    cairo_destroy(cr);
+    return dst;
+}
+
+ImageMipmap::ImageMipmap() { g_mutex_init(&this->levelMutex); }
+
+ImageMipmap::~ImageMipmap() {
+    invalidate();
+    g_mutex_clear(&this->levelMutex);
+}
+
+ImageMipmap::ImageMipmap(const ImageMipmap&): ImageMipmap() {}
+
+auto ImageMipmap::operator=(const ImageMipmap&) -> ImageMipmap& {
+    invalidate();
+    return *this;
+}
+
+void ImageMipmap::setMemoryLimit(size_t bytes) {
+    g_mutex_lock(&budgetMutex);
+    maxBytes = static_cast<int64_t>(bytes);
+    g_mutex_unlock(&budgetMutex);
+}
+
+void ImageMipmap::invalidate() {
+    g_mutex_lock(&budgetMutex);
+
+    g_mutex_lock(&this->levelMutex);
+    clear();
+    this->sourceWidth = 0;
+    this->sourceHeight = 0;
+    g_mutex_unlock(&this->levelMutex);
+
+    usedBytes -= this->bytes;
+    this->bytes = 0;
+    if (this->used) {
+        usage.erase(this->usePosition);
+        this->used = false;
+    }
+
+    g_mutex_unlock(&budgetMutex);
+}
+
+void ImageMipmap::clear() {
+    for (cairo_surface_t* level: this->levels) {
+        if (level) {
+            cairo_surface_destroy(level);
+        }
+    }
+    this->levels.clear();
+    this->levelBytes = 0;
+}
+
+void ImageMipmap::setLevel(int level, cairo_surface_t* surface) {
+    if (static_cast<int>(this->levels.size()) <= level) {
+        this->levels.resize(level + 1, nullptr);
+    }
+
+    cairo_surface_t*& entry = this->levels[level];
+    if (entry) {
+        this->levelBytes -= surfaceBytes(entry);
+        cairo_surface_destroy(entry);
+    }
+
+    entry = surface;
+    if (entry) {
+        this->levelBytes += surfaceBytes(entry);
+    }
+}
+
+auto ImageMipmap::getSource(cairo_surface_t* decoded, Loader const& load) -> cairo_surface_t* {
+    if (decoded) {
+        return cairo_surface_reference(decoded);
+    }
+    if (!this->levels.empty() && this->levels[0]) {
+        return cairo_surface_reference(this->levels[0]);
+    }
+
+    cairo_surface_t* img = load ? load() : nullptr;
+    if (img == nullptr) {
+        return nullptr;
+    }
+    if (cairo_surface_status(img) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(img);
+        return nullptr;
+    }
+
+    this->sourceWidth = cairo_image_surface_get_width(img);
+    this->sourceHeight = cairo_image_surface_get_height(img);
+    setLevel(0, img);
+    return cairo_surface_reference(img);
+}
+
+auto ImageMipmap::getLevel(double deviceWidth, double deviceHeight, bool scaled, bool create, cairo_surface_t* decoded,
+                           Loader const& load) -> cairo_surface_t* {
+    if (decoded) {
+        this->sourceWidth = cairo_image_surface_get_width(decoded);
+        this->sourceHeight = cairo_image_surface_get_height(decoded);
+    } else if (this->sourceWidth == 0) {
+        // The size is only known after decoding
+        if (!create) {
+            return nullptr;
+        }
+        cairo_surface_t* source = getSource(nullptr, load);
+        if (source == nullptr) {
+            return nullptr;
+        }
+        cairo_surface_destroy(source);
+    }
+
+    // The smallest level which has at least one pixel per device pixel
+    int wanted = 0;
+    while (scaled && wanted < MAX_LEVEL && levelSize(this->sourceWidth, wanted + 1) >= deviceWidth &&
+           levelSize(this->sourceHeight, wanted + 1) >= deviceHeight &&
+           (levelSize(this->sourceWidth, wanted) > 1 || levelSize(this->sourceHeight, wanted) > 1)) {
+        wanted++;
+    }
+
+    auto available = [this](int level) {
+        return level < static_cast<int>(this->levels.size()) && this->levels[level] != nullptr;
+    };
+
+    if (available(wanted)) {
+        return cairo_surface_reference(this->levels[wanted]);
+    }
+
+    if (!create) {
+        // Use the nearest level which is already there, a finer one if possible
+        for (int level = wanted - 1; level > 0; level--) {
+            if (available(level)) {
+                return cairo_surface_reference(this->levels[level]);
+            }
+        }
+        if (decoded || available(0)) {
+            return getSource(decoded, load);
+        }
+        for (int level = wanted + 1; level < static_cast<int>(this->levels.size()); level++) {
+            if (available(level)) {
+                return cairo_surface_reference(this->levels[level]);
+            }
+        }
+
+        // Nothing is decoded here, the image is drawn again by the render job
+        return nullptr;
+    }
+
+    if (wanted == 0) {
+        return getSource(decoded, load);
+    }
+
+    // Halve the nearest finer level until the wanted size is reached
+    int from = wanted - 1;
+    while (from > 0 && !available(from)) {
+        from--;
+    }
+
+    bool sourceLoaded = from == 0 && decoded == nullptr && !available(0);
+    cairo_surface_t* current = from == 0 ? getSource(decoded, load) : cairo_surface_reference(this->levels[from]);
+    if (current == nullptr) {
+        return nullptr;
+    }
+
+    for (int level = from + 1; level <= wanted; level++) {
+        cairo_surface_t* next =
+                downscale(current, levelSize(this->sourceWidth, level), levelSize(this->sourceHeight, level));
+        cairo_surface_destroy(current);
+        current = next;
+    }
+
+    // Only the drawn level is kept
+    setLevel(wanted, cairo_surface_reference(current));
+    if (sourceLoaded) {
+        setLevel(0, nullptr);
+    }
+
+    return current;
+}
+
+void ImageMipmap::account() {
+    g_mutex_lock(&budgetMutex);
+
+    g_mutex_lock(&this->levelMutex);
+    int64_t current = this->levelBytes;
+    g_mutex_unlock(&this->levelMutex);
+
+    usedBytes += current - this->bytes;
+    this->bytes = current;
+
+    if (this->used) {
+        usage.erase(this->usePosition);
+        this->used = false;
+    }
+    if (this->bytes > 0) {
+        usage.push_front(this);
+        this->usePosition = usage.begin();
+        this->used = true;
+    }
+
+    // The most recently used image is always kept
+    while (usedBytes > maxBytes && usage.size() > 1) {
+        ImageMipmap* victim = usage.back();
+        usage.pop_back();
+        victim->used = false;
+
+        g_mutex_lock(&victim->levelMutex);
+        victim->clear();
+        g_mutex_unlock(&victim->levelMutex);
+
+        usedBytes -= victim->bytes;
+        victim->bytes = 0;
+    }
+
+    g_mutex_unlock(&budgetMutex);
+}
+
+void ImageMipmap::paint(cairo_t* cr, double x, double y, double width, double height, cairo_surface_t* decoded,
+                        Loader const& load) {
+    // Export and printing get the full resolution
+    bool scaled = cairo_surface_get_type(cairo_get_target(cr)) == CAIRO_SURFACE_TYPE_IMAGE;
+    bool create = !scaled || !g_main_context_is_owner(g_main_context_default());
+
+    double widthX = width;
+    double widthY = 0;
+    double heightX = 0;
+    double heightY = height;
+    cairo_user_to_device_distance(cr, &widthX, &widthY);
+    cairo_user_to_device_distance(cr, &heightX, &heightY);
+
+    g_mutex_lock(&this->levelMutex);
+    cairo_surface_t* img =
+            getLevel(std::hypot(widthX, widthY), std::hypot(heightX, heightY), scaled, create, decoded, load);
+    g_mutex_unlock(&this->levelMutex);
+
+    if (img == nullptr) {
+        return;
+    }
+
+    account();
+
+    cairo_save(cr);
+    cairo_translate(cr, x, y);
+    cairo_scale(cr, width / cairo_image_surface_get_width(img), height / cairo_image_surface_get_height(img));
+    cairo_set_source_surface(cr, img, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    cairo_surface_destroy(img);
+}
@@ -0,0 +1,135 @@
+/*
+ * Xournal++
+ *
+ * Downscaled versions of an image, so it's not resampled
+ * from full resolution when drawn small
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <vector>
+
+#include <cairo/cairo.h>
+#include <glib.h>
+
+/**
+ * Level 0 is the decoded image, each further level has half the size of the previous one.
+ * The levels are created on first use, and freed again if all images together exceed the memory limit.
+ * An image the element keeps decoded is used as level 0 without being stored or counted, it can't be freed.
+ */
+class ImageMipmap {
+public:
+    /**
+     * Returns a new surface with the image decoded in full resolution, or nullptr if it can't be loaded
+     */
+    using Loader = std::function<cairo_surface_t*()>;
+
+public:
+    ImageMipmap();
+    ~ImageMipmap();
+
+    /**
+     * The levels belong to one image, a copy of the image starts without levels
+     */
+    ImageMipmap(const ImageMipmap&);
+    ImageMipmap& operator=(const ImageMipmap&);
+
+public:
+    /**
+     * Frees all levels, has to be called if the image changes
+     */
+    void invalidate();
+
+    /**
+     * Paints the image scaled to the rectangle x, y, width, height of cr, using the
+     * smallest level which is at least as big as the rectangle on the device.
+     *
+     * The levels are only created outside of the main thread. The main thread uses the best level
+     * already available instead, and draws nothing if there is none: it never decodes the image.
+     *
+     * @param decoded The image in full resolution if the element keeps it decoded, else nullptr
+     * @param load Called to decode the image if decoded is nullptr and level 0 is needed, may be empty
+     */
+    void paint(cairo_t* cr, double x, double y, double width, double height, cairo_surface_t* decoded,
+               Loader const& load);
+
+    /**
+     * The memory all images together may use
+     */
+    static void setMemoryLimit(size_t bytes);
+
+private:
+    /**
+     * @return the level to draw, with a new reference, only called with levelMutex held
+     */
+    cairo_surface_t* getLevel(double deviceWidth, double deviceHeight, bool scaled, bool create,
+                              cairo_surface_t* decoded, Loader const& load);
+
+    /**
+     * @return the decoded image with a new reference, only called with levelMutex held.
+     *         If it has to be decoded, it's kept as level 0.
+     */
+    cairo_surface_t* getSource(cairo_surface_t* decoded, Loader const& load);
+
+    void setLevel(int level, cairo_surface_t* surface);
+
+    /**
+     * Frees all levels, only called with levelMutex held
+     */
+    void clear();
+
+    /**
+     * Marks this image as recently used and frees the least recently used images over the limit
+     */
+    void account();
+
+private:
+    /**
+     * Protects the levels and their size
+     */
+    GMutex levelMutex{};
+
+    /**
+     * nullptr for the levels which are not created or were freed
+     */
+    std::vector<cairo_surface_t*> levels;
+
+    /**
+     * The size of level 0, known after it was decoded once
+     */
+    int sourceWidth = 0;
+    int sourceHeight = 0;
+
+    /**
+     * The memory of all levels, without the decoded image of the element
+     */
+    int64_t levelBytes = 0;
+
+    /**
+     * The memory of the levels as accounted in the budget, guarded by budgetMutex
+     */
+    int64_t bytes = 0;
+
+    /**
+     * The position in the usage list, guarded by budgetMutex
+     */
+    bool used = false;
+    std::list<ImageMipmap*>::iterator usePosition;
+
+    static GMutex budgetMutex;
+
+    /**
+     * The images having levels, the most recently used at the front
+     */
+    static std::list<ImageMipmap*> usage;
+    static int64_t usedBytes;
+    static int64_t maxBytes;
+};
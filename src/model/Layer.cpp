@@ -1,8 +1,15 @@
 #include "Layer.h"
 
+#include <atomic>
+
 #include "Stacktrace.h"
 
-Layer::Layer() = default;
+/**
+ * Layers are created and modified by several threads, e.g. while loading a document
+ */
+static std::atomic<uint64_t> nextVersion{1};
+
+Layer::Layer(): version(nextVersion++) {}
 
 Layer::~Layer() {
     for (Element* e: this->elements) {
@@ -36,6 +43,9 @@ void Layer::addElement(Element* e) {
     }
 
     this->elements.push_back(e);
+    e->layerLink.layer = this;
+    this->index.insert(e, this->elements.size() - 1);
+    markModified();
 }
 
 void Layer::insertElement(Element* e, ElementIndex pos) {
@@ -61,10 +71,15 @@ void Layer::insertElement(Element* e, ElementIndex pos) {
 
     // If the element should be inserted at the top
     if (pos >= static_cast<int>(this->elements.size())) {
+        pos = this->elements.size();
         this->elements.push_back(e);
     } else {
         this->elements.insert(this->elements.begin() + pos, e);
     }
+
+    e->layerLink.layer = this;
+    this->index.insert(e, pos);
+    markModified();
 }
 
 auto Layer::indexOf(Element* e) -> ElementIndex {
@@ -81,6 +96,11 @@ auto Layer::removeElement(Element* e, bool free) -> ElementIndex {
     for (unsigned int i = 0; i < this->elements.size(); i++) {
         if (e == this->elements[i]) {
             this->elements.erase(this->elements.begin() + i);
+            this->index.remove(e);
+            markModified();
+            if (e->layerLink.layer == this) {
+                e->layerLink.layer = nullptr;
+            }
 
             if (free) {
                 delete e;
@@ -104,6 +124,22 @@ auto Layer::isVisible() const -> bool { return visible; }
 /**
  * @return true if the layer is visible
  */
-void Layer::setVisible(bool visible) { this->visible = visible; }
+void Layer::setVisible(bool visible) {
+    this->visible = visible;
+    markModified();
+}
 
 auto Layer::getElements() -> vector<Element*>* { return &this->elements; }
+
+auto Layer::getElementsInArea(double x, double y, double width, double height) -> vector<Element*> {
+    return this->index.query(x, y, width, height);
+}
+
+void Layer::elementBoundsChanged(Element* e) {
+    this->index.invalidate(e);
+    markModified();
+}
+
+auto Layer::getVersion() const -> uint64_t { return this->version; }
+
+void Layer::markModified() { this->version = nextVersion++; }
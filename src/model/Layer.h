@@ -11,10 +11,12 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "Element.h"
+#include "SpatialIndex.h"
 #include "XournalType.h"
 
 
@@ -56,6 +58,18 @@ public:
      */
     vector<Element*>* getElements();
 
+    /**
+     * Returns the Element%s whose bounding box may intersect the given area, in drawing order
+     *
+     * @note The result can contain more elements, callers still have to check the exact intersection
+     */
+    vector<Element*> getElementsInArea(double x, double y, double width, double height);
+
+    /**
+     * Called by an Element of this Layer if its bounding box may have changed
+     */
+    void elementBoundsChanged(Element* e);
+
     /**
      * Returns whether or not the Layer is empty
      */
@@ -76,8 +90,26 @@ public:
      */
     Layer* clone();
 
+    /**
+     * Returns a number which changes whenever the content or the visibility of the Layer changes,
+     * unique among all Layer%s
+     */
+    uint64_t getVersion() const;
+
+    /**
+     * Changes the version, has to be called if an Element of this Layer is modified in place
+     */
+    void markModified();
+
 private:
     vector<Element*> elements;
 
+    /**
+     * Spatial index over the elements, has to be declared after the element list
+     */
+    SpatialIndex index{elements};
+
     bool visible = true;
+
+    uint64_t version;
 };
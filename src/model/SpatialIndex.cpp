@@ -0,0 +1,247 @@
+#include "SpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Element.h"
+
+/**
+ * Edge length of a grid cell, in document coordinates
+ */
+constexpr double CELL_SIZE = 64;
+
+/**
+ * Elements covering more cells are not put into the grid, but are always reported
+ */
+constexpr int64_t MAX_CELLS_PER_ELEMENT = 256;
+
+/**
+ * Limit cell coordinates, so that elements far outside of the page don't overflow the cell key
+ */
+constexpr int MAX_CELL_COORD = 1 << 20;
+
+/**
+ * Margin added around the query area, in document coordinates
+ */
+constexpr double QUERY_MARGIN = 1;
+
+/**
+ * Gap between the order keys of two neighbouring elements after renumbering
+ */
+constexpr uint64_t ORDER_STEP = uint64_t(1) << 20;
+
+SpatialIndex::SpatialIndex(const std::vector<Element*>& elements): elements(elements) {
+    g_mutex_init(&this->indexLock);
+}
+
+SpatialIndex::~SpatialIndex() { g_mutex_clear(&this->indexLock); }
+
+auto SpatialIndex::cellKey(int cx, int cy) -> int64_t {
+    return (static_cast<int64_t>(cx) << 32) | static_cast<uint32_t>(cy);
+}
+
+auto SpatialIndex::toCell(double v) -> int {
+    double c = std::floor(v / CELL_SIZE);
+    if (c < -MAX_CELL_COORD) {
+        return -MAX_CELL_COORD;
+    }
+    if (c > MAX_CELL_COORD) {
+        return MAX_CELL_COORD;
+    }
+    return static_cast<int>(c);
+}
+
+void SpatialIndex::insert(Element* e, std::ptrdiff_t pos) {
+    g_mutex_lock(&this->indexLock);
+
+    Entry& entry = this->entries[e];
+
+    uint64_t prev = 0;
+    if (pos > 0) {
+        prev = this->entries[this->elements[pos - 1]].order;
+    }
+
+    if (pos + 1 < static_cast<std::ptrdiff_t>(this->elements.size())) {
+        uint64_t next = this->entries[this->elements[pos + 1]].order;
+        if (next > prev + 1) {
+            entry.order = prev + (next - prev) / 2;
+        } else {
+            renumber();
+        }
+    } else {
+        entry.order = prev + ORDER_STEP;
+    }
+
+    // The bounds are calculated on the next query, the element may not be complete yet
+    entry.dirty = true;
+    this->dirty.push_back(e);
+
+    g_mutex_unlock(&this->indexLock);
+}
+
+void SpatialIndex::remove(Element* e) {
+    g_mutex_lock(&this->indexLock);
+
+    auto it = this->entries.find(e);
+    if (it != this->entries.end()) {
+        if (it->second.indexed) {
+            removeFromCells(e, it->second);
+        }
+        if (it->second.dirty) {
+            this->dirty.erase(std::remove(this->dirty.begin(), this->dirty.end(), e), this->dirty.end());
+        }
+        this->entries.erase(it);
+    }
+
+    g_mutex_unlock(&this->indexLock);
+}
+
+void SpatialIndex::invalidate(Element* e) {
+    g_mutex_lock(&this->indexLock);
+
+    auto it = this->entries.find(e);
+    if (it != this->entries.end() && !it->second.dirty) {
+        it->second.dirty = true;
+        this->dirty.push_back(e);
+    }
+
+    g_mutex_unlock(&this->indexLock);
+}
+
+auto SpatialIndex::query(double x, double y, double width, double height) -> std::vector<Element*> {
+    g_mutex_lock(&this->indexLock);
+
+    flushDirty();
+
+    // Callers often round their areas to integer rectangles, so search with a small margin
+    int cx1 = toCell(std::min(x, x + width) - QUERY_MARGIN);
+    int cy1 = toCell(std::min(y, y + height) - QUERY_MARGIN);
+    int cx2 = toCell(std::max(x, x + width) + QUERY_MARGIN);
+    int cy2 = toCell(std::max(y, y + height) + QUERY_MARGIN);
+
+    std::vector<Element*> result;
+
+    // Visiting the cells would be more expensive than just returning everything
+    int64_t cellCount = (int64_t(cx2) - cx1 + 1) * (int64_t(cy2) - cy1 + 1);
+    if (cellCount >= static_cast<int64_t>(this->entries.size())) {
+        result = this->elements;
+        g_mutex_unlock(&this->indexLock);
+        return result;
+    }
+
+    if (++this->queryCounter == 0) {
+        for (auto& entry: this->entries) {
+            entry.second.queryMark = 0;
+        }
+        this->queryCounter = 1;
+    }
+
+    auto collect = [&](Element* e) {
+        Entry& entry = this->entries[e];
+        if (entry.queryMark != this->queryCounter) {
+            entry.queryMark = this->queryCounter;
+            result.push_back(e);
+        }
+    };
+
+    for (int cx = cx1; cx <= cx2; cx++) {
+        for (int cy = cy1; cy <= cy2; cy++) {
+            auto it = this->cells.find(cellKey(cx, cy));
+            if (it == this->cells.end()) {
+                continue;
+            }
+            for (Element* e: it->second) {
+                collect(e);
+            }
+        }
+    }
+    for (Element* e: this->oversized) {
+        collect(e);
+    }
+
+    std::sort(result.begin(), result.end(),
+              [this](Element* a, Element* b) { return this->entries[a].order < this->entries[b].order; });
+
+    g_mutex_unlock(&this->indexLock);
+    return result;
+}
+
+void SpatialIndex::flushDirty() {
+    for (Element* e: this->dirty) {
+        Entry& entry = this->entries[e];
+        if (entry.indexed) {
+            removeFromCells(e, entry);
+        }
+        addToCells(e, entry);
+        entry.dirty = false;
+    }
+    this->dirty.clear();
+}
+
+void SpatialIndex::addToCells(Element* e, Entry& entry) {
+    double x = e->getX();
+    double y = e->getY();
+    double w = e->getElementWidth();
+    double h = e->getElementHeight();
+
+    entry.indexed = true;
+
+    if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(w) || !std::isfinite(h)) {
+        entry.oversized = true;
+        this->oversized.push_back(e);
+        return;
+    }
+
+    entry.cx1 = toCell(x);
+    entry.cy1 = toCell(y);
+    entry.cx2 = toCell(x + w);
+    entry.cy2 = toCell(y + h);
+
+    int64_t cellCount = (int64_t(entry.cx2) - entry.cx1 + 1) * (int64_t(entry.cy2) - entry.cy1 + 1);
+    if (cellCount > MAX_CELLS_PER_ELEMENT) {
+        entry.oversized = true;
+        this->oversized.push_back(e);
+        return;
+    }
+
+    entry.oversized = false;
+    for (int cx = entry.cx1; cx <= entry.cx2; cx++) {
+        for (int cy = entry.cy1; cy <= entry.cy2; cy++) {
+            this->cells[cellKey(cx, cy)].push_back(e);
+        }
+    }
+}
+
+void SpatialIndex::removeFromCells(Element* e, Entry& entry) {
+    entry.indexed = false;
+
+    if (entry.oversized) {
+        this->oversized.erase(std::remove(this->oversized.begin(), this->oversized.end(), e), this->oversized.end());
+        return;
+    }
+
+    for (int cx = entry.cx1; cx <= entry.cx2; cx++) {
+        for (int cy = entry.cy1; cy <= entry.cy2; cy++) {
+            auto it = this->cells.find(cellKey(cx, cy));
+            if (it == this->cells.end()) {
+                continue;
+            }
+            std::vector<Element*>& cell = it->second;
+            cell.erase(std::remove(cell.begin(), cell.end(), e), cell.end());
+            if (cell.empty()) {
+                this->cells.erase(it);
+            }
+        }
+    }
+}
+
+/**
+ * Reassign the order keys from the element list, called if there is no gap left to insert an element
+ */
+void SpatialIndex::renumber() {
+    uint64_t order = 0;
+    for (Element* e: this->elements) {
+        order += ORDER_STEP;
+        this->entries[e].order = order;
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * Xournal++
+ *
+ * A uniform grid over the Element%s of a Layer, used to find the
+ * elements within an area without walking the whole layer
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glib.h>
+
+class Element;
+
+class SpatialIndex {
+public:
+    /**
+     * @param elements The element list of the owning layer, used to keep the drawing order
+     */
+    explicit SpatialIndex(const std::vector<Element*>& elements);
+    virtual ~SpatialIndex();
+
+    SpatialIndex(const SpatialIndex&) = delete;
+    SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+public:
+    /**
+     * Adds an element, which has to be already inserted into the element list at position pos
+     */
+    void insert(Element* e, std::ptrdiff_t pos);
+
+    /**
+     * Removes an element from the index
+     */
+    void remove(Element* e);
+
+    /**
+     * The bounding box of the element has changed, the element is reindexed on the next query
+     */
+    void invalidate(Element* e);
+
+    /**
+     * Returns all elements whose bounding box may intersect the given area, in drawing order.
+     * The result is a superset, callers still have to do their own exact intersection test.
+     */
+    std::vector<Element*> query(double x, double y, double width, double height);
+
+private:
+    struct Entry {
+        // Indexed cell range, inclusive
+        int cx1 = 0;
+        int cy1 = 0;
+        int cx2 = 0;
+        int cy2 = 0;
+
+        // The element is too large to be put into the grid cells
+        bool oversized = false;
+
+        // The element is registered in the cells / oversized list
+        bool indexed = false;
+
+        // The bounding box is outdated and needs to be reindexed
+        bool dirty = true;
+
+        // Key for the drawing order, ascending like the element list
+        uint64_t order = 0;
+
+        // Last query this element was reported in, to report each element only once
+        uint32_t queryMark = 0;
+    };
+
+    void addToCells(Element* e, Entry& entry);
+    void removeFromCells(Element* e, Entry& entry);
+    void flushDirty();
+    void renumber();
+
+    static int64_t cellKey(int cx, int cy);
+    static int toCell(double v);
+
+private:
+    GMutex indexLock{};
+
+    const std::vector<Element*>& elements;
+
+    std::unordered_map<Element*, Entry> entries;
+    std::unordered_map<int64_t, std::vector<Element*>> cells;
+    std::vector<Element*> oversized;
+    std::vector<Element*> dirty;
+
+    uint32_t queryCounter = 0;
+};
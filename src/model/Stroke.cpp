@@ -1,11 +1,12 @@
 #include "Stroke.h"
 
 #include <cmath>
-#include <numeric>
+#include <algorithm>
 
 #include "serializing/ObjectInputStream.h"
 #include "serializing/ObjectOutputStream.h"
 
+#include "HitTest.h"
 #include "i18n.h"
 
 Stroke::Stroke(): AudioElement(ELEMENT_STROKE) {}
@@ -29,6 +30,8 @@ auto Stroke::cloneStroke() const -> Stroke* {
     auto* s = new Stroke();
     s->applyStyleFrom(this);
     s->points = this->points;
+    // The same points, so the copy draws with the cache of this stroke until one of them is changed
+    s->renderCache = this->renderCache;
     return s;
 }
 
@@ -45,7 +48,9 @@ void Stroke::serialize(ObjectOutputStream& out) {
 
     out.writeInt(fill);
 
-    out.writeData(this->points.data(), this->points.size(), sizeof(Point));
+    // Not the array of getPointVector(), it would be kept in the render cache of every serialized stroke
+    std::vector<Point> pointVector = this->points.toVector();
+    out.writeData(pointVector.data(), pointVector.size(), sizeof(Point));
 
     this->lineStyle.serialize(out);
 
@@ -66,8 +71,9 @@ void Stroke::readSerialized(ObjectInputStream& in) {
     Point* p{};
     int count{};
     in.readData(reinterpret_cast<void**>(&p), &count);
-    this->points = std::vector<Point>{p, p + count};
+    this->points.assign(p, count);
     g_free(p);
+    pointsChanged();
     this->lineStyle.readSerialized(in);
 
     in.endObject();
@@ -91,29 +97,38 @@ auto Stroke::getFill() const -> int { return fill; }
  */
 void Stroke::setFill(int fill) { this->fill = fill; }
 
-void Stroke::setWidth(double width) { this->width = width; }
+void Stroke::setWidth(double width) {
+    this->width = width;
+    pointsChanged();
+}
 
-auto Stroke::getWidth() const -> double { return this->width; }
+void Stroke::resetRenderCache() {
+    if (this->renderCache.use_count() > 1) {
+        // A copy still draws the old points with it
+        this->renderCache = std::make_shared<StrokeRenderCache>();
+    } else {
+        this->renderCache->invalidate();
+    }
+}
 
-auto Stroke::isInSelection(ShapeContainer* container) -> bool {
-    for (auto&& p: this->points) {
-        double px = p.x;
-        double py = p.y;
+void Stroke::pointsChanged() {
+    this->sizeCalculated = false;
+    resetRenderCache();
+    this->chunkBounds.invalidate();
+    boundsChanged();
+}
 
-        if (!container->contains(px, py)) {
-            return false;
-        }
-    }
+auto Stroke::getWidth() const -> double { return this->width; }
 
-    return true;
+auto Stroke::isInSelection(ShapeContainer* container) -> bool {
+    return container->containsAll(this->points.xData(), this->points.yData(), this->points.size());
 }
 
 void Stroke::setFirstPoint(double x, double y) {
     if (!this->points.empty()) {
-        Point& p = this->points.front();
-        p.x = x;
-        p.y = y;
-        this->sizeCalculated = false;
+        this->points.editXData()[0] = x;
+        this->points.editYData()[0] = y;
+        pointsChanged();
     }
 }
 
@@ -121,35 +136,49 @@ void Stroke::setLastPoint(double x, double y) { setLastPoint({x, y}); }
 
 void Stroke::setLastPoint(const Point& p) {
     if (!this->points.empty()) {
-        this->points.back() = p;
-        this->sizeCalculated = false;
+        this->points.set(this->points.size() - 1, p);
+        pointsChanged();
     }
 }
 
 void Stroke::addPoint(const Point& p) {
-    this->points.emplace_back(p);
-    this->sizeCalculated = false;
+    this->points.push_back(p);
+    pointsChanged();
 }
 
 auto Stroke::getPointCount() const -> int { return this->points.size(); }
 
-auto Stroke::getPointVector() const -> std::vector<Point> const& { return points; }
+auto Stroke::getPointVector() const -> std::vector<Point> const& {
+    return *this->renderCache->getPointVector(this->points);
+}
+
+auto Stroke::getPointStorage() const -> StrokePoints const& { return this->points; }
 
-void Stroke::deletePointsFrom(int index) { points.resize(std::min(size_t(index), points.size())); }
+void Stroke::deletePointsFrom(int index) {
+    points.truncate(std::max(index, 0));
+    pointsChanged();
+}
 
-void Stroke::deletePoint(int index) { this->points.erase(std::next(begin(this->points), index)); }
+void Stroke::deletePoint(int index) {
+    this->points.erase(index);
+    pointsChanged();
+}
 
 auto Stroke::getPoint(int index) const -> Point {
     if (index < 0 || index >= this->points.size()) {
         g_warning("Stroke::getPoint(%i) out of bounds!", index);
         return Point(0, 0, Point::NO_PRESSURE);
     }
-    return points.at(index);
+    return this->points.get(index);
 }
 
-auto Stroke::getPoints() const -> const Point* { return this->points.data(); }
+auto Stroke::getPoints() const -> const Point* { return getPointVector().data(); }
 
-void Stroke::freeUnusedPointItems() { this->points = {begin(this->points), end(this->points)}; }
+void Stroke::freeUnusedPointItems() {
+    this->points.shrinkToFit();
+    // Also the array created by getPointVector()
+    resetRenderCache();
+}
 
 void Stroke::setToolType(StrokeTool type) { this->toolType = type; }
 
@@ -160,12 +189,14 @@ void Stroke::setLineStyle(const LineStyle& style) { this->lineStyle = style; }
 auto Stroke::getLineStyle() const -> const LineStyle& { return this->lineStyle; }
 
 void Stroke::move(double dx, double dy) {
-    for (auto&& point: points) {
-        point.x += dx;
-        point.y += dy;
+    double* xs = this->points.editXData();
+    double* ys = this->points.editYData();
+    for (size_t i = 0; i < this->points.size(); i++) {
+        xs[i] += dx;
+        ys[i] += dy;
     }
 
-    this->sizeCalculated = false;
+    pointsChanged();
 }
 
 void Stroke::rotate(double x0, double y0, double th) {
@@ -175,11 +206,13 @@ void Stroke::rotate(double x0, double y0, double th) {
     cairo_matrix_rotate(&rotMatrix, th);
     cairo_matrix_translate(&rotMatrix, -x0, -y0);
 
-    for (auto&& p: points) {
-        cairo_matrix_transform_point(&rotMatrix, &p.x, &p.y);
+    double* xs = this->points.editXData();
+    double* ys = this->points.editYData();
+    for (size_t i = 0; i < this->points.size(); i++) {
+        cairo_matrix_transform_point(&rotMatrix, &xs[i], &ys[i]);
     }
     // Width and Height will likely be changed after this operation
-    calcSize();
+    pointsChanged();
 }
 
 void Stroke::scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth) {
@@ -192,49 +225,55 @@ void Stroke::scale(double x0, double y0, double fx, double fy, double rotation,
     cairo_matrix_rotate(&scaleMatrix, -rotation);
     cairo_matrix_translate(&scaleMatrix, -x0, -y0);
 
-    for (auto&& p: points) {
-        cairo_matrix_transform_point(&scaleMatrix, &p.x, &p.y);
+    double* xs = this->points.editXData();
+    double* ys = this->points.editYData();
+    for (size_t i = 0; i < this->points.size(); i++) {
+        cairo_matrix_transform_point(&scaleMatrix, &xs[i], &ys[i]);
 
-        if (p.z != Point::NO_PRESSURE) {
-            p.z *= fz;
+        double z = this->points.z(i);
+        if (z != Point::NO_PRESSURE) {
+            this->points.setPressure(i, z * fz);
         }
     }
     this->width *= fz;
 
-    this->sizeCalculated = false;
+    pointsChanged();
 }
 
 auto Stroke::hasPressure() const -> bool {
     if (!this->points.empty()) {
-        return this->points[0].z != Point::NO_PRESSURE;
+        return this->points.z(0) != Point::NO_PRESSURE;
     }
     return false;
 }
 
 auto Stroke::getAvgPressure() const -> double {
-    return std::accumulate(begin(this->points), end(this->points), 0.0,
-                           [](double l, Point const& p) { return l + p.z; }) /
-           this->points.size();
+    double sum = 0;
+    for (size_t i = 0; i < this->points.size(); i++) {
+        sum += this->points.z(i);
+    }
+    return sum / this->points.size();
 }
 
 void Stroke::scalePressure(double factor) {
     if (!hasPressure()) {
         return;
     }
-    for (auto&& p: this->points) {
-        p.z *= factor;
+    for (size_t i = 0; i < this->points.size(); i++) {
+        this->points.setPressure(i, this->points.z(i) * factor);
     }
+    pointsChanged();
 }
 
 void Stroke::clearPressure() {
-    for (auto&& p: points) {
-        p.z = Point::NO_PRESSURE;
-    }
+    this->points.clearPressure();
+    pointsChanged();
 }
 
 void Stroke::setLastPressure(double pressure) {
     if (!this->points.empty()) {
-        this->points.back().z = pressure;
+        this->points.setPressure(this->points.size() - 1, pressure);
+        pointsChanged();
     }
 }
 
@@ -247,8 +286,9 @@ void Stroke::setPressure(const vector<double>& pressure) {
 
     auto max_size = std::min(pressure.size(), this->points.size() - 1);
     for (size_t i = 0U; i != max_size; ++i) {
-        this->points[i].z = pressure[i];
+        this->points.setPressure(i, pressure[i]);
     }
+    pointsChanged();
 }
 
 /**
@@ -259,71 +299,150 @@ auto Stroke::intersects(double x, double y, double halfEraserSize) -> bool {
 }
 
 /**
- * checks if the stroke is intersected by the eraser rectangle
+ * Padding of the hit test of a segment
  */
-auto Stroke::intersects(double x, double y, double halfEraserSize, double* gap) -> bool {
-    if (this->points.empty()) {
-        return false;
-    }
+constexpr double SEGMENT_PADDING = 0.1;
 
+/**
+ * checks if a point of a stroke, or the segment from the previous point to it, is intersected by the eraser rectangle
+ */
+static auto intersectsSegment(double x, double y, double halfEraserSize, double lastX, double lastY, double px,
+                              double py, double* gap) -> bool {
     double x1 = x - halfEraserSize;
     double x2 = x + halfEraserSize;
     double y1 = y - halfEraserSize;
     double y2 = y + halfEraserSize;
 
-    double lastX = points[0].x;
-    double lastY = points[0].y;
-    for (auto&& point: points) {
-        double px = point.x;
-        double py = point.y;
-
-        if (px >= x1 && py >= y1 && px <= x2 && py <= y2) {
-            if (gap) {
-                *gap = 0;
-            }
-            return true;
+    if (px >= x1 && py >= y1 && px <= x2 && py <= y2) {
+        if (gap) {
+            *gap = 0;
         }
+        return true;
+    }
 
-        double len = hypot(px - lastX, py - lastY);
-        if (len >= halfEraserSize) {
-            /**
-             * The distance of the center of the eraser box to the line passing through (lastx, lasty) and (px, py)
-             */
-            double p = std::abs((x - lastX) * (lastY - py) + (y - lastY) * (px - lastX)) / len;
-
-            // If the distance p of the center of the eraser box to the (full) line is in the range,
-            // we check whether the eraser box is not too far from the line segment through the two points.
+    double len = hypot(px - lastX, py - lastY);
+    if (len >= halfEraserSize) {
+        /**
+         * The distance of the center of the eraser box to the line passing through (lastx, lasty) and (px, py)
+         */
+        double p = std::abs((x - lastX) * (lastY - py) + (y - lastY) * (px - lastX)) / len;
 
-            if (p <= halfEraserSize) {
-                double centerX = (lastX + px) / 2;
-                double centerY = (lastY + py) / 2;
-                double distance = hypot(x - centerX, y - centerY);
+        // If the distance p of the center of the eraser box to the (full) line is in the range,
+        // we check whether the eraser box is not too far from the line segment through the two points.
 
-                // For the above check we imagine a circle whose center is the mid point of the two points of the stroke
-                // and whose radius is half the length of the line segment plus half the diameter of the eraser box
-                // plus some small padding
-                // If the center of the eraser box lies within that circle then we consider it to be close enough
+        if (p <= halfEraserSize) {
+            double centerX = (lastX + px) / 2;
+            double centerY = (lastY + py) / 2;
+            double distance = hypot(x - centerX, y - centerY);
 
-                distance -= halfEraserSize * std::sqrt(2);
+            // For the above check we imagine a circle whose center is the mid point of the two points of the stroke
+            // and whose radius is half the length of the line segment plus half the diameter of the eraser box
+            // plus some small padding
+            // If the center of the eraser box lies within that circle then we consider it to be close enough
 
-                constexpr double PADDING = 0.1;
+            distance -= halfEraserSize * std::sqrt(2);
 
-                if (distance <= len / 2 + PADDING) {
-                    if (gap) {
-                        *gap = distance;
-                    }
-                    return true;
+            if (distance <= len / 2 + SEGMENT_PADDING) {
+                if (gap) {
+                    *gap = distance;
                 }
+                return true;
             }
         }
-
-        lastX = px;
-        lastY = py;
     }
 
     return false;
 }
 
+/**
+ * checks if the stroke is intersected by the eraser rectangle
+ */
+auto Stroke::intersects(double x, double y, double halfEraserSize, double* gap) -> bool {
+    if (this->points.empty()) {
+        return false;
+    }
+
+    const double* xs = this->points.xData();
+    const double* ys = this->points.yData();
+
+    // A hit is at most half a segment plus half the eraser diagonal away from a point
+    auto near = [&](StrokeChunkBounds::Chunk const& chunk) {
+        return chunk.distanceTo(x, y) <= chunk.maxSegmentLength / 2 + halfEraserSize * std::sqrt(2) + SEGMENT_PADDING;
+    };
+
+    // The chunks are visited in order, so the first hit and its gap are the same as if all points were tested
+    return this->chunkBounds.findChunk(this->points, near, [&](StrokeChunkBounds::Chunk const& chunk) {
+        // Only the candidates found by the vectorized test are checked exactly
+        size_t i = chunk.first;
+        while ((i = HitTest::nextSegmentCandidate(xs, ys, i, chunk.end, x, y, halfEraserSize, SEGMENT_PADDING)) <
+               chunk.end) {
+            size_t last = i > 0 ? i - 1 : 0;
+            if (intersectsSegment(x, y, halfEraserSize, xs[last], ys[last], xs[i], ys[i], gap)) {
+                return true;
+            }
+            i++;
+        }
+        return false;
+    });
+}
+
+/**
+ * @return the distance of (x, y) to the segment from (x1, y1) to (x2, y2)
+ */
+static auto distanceToSegment(double x, double y, double x1, double y1, double x2, double y2) -> double {
+    double dx = x2 - x1;
+    double dy = y2 - y1;
+    double len2 = dx * dx + dy * dy;
+    double t = len2 > 0 ? std::clamp(((x - x1) * dx + (y - y1) * dy) / len2, 0.0, 1.0) : 0;
+    return std::hypot(x - (x1 + t * dx), y - (y1 + t * dy));
+}
+
+/**
+ * @return the distance between the segments a1 - a2 and b1 - b2
+ */
+static auto segmentDistance(double ax1, double ay1, double ax2, double ay2, double bx1, double by1, double bx2,
+                            double by2) -> double {
+    auto side = [](double x1, double y1, double x2, double y2, double x, double y) {
+        return (x2 - x1) * (y - y1) - (y2 - y1) * (x - x1);
+    };
+
+    // Crossing segments
+    if (side(ax1, ay1, ax2, ay2, bx1, by1) * side(ax1, ay1, ax2, ay2, bx2, by2) < 0 &&
+        side(bx1, by1, bx2, by2, ax1, ay1) * side(bx1, by1, bx2, by2, ax2, ay2) < 0) {
+        return 0;
+    }
+
+    return std::min({distanceToSegment(ax1, ay1, bx1, by1, bx2, by2), distanceToSegment(ax2, ay2, bx1, by1, bx2, by2),
+                     distanceToSegment(bx1, by1, ax1, ay1, ax2, ay2), distanceToSegment(bx2, by2, ax1, ay1, ax2, ay2)});
+}
+
+auto Stroke::mayIntersectMotion(double x1, double y1, double x2, double y2, double halfEraserSize) -> bool {
+    if (this->points.empty()) {
+        return false;
+    }
+
+    const double* xs = this->points.xData();
+    const double* ys = this->points.yData();
+
+    // intersectsSegment() hits segments up to the eraser diagonal and the padding away from the center,
+    // measured to the circle around the segment. 2 * halfEraserSize covers both.
+    double reach = 2 * halfEraserSize + SEGMENT_PADDING;
+
+    // The eraser square swept along the motion is tested against the chunks first, then against their segments
+    return this->chunkBounds.findChunk(
+            this->points,
+            [&](StrokeChunkBounds::Chunk const& chunk) { return chunk.nearSegment(x1, y1, x2, y2, reach); },
+            [&](StrokeChunkBounds::Chunk const& chunk) {
+                for (size_t i = chunk.first; i < chunk.end; i++) {
+                    size_t last = i > 0 ? i - 1 : 0;
+                    if (segmentDistance(x1, y1, x2, y2, xs[last], ys[last], xs[i], ys[i]) <= reach) {
+                        return true;
+                    }
+                }
+                return false;
+            });
+}
+
 /**
  * Updates the size
  * The size is needed to only redraw the requested part instead of redrawing
@@ -341,6 +460,7 @@ void Stroke::calcSize() const {
 
         // used for snapping
         Element::snappedBounds = Rectangle<double>{};
+        return;
     }
 
     double minX = DBL_MAX;
@@ -353,10 +473,11 @@ void Stroke::calcSize() const {
     double minSnapY = DBL_MAX;
     double maxSnapY = DBL_MIN;
 
-    bool hasPressure = points[0].z != Point::NO_PRESSURE;
+    bool hasPressure = points.z(0) != Point::NO_PRESSURE;
     double halfThick = this->width / 2.0;  //  accommodate for pen width
 
-    for (auto&& p: points) {
+    for (size_t i = 0; i < points.size(); i++) {
+        Point p = points.get(i);
         if (hasPressure) {
             halfThick = p.z / 2.0;
         }
@@ -386,11 +507,13 @@ auto Stroke::getEraseable() -> EraseableStroke* { return this->eraseable; }
 
 void Stroke::setEraseable(EraseableStroke* eraseable) { this->eraseable = eraseable; }
 
+auto Stroke::getRenderCache() const -> StrokeRenderCache& { return *this->renderCache; }
+
 void Stroke::debugPrint() {
     g_message("%s", FC(FORMAT_STR("Stroke {1} / hasPressure() = {2}") % (uint64_t)this % this->hasPressure()));
 
-    for (auto&& p: points) {
-        g_message("%lf / %lf", p.x, p.y);
+    for (size_t i = 0; i < points.size(); i++) {
+        g_message("%lf / %lf", points.x(i), points.y(i));
     }
 
     g_message("\n");
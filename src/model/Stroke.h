@@ -11,10 +11,15 @@
 
 #pragma once
 
+#include <memory>
+
 #include "AudioElement.h"
 #include "Element.h"
 #include "LineStyle.h"
 #include "Point.h"
+#include "StrokeChunkBounds.h"
+#include "StrokePoints.h"
+#include "StrokeRenderCache.h"
 
 enum StrokeTool { STROKE_TOOL_PEN, STROKE_TOOL_ERASER, STROKE_TOOL_HIGHLIGHTER };
 
@@ -65,11 +70,25 @@ public:
     void setFirstPoint(double x, double y);
     void setLastPoint(const Point& p);
     int getPointCount() const;
+
+    /**
+     * Frees the memory reserved for further points, and the array created by getPointVector()
+     */
     void freeUnusedPointItems();
+
+    /**
+     * The points as one array, created from the compact storage on first use and kept until the points change
+     * or freeUnusedPointItems() is called. Only for the shape recognizers, which free it afterwards.
+     */
     std::vector<Point> const& getPointVector() const;
     Point getPoint(int index) const;
     const Point* getPoints() const;
 
+    /**
+     * The points without converting them, for loops over long strokes
+     */
+    StrokePoints const& getPointStorage() const;
+
     void deletePoint(int index);
     void deletePointsFrom(int index);
 
@@ -82,6 +101,12 @@ public:
     bool intersects(double x, double y, double halfEraserSize) override;
     bool intersects(double x, double y, double halfEraserSize, double* gap) override;
 
+    /**
+     * Checks if the eraser may hit the stroke while it's moved from (x1, y1) to (x2, y2). False if intersects()
+     * is false at every position on the way, so only the strokes passing this test need to be tested there.
+     */
+    bool mayIntersectMotion(double x1, double y1, double x2, double y2, double halfEraserSize);
+
     void setPressure(const vector<double>& pressure);
     void setLastPressure(double pressure);
     void clearPressure();
@@ -99,6 +124,11 @@ public:
     EraseableStroke* getEraseable();
     void setEraseable(EraseableStroke* eraseable);
 
+    /**
+     * Cached data to draw the stroke, invalidated if the points change
+     */
+    StrokeRenderCache& getRenderCache() const;
+
     [[maybe_unused]] void debugPrint();
 
 public:
@@ -109,14 +139,25 @@ public:
 protected:
     void calcSize() const override;
 
+private:
+    /**
+     * Has to be called after the points or the width changed
+     */
+    void pointsChanged();
+
+    /**
+     * Invalidates the render cache, or replaces it if a copy still uses it
+     */
+    void resetRenderCache();
+
 private:
     // The stroke width cannot be inherited from Element
     double width = 0;
 
     StrokeTool toolType = STROKE_TOOL_PEN;
 
-    // The array with the points
-    std::vector<Point> points{};
+    // The points
+    StrokePoints points;
 
     /**
      * Dashed line
@@ -125,6 +166,16 @@ private:
 
     EraseableStroke* eraseable = nullptr;
 
+    /**
+     * Shared with the copies made by cloneStroke() while they have the same points
+     */
+    std::shared_ptr<StrokeRenderCache> renderCache = std::make_shared<StrokeRenderCache>();
+
+    /**
+     * Bounding boxes for the hit tests, invalidated if the points change
+     */
+    StrokeChunkBounds chunkBounds;
+
     /**
      * Option to fill the shape:
      *  -1: The shape is not filled
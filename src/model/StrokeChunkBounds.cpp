@@ -0,0 +1,120 @@
+#include "StrokeChunkBounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+StrokeChunkBounds::StrokeChunkBounds(const StrokeChunkBounds&): StrokeChunkBounds() {}
+
+auto StrokeChunkBounds::operator=(const StrokeChunkBounds&) -> StrokeChunkBounds& {
+    invalidate();
+    return *this;
+}
+
+auto StrokeChunkBounds::Chunk::distanceTo(double x, double y) const -> double {
+    double dx = std::max({this->minX - x, 0.0, x - this->maxX});
+    double dy = std::max({this->minY - y, 0.0, y - this->maxY});
+    return std::hypot(dx, dy);
+}
+
+auto StrokeChunkBounds::Chunk::nearSegment(double x1, double y1, double x2, double y2, double distance) const -> bool {
+    // The segment is clipped to the box grown by distance, one axis after the other
+    double from = 0;
+    double to = 1;
+    auto clip = [&](double start, double delta, double min, double max) {
+        if (delta == 0) {
+            return start >= min && start <= max;
+        }
+        double t1 = (min - start) / delta;
+        double t2 = (max - start) / delta;
+        from = std::max(from, std::min(t1, t2));
+        to = std::min(to, std::max(t1, t2));
+        return from <= to;
+    };
+
+    return clip(x1, x2 - x1, this->minX - distance, this->maxX + distance) &&
+           clip(y1, y2 - y1, this->minY - distance, this->maxY + distance);
+}
+
+void StrokeChunkBounds::invalidate() {
+    this->valid = false;
+    this->chunks.clear();
+    this->chunks.shrink_to_fit();
+    this->groups.clear();
+    this->groups.shrink_to_fit();
+}
+
+auto StrokeChunkBounds::get(StrokePoints const& points) -> std::vector<Chunk> const& {
+    build(points);
+    return this->chunks;
+}
+
+auto StrokeChunkBounds::getGroups(StrokePoints const& points) -> std::vector<Chunk> const& {
+    build(points);
+    return this->groups;
+}
+
+auto StrokeChunkBounds::findChunk(StrokePoints const& points, std::function<bool(Chunk const&)> const& near,
+                                  std::function<bool(Chunk const&)> const& visit) -> bool {
+    build(points);
+
+    for (Chunk const& group: this->groups) {
+        if (!near(group)) {
+            continue;
+        }
+        for (size_t i = group.first; i < group.end; i++) {
+            if (near(this->chunks[i]) && visit(this->chunks[i])) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void StrokeChunkBounds::build(StrokePoints const& points) {
+    if (this->valid) {
+        return;
+    }
+
+    const double* xs = points.xData();
+    const double* ys = points.yData();
+
+    this->chunks.reserve((points.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    for (size_t first = 0; first < points.size(); first += CHUNK_SIZE) {
+        size_t end = std::min(first + CHUNK_SIZE, points.size());
+
+        // The segment to the first point belongs to this chunk, so the previous point is included
+        size_t from = first > 0 ? first - 1 : 0;
+        Chunk chunk{first, end, xs[from], ys[from], xs[from], ys[from], 0};
+        for (size_t i = from + 1; i < end; i++) {
+            chunk.minX = std::min(chunk.minX, xs[i]);
+            chunk.minY = std::min(chunk.minY, ys[i]);
+            chunk.maxX = std::max(chunk.maxX, xs[i]);
+            chunk.maxY = std::max(chunk.maxY, ys[i]);
+            chunk.maxSegmentLength = std::max(chunk.maxSegmentLength, std::hypot(xs[i] - xs[i - 1], ys[i] - ys[i - 1]));
+        }
+
+        this->chunks.push_back(chunk);
+    }
+
+    this->groups.reserve((this->chunks.size() + GROUP_SIZE - 1) / GROUP_SIZE);
+    for (size_t first = 0; first < this->chunks.size(); first += GROUP_SIZE) {
+        size_t end = std::min(first + GROUP_SIZE, this->chunks.size());
+
+        Chunk group = this->chunks[first];
+        group.first = first;
+        group.end = end;
+        for (size_t i = first + 1; i < end; i++) {
+            Chunk const& chunk = this->chunks[i];
+            group.minX = std::min(group.minX, chunk.minX);
+            group.minY = std::min(group.minY, chunk.minY);
+            group.maxX = std::max(group.maxX, chunk.maxX);
+            group.maxY = std::max(group.maxY, chunk.maxY);
+            group.maxSegmentLength = std::max(group.maxSegmentLength, chunk.maxSegmentLength);
+        }
+
+        this->groups.push_back(group);
+    }
+
+    this->valid = true;
+}
@@ -0,0 +1,108 @@
+/*
+ * Xournal++
+ *
+ * Bounding boxes of the parts of a stroke, for hit tests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "StrokePoints.h"
+
+/**
+ * The points of a stroke are split into chunks of consecutive points. Each chunk has the bounding box of its
+ * points and of the segment leading to its first point, so a hit test only visits the points of the chunks
+ * near the position. The chunks are grouped again, so long strokes skip most chunks by their group.
+ * Built on first use, only used by the UI thread.
+ */
+class StrokeChunkBounds {
+public:
+    /**
+     * Points per chunk
+     */
+    static constexpr size_t CHUNK_SIZE = 32;
+
+    /**
+     * Chunks per group
+     */
+    static constexpr size_t GROUP_SIZE = 8;
+
+    struct Chunk {
+        /**
+         * The points first until (excluding) end, for a group the chunks
+         */
+        size_t first;
+        size_t end;
+
+        double minX;
+        double minY;
+        double maxX;
+        double maxY;
+
+        /**
+         * The length of the longest segment ending at a point of this chunk
+         */
+        double maxSegmentLength;
+
+        /**
+         * @return the distance of (x, y) to the bounding box, 0 if it's inside
+         */
+        double distanceTo(double x, double y) const;
+
+        /**
+         * @return false if the segment from (x1, y1) to (x2, y2) is further than distance away from the
+         *         bounding box. May be true for segments a bit further away, near the corners.
+         */
+        bool nearSegment(double x1, double y1, double x2, double y2, double distance) const;
+    };
+
+public:
+    StrokeChunkBounds() = default;
+
+    /**
+     * The chunks belong to one stroke, a copy of the stroke starts without chunks
+     */
+    StrokeChunkBounds(const StrokeChunkBounds&);
+    StrokeChunkBounds& operator=(const StrokeChunkBounds&);
+
+public:
+    /**
+     * Has to be called if the points of the stroke change
+     */
+    void invalidate();
+
+    /**
+     * The chunks in the order of the points, built on first use
+     */
+    std::vector<Chunk> const& get(StrokePoints const& points);
+
+    /**
+     * The groups of GROUP_SIZE chunks, with the bounds of all their chunks
+     */
+    std::vector<Chunk> const& getGroups(StrokePoints const& points);
+
+    /**
+     * Calls visit with the chunks in the order of the points, until it returns true. Only groups and chunks
+     * for which near returns true are visited.
+     *
+     * @return true if visit returned true
+     */
+    bool findChunk(StrokePoints const& points, std::function<bool(Chunk const&)> const& near,
+                   std::function<bool(Chunk const&)> const& visit);
+
+private:
+    void build(StrokePoints const& points);
+
+private:
+    bool valid = false;
+    std::vector<Chunk> chunks;
+    std::vector<Chunk> groups;
+};
@@ -0,0 +1,129 @@
+#include "StrokePoints.h"
+
+#include <atomic>
+
+StrokePoints::StrokePoints(): data(std::make_shared<Arrays>()) {}
+
+auto StrokePoints::edit() -> Arrays& {
+    if (this->data.use_count() > 1) {
+        this->data = std::make_shared<Arrays>(*this->data);
+    } else {
+        // The last copy may just have been released by a render thread, its reads happen before the changes
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *this->data;
+}
+
+void StrokePoints::createPressureArray(Arrays& a) {
+    a.zs.reserve(a.xs.capacity());
+    a.zs.assign(a.xs.size(), Point::NO_PRESSURE);
+}
+
+auto StrokePoints::editXData() -> double* { return edit().xs.data(); }
+
+auto StrokePoints::editYData() -> double* { return edit().ys.data(); }
+
+void StrokePoints::set(size_t i, Point const& p) {
+    Arrays& a = edit();
+    a.xs[i] = p.x;
+    a.ys[i] = p.y;
+    setPressure(i, p.z);
+}
+
+void StrokePoints::setPressure(size_t i, double z) {
+    if (this->data->zs.empty() && z == Point::NO_PRESSURE) {
+        return;
+    }
+
+    Arrays& a = edit();
+    if (a.zs.empty()) {
+        createPressureArray(a);
+    }
+    a.zs[i] = z;
+}
+
+void StrokePoints::push_back(Point const& p) {
+    Arrays& a = edit();
+    if (a.zs.empty() && p.z != Point::NO_PRESSURE) {
+        createPressureArray(a);
+    }
+
+    a.xs.push_back(p.x);
+    a.ys.push_back(p.y);
+    if (!a.zs.empty()) {
+        a.zs.push_back(p.z);
+    }
+}
+
+void StrokePoints::erase(size_t i) {
+    Arrays& a = edit();
+    a.xs.erase(a.xs.begin() + i);
+    a.ys.erase(a.ys.begin() + i);
+    if (!a.zs.empty()) {
+        a.zs.erase(a.zs.begin() + i);
+    }
+}
+
+void StrokePoints::truncate(size_t count) {
+    if (count >= size()) {
+        return;
+    }
+    Arrays& a = edit();
+    a.xs.resize(count);
+    a.ys.resize(count);
+    if (!a.zs.empty()) {
+        a.zs.resize(count);
+    }
+}
+
+void StrokePoints::assign(Point const* points, size_t count) {
+    // Nothing is kept, so the shared arrays are not copied
+    this->data = std::make_shared<Arrays>();
+    Arrays& a = *this->data;
+    a.xs.resize(count);
+    a.ys.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        a.xs[i] = points[i].x;
+        a.ys[i] = points[i].y;
+        if (points[i].z != Point::NO_PRESSURE && a.zs.empty()) {
+            a.zs.assign(count, Point::NO_PRESSURE);
+        }
+        if (!a.zs.empty()) {
+            a.zs[i] = points[i].z;
+        }
+    }
+}
+
+void StrokePoints::clearPressure() {
+    if (!hasPressureArray()) {
+        return;
+    }
+    Arrays& a = edit();
+    a.zs.clear();
+    a.zs.shrink_to_fit();
+}
+
+void StrokePoints::shrinkToFit() {
+    if (this->data.use_count() > 1) {
+        // A copy of the arrays has no reserved capacity
+        return;
+    }
+    Arrays& a = edit();
+    a.xs.shrink_to_fit();
+    a.ys.shrink_to_fit();
+    a.zs.shrink_to_fit();
+}
+
+auto StrokePoints::toVector() const -> std::vector<Point> {
+    std::vector<Point> points;
+    points.reserve(size());
+    for (size_t i = 0; i < size(); i++) {
+        points.push_back(get(i));
+    }
+    return points;
+}
+
+auto StrokePoints::getMemoryUsage() const -> size_t {
+    return (this->data->xs.capacity() + this->data->ys.capacity() + this->data->zs.capacity()) * sizeof(double);
+}
@@ -0,0 +1,117 @@
+/*
+ * Xournal++
+ *
+ * Compact storage of the points of a stroke
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "Point.h"
+
+/**
+ * The coordinates are stored in separate arrays. The pressure array only exists if a point has a pressure,
+ * so a point of a stroke without pressure needs 16 instead of 24 bytes.
+ *
+ * A copy shares the arrays until one of them is changed, so a render thread can draw a copy of
+ * the points while the original is edited. Copies and changes have to be made with the document locked.
+ */
+class StrokePoints {
+public:
+    StrokePoints();
+
+    /**
+     * There is no move, a moved from object would have no arrays
+     */
+    StrokePoints(const StrokePoints&) = default;
+    StrokePoints& operator=(const StrokePoints&) = default;
+
+public:
+    size_t size() const { return this->data->xs.size(); }
+    bool empty() const { return this->data->xs.empty(); }
+
+    double x(size_t i) const { return this->data->xs[i]; }
+    double y(size_t i) const { return this->data->ys[i]; }
+    double z(size_t i) const { return this->data->zs.empty() ? Point::NO_PRESSURE : this->data->zs[i]; }
+
+    Point get(size_t i) const { return Point(x(i), y(i), z(i)); }
+
+    /**
+     * The coordinate arrays, for loops which only need the position
+     */
+    const double* xData() const { return this->data->xs.data(); }
+    const double* yData() const { return this->data->ys.data(); }
+
+    /**
+     * The coordinate arrays to change them, the arrays are not shared with a copy anymore afterwards
+     */
+    double* editXData();
+    double* editYData();
+
+    /**
+     * @return true if the pressure array exists, the points without pressure have Point::NO_PRESSURE in it
+     */
+    bool hasPressureArray() const { return !this->data->zs.empty(); }
+
+    void set(size_t i, Point const& p);
+    void setPressure(size_t i, double z);
+
+    void push_back(Point const& p);
+    void erase(size_t i);
+
+    /**
+     * Removes the points from count on
+     */
+    void truncate(size_t count);
+
+    void assign(Point const* points, size_t count);
+
+    /**
+     * Removes the pressure of all points
+     */
+    void clearPressure();
+
+    /**
+     * Frees the memory reserved for further points
+     */
+    void shrinkToFit();
+
+    /**
+     * @return the points as one array, e.g. for serializing
+     */
+    std::vector<Point> toVector() const;
+
+    /**
+     * The memory of the arrays, including the reserved capacity
+     */
+    size_t getMemoryUsage() const;
+
+private:
+    struct Arrays {
+        std::vector<double> xs;
+        std::vector<double> ys;
+
+        /**
+         * Empty if no point has a pressure
+         */
+        std::vector<double> zs;
+    };
+
+    /**
+     * @return the arrays to change, copied first if they are shared
+     */
+    Arrays& edit();
+
+    static void createPressureArray(Arrays& a);
+
+private:
+    std::shared_ptr<Arrays> data;
+};
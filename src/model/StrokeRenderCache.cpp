@@ -0,0 +1,192 @@
+#include "StrokeRenderCache.h"
+
+#include <cmath>
+#include <utility>
+
+/**
+ * Maximum deviation of a simplified stroke, in device pixels
+ */
+constexpr double LOD_PIXEL_TOLERANCE = 1.0;
+
+/**
+ * Tolerance of level 1 in document units, each further level doubles it. So the chosen level deviates
+ * between half a pixel and a pixel, from 50% down to about 6% zoom.
+ */
+constexpr double LOD_BASE_TOLERANCE = 1.0;
+
+StrokeRenderCache::StrokeRenderCache() { g_mutex_init(&this->cacheMutex); }
+
+StrokeRenderCache::~StrokeRenderCache() {
+    clear();
+    g_mutex_clear(&this->cacheMutex);
+}
+
+StrokeRenderCache::StrokeRenderCache(const StrokeRenderCache&): StrokeRenderCache() {}
+
+auto StrokeRenderCache::operator=(const StrokeRenderCache&) -> StrokeRenderCache& {
+    invalidate();
+    return *this;
+}
+
+void StrokeRenderCache::invalidate() {
+    g_mutex_lock(&this->cacheMutex);
+    clear();
+    g_mutex_unlock(&this->cacheMutex);
+}
+
+void StrokeRenderCache::clear() {
+    for (int level = 0; level < LOD_LEVELS; level++) {
+        if (this->outline[level]) {
+            cairo_path_destroy(this->outline[level]);
+            this->outline[level] = nullptr;
+        }
+        this->simplified[level] = nullptr;
+    }
+    this->pointVector = nullptr;
+}
+
+auto StrokeRenderCache::getLevel(double deviceScale) -> int {
+    double tolerance = LOD_PIXEL_TOLERANCE / deviceScale;
+
+    // Strictly below the pixel tolerance, so at 100% zoom and above all points are drawn
+    int level = 0;
+    while (level + 1 < LOD_LEVELS && getTolerance(level + 1) < tolerance) {
+        level++;
+    }
+    return level;
+}
+
+auto StrokeRenderCache::getTolerance(int level) -> double {
+    return level > 0 ? LOD_BASE_TOLERANCE * std::pow(2.0, level - 1) : 0;
+}
+
+auto StrokeRenderCache::getSimplified(StrokePoints const& points, int level)
+        -> std::shared_ptr<const std::vector<Point>> {
+    g_mutex_lock(&this->cacheMutex);
+
+    auto& result = this->simplified[level];
+    if (!result) {
+        result = std::make_shared<const std::vector<Point>>(simplify(points, getTolerance(level)));
+    }
+    auto ret = result;
+
+    g_mutex_unlock(&this->cacheMutex);
+    return ret;
+}
+
+auto StrokeRenderCache::getPointVector(StrokePoints const& points) -> std::shared_ptr<const std::vector<Point>> {
+    g_mutex_lock(&this->cacheMutex);
+
+    if (!this->pointVector) {
+        this->pointVector = std::make_shared<const std::vector<Point>>(points.toVector());
+    }
+    auto ret = this->pointVector;
+
+    g_mutex_unlock(&this->cacheMutex);
+    return ret;
+}
+
+auto StrokeRenderCache::simplify(StrokePoints const& points, double tolerance) -> std::vector<Point> {
+    if (points.size() <= 2) {
+        return points.toVector();
+    }
+
+    std::vector<bool> keep(points.size(), false);
+    keep.front() = true;
+    keep.back() = true;
+
+    // Iterative, long strokes would overflow the stack with recursion
+    std::vector<std::pair<size_t, size_t>> ranges;
+    ranges.emplace_back(0, points.size() - 1);
+
+    while (!ranges.empty()) {
+        auto [first, last] = ranges.back();
+        ranges.pop_back();
+
+        Point a = points.get(first);
+        Point b = points.get(last);
+        double dx = b.x - a.x;
+        double dy = b.y - a.y;
+        double len2 = dx * dx + dy * dy;
+
+        double maxError = 0;
+        size_t maxIndex = first;
+        for (size_t i = first + 1; i < last; i++) {
+            Point p = points.get(i);
+
+            // Distance to the segment, and the deviation of the line width
+            double t = len2 > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2 : 0;
+            t = std::max(0.0, std::min(1.0, t));
+            double error = std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+            if (p.z != Point::NO_PRESSURE && a.z != Point::NO_PRESSURE && b.z != Point::NO_PRESSURE) {
+                error = std::max(error, std::abs(p.z - (a.z + t * (b.z - a.z))) / 2);
+            }
+
+            if (error > maxError) {
+                maxError = error;
+                maxIndex = i;
+            }
+        }
+
+        if (maxError > tolerance) {
+            keep[maxIndex] = true;
+            ranges.emplace_back(first, maxIndex);
+            ranges.emplace_back(maxIndex, last);
+        }
+    }
+
+    std::vector<Point> result;
+    for (size_t i = 0; i < points.size(); i++) {
+        if (keep[i]) {
+            result.push_back(points.get(i));
+        }
+    }
+    return result;
+}
+
+auto StrokeRenderCache::OutlineKey::operator==(OutlineKey const& other) const -> bool {
+    return scaleFactor == other.scaleFactor && xx == other.xx && yx == other.yx && xy == other.xy &&
+           yy == other.yy;
+}
+
+void StrokeRenderCache::appendOutline(cairo_t* cr, double scaleFactor, int level,
+                                      std::function<void()> const& build) {
+    cairo_matrix_t matrix;
+    cairo_get_matrix(cr, &matrix);
+    OutlineKey key{scaleFactor, matrix.xx, matrix.yx, matrix.xy, matrix.yy};
+
+    g_mutex_lock(&this->cacheMutex);
+
+    if (this->outline[level] && this->outlineKey[level] == key) {
+        cairo_append_path(cr, this->outline[level]);
+        g_mutex_unlock(&this->cacheMutex);
+        return;
+    }
+
+    if (this->outline[level]) {
+        cairo_path_destroy(this->outline[level]);
+        this->outline[level] = nullptr;
+    }
+
+    // Built without the translation, so the copy doesn't depend on the position of the device
+    cairo_matrix_t linear = matrix;
+    linear.x0 = 0;
+    linear.y0 = 0;
+    cairo_set_matrix(cr, &linear);
+    cairo_new_path(cr);
+    build();
+    cairo_path_t* path = cairo_copy_path(cr);
+    cairo_set_matrix(cr, &matrix);
+
+    cairo_new_path(cr);
+    if (path->status == CAIRO_STATUS_SUCCESS) {
+        cairo_append_path(cr, path);
+        this->outline[level] = path;
+        this->outlineKey[level] = key;
+    } else {
+        cairo_path_destroy(path);
+        build();
+    }
+
+    g_mutex_unlock(&this->cacheMutex);
+}
@@ -0,0 +1,123 @@
+/*
+ * Xournal++
+ *
+ * Data derived from the points of a Stroke to draw it faster,
+ * rebuilt on the next draw after the points changed
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <cairo/cairo.h>
+#include <glib.h>
+
+#include "Point.h"
+#include "StrokePoints.h"
+
+class StrokeRenderCache {
+public:
+    /**
+     * Count of level of details, level 0 contains all points
+     */
+    static constexpr int LOD_LEVELS = 5;
+
+public:
+    StrokeRenderCache();
+    ~StrokeRenderCache();
+
+    /**
+     * The cache belongs to one stroke, a copy of the stroke starts without cache
+     */
+    StrokeRenderCache(const StrokeRenderCache&);
+    StrokeRenderCache& operator=(const StrokeRenderCache&);
+
+public:
+    /**
+     * Frees all cached data, has to be called if the points of the stroke change
+     */
+    void invalidate();
+
+    /**
+     * @param deviceScale Device pixels per document unit
+     * @return the coarsest level of detail which looks the same as all points at this scale
+     */
+    static int getLevel(double deviceScale);
+
+    /**
+     * @return the maximum deviation of the simplified points of a level, in document units
+     */
+    static double getTolerance(int level);
+
+    /**
+     * The simplified points of a level > 0, computed on first use
+     *
+     * @param points All points of the stroke
+     */
+    std::shared_ptr<const std::vector<Point>> getSimplified(StrokePoints const& points, int level);
+
+    /**
+     * All points of the stroke as one array, converted on first use
+     */
+    std::shared_ptr<const std::vector<Point>> getPointVector(StrokePoints const& points);
+
+    /**
+     * Appends the outline of a pressure stroke to the path of cr.
+     * If it's not cached for this scale factor, level and transformation of cr, build is called
+     * to create it on the empty path of cr, and the result is cached.
+     * The translation of cr may differ, e.g. for the tiles of a page.
+     */
+    void appendOutline(cairo_t* cr, double scaleFactor, int level, std::function<void()> const& build);
+
+private:
+    void clear();
+
+    /**
+     * Douglas-Peucker simplification, the pressure is kept within the tolerance, too
+     */
+    static std::vector<Point> simplify(StrokePoints const& points, double tolerance);
+
+private:
+    GMutex cacheMutex{};
+
+    /**
+     * The simplified points per level, index 0 is unused
+     */
+    std::array<std::shared_ptr<const std::vector<Point>>, LOD_LEVELS> simplified;
+
+    /**
+     * For the callers which need the points as one array
+     */
+    std::shared_ptr<const std::vector<Point>> pointVector;
+
+    /**
+     * What an outline was built for: the arcs are approximated depending on the device resolution
+     */
+    struct OutlineKey {
+        double scaleFactor;
+
+        /**
+         * The transformation of cr without the translation
+         */
+        double xx;
+        double yx;
+        double xy;
+        double yy;
+
+        bool operator==(OutlineKey const& other) const;
+    };
+
+    /**
+     * The outline per level in document coordinates
+     */
+    std::array<cairo_path_t*, LOD_LEVELS> outline{};
+    std::array<OutlineKey, LOD_LEVELS> outlineKey{};
+};
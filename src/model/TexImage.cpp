@@ -21,6 +21,9 @@ void TexImage::freeImageAndPdf() {
         g_object_unref(this->pdf);
         this->pdf = nullptr;
     }
+
+    this->mipmap.invalidate();
+    this->renderCache.invalidate();
 }
 
 auto TexImage::clone() -> Element* {
@@ -38,11 +41,13 @@ auto TexImage::clone() -> Element* {
 void TexImage::setWidth(double width) {
     this->width = width;
     this->calcSize();
+    boundsChanged();
 }
 
 void TexImage::setHeight(double height) {
     this->height = height;
     this->calcSize();
+    boundsChanged();
 }
 
 auto TexImage::cairoReadFunction(TexImage* image, unsigned char* data, unsigned int length) -> cairo_status_t {
@@ -97,6 +102,10 @@ auto TexImage::getImage() -> cairo_surface_t* { return this->image; }
 
 auto TexImage::getPdf() -> PopplerDocument* { return this->pdf; }
 
+auto TexImage::getMipmap() -> ImageMipmap& { return this->mipmap; }
+
+auto TexImage::getRenderCache() -> TexRenderCache& { return this->renderCache; }
+
 void TexImage::scale(double x0, double y0, double fx, double fy, double rotation,
                      bool) {  // line width scaling option is not used
 
@@ -106,6 +115,7 @@ void TexImage::scale(double x0, double y0, double fx, double fy, double rotation
     this->width *= fx;
     this->height *= fy;
     this->calcSize();
+    boundsChanged();
 }
 
 void TexImage::rotate(double x0, double y0, double th) {
@@ -18,6 +18,8 @@
 #include <poppler.h>
 
 #include "Element.h"
+#include "ImageMipmap.h"
+#include "TexRenderCache.h"
 #include "XournalType.h"
 
 
@@ -51,6 +53,16 @@ public:
      */
     PopplerDocument* getPdf();
 
+    /**
+     * The downscaled versions of the image used for drawing
+     */
+    ImageMipmap& getMipmap();
+
+    /**
+     * The rasterized renderings of the PDF used for drawing
+     */
+    TexRenderCache& getRenderCache();
+
     virtual void scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth);
     virtual void rotate(double x0, double y0, double th);
 
@@ -105,4 +117,8 @@ private:
      * Tex String
      */
     string text;
+
+    ImageMipmap mipmap;
+
+    TexRenderCache renderCache;
 };
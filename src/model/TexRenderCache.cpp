@@ -0,0 +1,116 @@
+#include "TexRenderCache.h"
+
+#include <cmath>
+
+/**
+ * Steps per device pixel which are distinguished for the size
+ */
+constexpr double SIZE_STEPS = 8;
+
+/**
+ * Steps of the sub pixel position which are distinguished
+ */
+constexpr double PHASE_STEPS = 4;
+
+/**
+ * Bigger renderings are not cached, the PDF is rendered directly
+ */
+constexpr double MAX_PIXELS = 4096;
+
+TexRenderCache::TexRenderCache() { g_mutex_init(&this->cacheMutex); }
+
+TexRenderCache::~TexRenderCache() {
+    clear();
+    g_mutex_clear(&this->cacheMutex);
+}
+
+TexRenderCache::TexRenderCache(const TexRenderCache&): TexRenderCache() {}
+
+auto TexRenderCache::operator=(const TexRenderCache&) -> TexRenderCache& {
+    invalidate();
+    return *this;
+}
+
+void TexRenderCache::invalidate() {
+    g_mutex_lock(&this->cacheMutex);
+    clear();
+    g_mutex_unlock(&this->cacheMutex);
+}
+
+void TexRenderCache::clear() {
+    for (Entry& e: this->entries) {
+        cairo_surface_destroy(e.surface);
+    }
+    this->entries.clear();
+}
+
+auto TexRenderCache::paint(cairo_t* cr, double x, double y, double width, double height, Render const& render)
+        -> bool {
+    if (cairo_surface_get_type(cairo_get_target(cr)) != CAIRO_SURFACE_TYPE_IMAGE) {
+        // Keep vector output for PDF / SVG export and printing
+        return false;
+    }
+
+    cairo_matrix_t matrix;
+    cairo_get_matrix(cr, &matrix);
+    double deviceWidth = width * matrix.xx;
+    double deviceHeight = height * matrix.yy;
+    if (matrix.xy != 0 || matrix.yx != 0 || deviceWidth <= 0 || deviceHeight <= 0 || deviceWidth > MAX_PIXELS ||
+        deviceHeight > MAX_PIXELS) {
+        return false;
+    }
+
+    // Align the rendering with the device pixels, so it's painted without resampling
+    double deviceX = x;
+    double deviceY = y;
+    cairo_user_to_device(cr, &deviceX, &deviceY);
+    double originX = std::floor(deviceX);
+    double originY = std::floor(deviceY);
+    int phaseX = static_cast<int>(std::lround((deviceX - originX) * PHASE_STEPS));
+    int phaseY = static_cast<int>(std::lround((deviceY - originY) * PHASE_STEPS));
+    int64_t keyWidth = std::llround(deviceWidth * SIZE_STEPS);
+    int64_t keyHeight = std::llround(deviceHeight * SIZE_STEPS);
+
+    g_mutex_lock(&this->cacheMutex);
+
+    auto it = this->entries.begin();
+    while (it != this->entries.end() && !(it->width == keyWidth && it->height == keyHeight &&
+                                          it->phaseX == phaseX && it->phaseY == phaseY)) {
+        ++it;
+    }
+
+    if (it != this->entries.end()) {
+        this->entries.splice(this->entries.begin(), this->entries, it);
+    } else {
+        double offsetX = phaseX / PHASE_STEPS;
+        double offsetY = phaseY / PHASE_STEPS;
+        cairo_surface_t* surface =
+                cairo_image_surface_create(CAIRO_FORMAT_ARGB32, static_cast<int>(std::ceil(offsetX + deviceWidth)),
+                                           static_cast<int>(std::ceil(offsetY + deviceHeight)));
+        cairo_t* crSurface = cairo_create(surface);
+        cairo_translate(crSurface, offsetX, offsetY);
+        cairo_scale(crSurface, deviceWidth / width, deviceHeight / height);
+        render(crSurface);
+        cairo_destroy(crSurface);
+
+        this->entries.push_front({keyWidth, keyHeight, phaseX, phaseY, surface});
+        while (this->entries.size() > MAX_ENTRIES) {
+            cairo_surface_destroy(this->entries.back().surface);
+            this->entries.pop_back();
+        }
+    }
+
+    cairo_surface_t* surface = cairo_surface_reference(this->entries.front().surface);
+
+    g_mutex_unlock(&this->cacheMutex);
+
+    cairo_save(cr);
+    cairo_identity_matrix(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    cairo_set_source_surface(cr, surface, originX, originY);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    cairo_surface_destroy(surface);
+    return true;
+}
@@ -0,0 +1,80 @@
+/*
+ * Xournal++
+ *
+ * Rasterized renderings of a TexImage, so its PDF
+ * is not rendered on each draw
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+
+#include <cairo/cairo.h>
+#include <glib.h>
+
+class TexRenderCache {
+public:
+    /**
+     * Draws the formula at (0, 0) with the size of the element
+     */
+    using Render = std::function<void(cairo_t*)>;
+
+    /**
+     * Count of resolutions kept, e.g. for the page and the preview
+     */
+    static constexpr size_t MAX_ENTRIES = 3;
+
+public:
+    TexRenderCache();
+    ~TexRenderCache();
+
+    /**
+     * The renderings belong to one element, a copy of the element starts without cache
+     */
+    TexRenderCache(const TexRenderCache&);
+    TexRenderCache& operator=(const TexRenderCache&);
+
+public:
+    /**
+     * Frees all renderings, has to be called if the formula changes
+     */
+    void invalidate();
+
+    /**
+     * Paints the rendering for the resolution of cr to the rectangle x, y, width, height.
+     * If it's not cached, render is called to create it. The rendering is composited over the target.
+     *
+     * @return false if cr is no raster target or is rotated, the caller has to draw the vectors
+     */
+    bool paint(cairo_t* cr, double x, double y, double width, double height, Render const& render);
+
+private:
+    void clear();
+
+private:
+    struct Entry {
+        /**
+         * Device size and sub pixel position, quantized
+         */
+        int64_t width;
+        int64_t height;
+        int phaseX;
+        int phaseY;
+
+        cairo_surface_t* surface;
+    };
+
+    GMutex cacheMutex{};
+
+    /**
+     * The most recently used entry is at the front
+     */
+    std::list<Entry> entries;
+};
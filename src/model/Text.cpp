@@ -30,7 +30,12 @@ auto Text::clone() -> Element* {
 
 auto Text::getFont() -> XojFont& { return font; }
 
-void Text::setFont(const XojFont& font) { this->font = font; }
+void Text::setFont(const XojFont& font) {
+    this->font = font;
+    this->layoutCache.invalidate();
+    this->sizeCalculated = false;
+    boundsChanged();
+}
 
 auto Text::getFontSize() const -> double { return font.getSize(); }
 
@@ -40,8 +45,10 @@ auto Text::getText() const -> string { return this->text; }
 
 void Text::setText(string text) {
     this->text = std::move(text);
+    this->layoutCache.invalidate();
 
     calcSize();
+    boundsChanged();
 }
 
 void Text::calcSize() const {
@@ -52,11 +59,13 @@ void Text::calcSize() const {
 void Text::setWidth(double width) {
     this->width = width;
     this->updateSnapping();
+    boundsChanged();
 }
 
 void Text::setHeight(double height) {
     this->height = height;
     this->updateSnapping();
+    boundsChanged();
 }
 
 void Text::setInEditing(bool inEditing) { this->inEditing = inEditing; }
@@ -78,14 +87,18 @@ void Text::scale(double x0, double y0, double fx, double fy, double rotation,
 
     double size = this->font.getSize() * fx;
     this->font.setSize(size);
+    this->layoutCache.invalidate();
 
     calcSize();
+    boundsChanged();
 }
 
 void Text::rotate(double x0, double y0, double th) {}
 
 auto Text::isInEditing() const -> bool { return this->inEditing; }
 
+auto Text::getLayoutCache() const -> TextLayoutCache& { return this->layoutCache; }
+
 auto Text::rescaleOnlyAspectRatio() -> bool { return true; }
 
 auto Text::intersects(double x, double y, double halfEraserSize) -> bool {
@@ -121,6 +134,7 @@ void Text::readSerialized(ObjectInputStream& in) {
     this->text = in.readString();
 
     font.readSerialized(in);
+    this->layoutCache.invalidate();
 
     in.endObject();
 }
@@ -16,6 +16,7 @@
 #include "AudioElement.h"
 #include "Element.h"
 #include "Font.h"
+#include "TextLayoutCache.h"
 
 class Text: public AudioElement {
 public:
@@ -37,6 +38,11 @@ public:
     void setInEditing(bool inEditing);
     bool isInEditing() const;
 
+    /**
+     * The Pango layout used to draw, measure and search the text
+     */
+    TextLayoutCache& getLayoutCache() const;
+
     void scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth) override;
     void rotate(double x0, double y0, double th) override;
 
@@ -65,4 +71,6 @@ private:
     string text;
 
     bool inEditing = false;
+
+    mutable TextLayoutCache layoutCache;
 };
@@ -0,0 +1,53 @@
+#include "TextLayoutCache.h"
+
+TextLayoutCache::TextLayoutCache() { g_mutex_init(&this->layoutMutex); }
+
+TextLayoutCache::~TextLayoutCache() {
+    clear();
+    g_mutex_clear(&this->layoutMutex);
+}
+
+TextLayoutCache::TextLayoutCache(const TextLayoutCache&): TextLayoutCache() {}
+
+auto TextLayoutCache::operator=(const TextLayoutCache&) -> TextLayoutCache& {
+    invalidate();
+    return *this;
+}
+
+void TextLayoutCache::invalidate() {
+    g_mutex_lock(&this->layoutMutex);
+    clear();
+    g_mutex_unlock(&this->layoutMutex);
+}
+
+void TextLayoutCache::clear() {
+    for (auto& layout: this->layouts) {
+        if (layout) {
+            g_object_unref(layout);
+            layout = nullptr;
+        }
+    }
+}
+
+void TextLayoutCache::use(std::string const& text, std::string const& fontName, double fontSize, int dpi, Role role,
+                          std::function<PangoLayout*()> const& build, std::function<void(PangoLayout*)> const& use) {
+    g_mutex_lock(&this->layoutMutex);
+
+    // The font may be changed by reference, so the parameters are compared on each use
+    if (this->text != text || this->fontName != fontName || this->fontSize != fontSize || this->dpi != dpi) {
+        clear();
+        this->text = text;
+        this->fontName = fontName;
+        this->fontSize = fontSize;
+        this->dpi = dpi;
+    }
+
+    PangoLayout*& layout = this->layouts[static_cast<size_t>(role)];
+    if (layout == nullptr) {
+        layout = build();
+    }
+
+    use(layout);
+
+    g_mutex_unlock(&this->layoutMutex);
+}
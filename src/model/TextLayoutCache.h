@@ -0,0 +1,75 @@
+/*
+ * Xournal++
+ *
+ * The Pango layout of a Text element, kept between draws,
+ * size calculations and searches
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <string>
+
+#include <gtk/gtk.h>
+
+class TextLayoutCache {
+public:
+    /**
+     * The UI thread and the render threads use separate Pango contexts, so each has its own layout
+     */
+    enum class Role { UI, RENDER };
+
+public:
+    TextLayoutCache();
+    ~TextLayoutCache();
+
+    /**
+     * The cache belongs to one text, a copy of the text starts without cache
+     */
+    TextLayoutCache(const TextLayoutCache&);
+    TextLayoutCache& operator=(const TextLayoutCache&);
+
+public:
+    /**
+     * Frees the layout, has to be called if the text or the font changes
+     */
+    void invalidate();
+
+    /**
+     * Calls use with the layout of the text for role. If none is cached, or it was built for another text,
+     * font or resolution, build is called to create it.
+     *
+     * Pango objects must not be used by two threads at once, the caller serializes the threads of a role.
+     * build and use are called with the lock of this cache held.
+     */
+    void use(std::string const& text, std::string const& fontName, double fontSize, int dpi, Role role,
+             std::function<PangoLayout*()> const& build, std::function<void(PangoLayout*)> const& use);
+
+private:
+    void clear();
+
+private:
+    /**
+     * Protects the layouts of this text
+     */
+    GMutex layoutMutex{};
+
+    /**
+     * The layout per role, nullptr if not built yet
+     */
+    std::array<PangoLayout*, 2> layouts{};
+
+    /**
+     * The parameters the layouts were built with
+     */
+    std::string text;
+    std::string fontName;
+    double fontSize = 0;
+    int dpi = 0;
+};
@@ -1,5 +1,7 @@
 #include "EraseableStroke.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 
 #include "model/Stroke.h"
@@ -9,18 +11,23 @@
 #include "Range.h"
 
 EraseableStroke::EraseableStroke(Stroke* stroke): stroke(stroke) {
-    this->parts = new PartList();
+    this->parts = std::make_shared<PartList>();
     g_mutex_init(&this->partLock);
 
+    std::vector<Point>& points = this->parts->points;
+    points.reserve(2 * static_cast<size_t>(std::max(stroke->getPointCount() - 1, 0)));
     for (int i = 1; i < stroke->getPointCount(); i++) {
-        this->parts->add(new EraseableStrokePart(stroke->getPoint(i - 1), stroke->getPoint(i)));
+        Point a = stroke->getPoint(i - 1);
+        points.push_back(a);
+        points.push_back(stroke->getPoint(i));
+
+        EraseableStrokePart part(points.size() - 2, points.size(), a.z);
+        part.calcSize(points);
+        this->parts->parts.push_back(part);
     }
 }
 
-EraseableStroke::~EraseableStroke() {
-    delete this->parts;
-    this->parts = nullptr;
-}
+EraseableStroke::~EraseableStroke() { g_mutex_clear(&this->partLock); }
 
 ////////////////////////////////////////////////////////////////////////////////
 // This is done in a Thread, every thing else in the main loop /////////////////
@@ -28,32 +35,25 @@ EraseableStroke::~EraseableStroke() {
 
 void EraseableStroke::draw(cairo_t* cr) {
     g_mutex_lock(&this->partLock);
-    PartList* tmpCopy = this->parts->clone();
+    std::shared_ptr<PartList> current = this->parts;
     g_mutex_unlock(&this->partLock);
 
     double w = this->stroke->getWidth();
+    std::vector<Point> const& points = current->points;
 
-    for (GList* l = tmpCopy->data; l != nullptr; l = l->next) {
-        auto* part = static_cast<EraseableStrokePart*>(l->data);
-        if (part->getWidth() == Point::NO_PRESSURE) {
+    for (EraseableStrokePart const& part: current->parts) {
+        if (part.getWidth() == Point::NO_PRESSURE) {
             cairo_set_line_width(cr, w);
         } else {
-            cairo_set_line_width(cr, part->getWidth());
+            cairo_set_line_width(cr, part.getWidth());
         }
 
-        GList* pl = part->getPoints();
-        auto* p = static_cast<Point*>(pl->data);
-        cairo_move_to(cr, p->x, p->y);
-
-        pl = pl->next;
-        for (; pl != nullptr; pl = pl->next) {
-            auto* p = static_cast<Point*>(pl->data);
-            cairo_line_to(cr, p->x, p->y);
+        cairo_move_to(cr, points[part.first].x, points[part.first].y);
+        for (size_t i = part.first + 1; i < part.end; i++) {
+            cairo_line_to(cr, points[i].x, points[i].y);
         }
         cairo_stroke(cr);
     }
-
-    delete tmpCopy;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -66,26 +66,56 @@ void EraseableStroke::draw(cairo_t* cr) {
 auto EraseableStroke::erase(double x, double y, double halfEraserSize, Range* range) -> Range* {
     this->repaintRect = range;
 
-    g_mutex_lock(&this->partLock);
-    PartList* tmpCopy = this->parts->clone();
-    g_mutex_unlock(&this->partLock);
+    // Only this thread replaces the list, so it's read without the lock
+    PartList const& current = *this->parts;
 
-    for (GList* l = tmpCopy->data; l != nullptr;) {
-        auto* p = static_cast<EraseableStrokePart*>(l->data);
-        l = l->next;
-        erase(x, y, halfEraserSize, p, tmpCopy);
+    size_t firstHit = 0;
+    while (firstHit < current.parts.size() &&
+           hitTest(x, y, halfEraserSize, current.parts[firstHit], current.points) == Hit::NONE) {
+        firstHit++;
+    }
+    if (firstHit == current.parts.size()) {
+        return this->repaintRect;
+    }
+
+    std::shared_ptr<PartList> next = takeSpare();
+    next->points.reserve(current.points.size());
+    next->parts.reserve(current.parts.size() + 1);
+
+    for (size_t i = 0; i < current.parts.size(); i++) {
+        EraseableStrokePart const& part = current.parts[i];
+        Hit hit = i < firstHit ? Hit::NONE : hitTest(x, y, halfEraserSize, part, current.points);
+
+        if (hit == Hit::NONE) {
+            next->addCopy(current, part);
+        } else if (hit == Hit::PART) {
+            addRepaintRect(part.getX(), part.getY(), part.getElementWidth(), part.getElementHeight());
+        } else if (erasePart(x, y, halfEraserSize, part, current.points, *next)) {
+            addRepaintRect(part.getX(), part.getY(), part.getElementWidth(), part.getElementHeight());
+        }
     }
 
     g_mutex_lock(&this->partLock);
-    PartList* old = this->parts;
-    this->parts = tmpCopy;
+    this->spare = std::move(this->parts);
+    this->parts = std::move(next);
     g_mutex_unlock(&this->partLock);
 
-    delete old;
-
     return this->repaintRect;
 }
 
+auto EraseableStroke::takeSpare() -> std::shared_ptr<PartList> {
+    if (this->spare && this->spare.use_count() == 1) {
+        // The render threads are done with it, their reads happen before the reuse
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        std::shared_ptr<PartList> list = std::move(this->spare);
+        list->clear();
+        return list;
+    }
+
+    return std::make_shared<PartList>();
+}
+
 void EraseableStroke::addRepaintRect(double x, double y, double width, double height) {
     if (this->repaintRect) {
         this->repaintRect->addPoint(x, y);
@@ -96,22 +126,19 @@ void EraseableStroke::addRepaintRect(double x, double y, double width, double he
     this->repaintRect->addPoint(x + width, y + height);
 }
 
-void EraseableStroke::erase(double x, double y, double halfEraserSize, EraseableStrokePart* part, PartList* list) {
-    if (part->points->next == nullptr) {
-        return;
+auto EraseableStroke::hitTest(double x, double y, double halfEraserSize, EraseableStrokePart const& part,
+                              std::vector<Point> const& points) -> Hit {
+    if (part.getPointCount() < 2) {
+        return Hit::NONE;
     }
 
     Point eraser(x, y);
 
-    auto* a = static_cast<Point*>(g_list_first(part->points)->data);
-    auto* b = static_cast<Point*>(g_list_last(part->points)->data);
-
-    if (eraser.lineLengthTo(*a) < halfEraserSize * 1.2 && eraser.lineLengthTo(*b) < halfEraserSize * 1.2) {
-        list->data = g_list_remove(list->data, part);
-        addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
+    Point const& a = points[part.first];
+    Point const& b = points[part.end - 1];
 
-        delete part;
-        return;
+    if (eraser.lineLengthTo(a) < halfEraserSize * 1.2 && eraser.lineLengthTo(b) < halfEraserSize * 1.2) {
+        return Hit::PART;
     }
 
     double x1 = x - halfEraserSize;
@@ -119,41 +146,19 @@ void EraseableStroke::erase(double x, double y, double halfEraserSize, Eraseable
     double y1 = y - halfEraserSize;
     double y2 = y + halfEraserSize;
 
-    double aX = a->x;
-    double aY = a->y;
-    double bX = b->x;
-    double bY = b->y;
+    double aX = a.x;
+    double aY = a.y;
+    double bX = b.x;
+    double bY = b.y;
 
     // check first point
     if (aX >= x1 && aY >= y1 && aX <= x2 && aY <= y2) {
-        bool deleteAfter = false;
-
-        if (erasePart(x, y, halfEraserSize, part, list, &deleteAfter)) {
-            addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
-            part->calcSize();
-        }
-
-        if (deleteAfter) {
-            delete part;
-        }
-
-        return;
+        return Hit::POINTS;
     }
 
     // check last point
     if (bX >= x1 && bY >= y1 && bX <= x2 && bY <= y2) {
-        bool deleteAfter = false;
-
-        if (erasePart(x, y, halfEraserSize, part, list, &deleteAfter)) {
-            addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
-            part->calcSize();
-        }
-
-        if (deleteAfter) {
-            delete part;
-        }
-
-        return;
+        return Hit::POINTS;
     }
 
     double len = hypot(bX - aX, bY - aY);
@@ -180,114 +185,75 @@ void EraseableStroke::erase(double x, double y, double halfEraserSize, Eraseable
         constexpr double PADDING = 0.1;
 
         if (distance <= len / 2 + PADDING) {
-            bool deleteAfter = false;
+            return Hit::POINTS;
+        }
+    }
 
-            if (erasePart(x, y, halfEraserSize, part, list, &deleteAfter)) {
-                addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
-                part->calcSize();
-            }
+    return Hit::NONE;
+}
+
+auto EraseableStroke::erasePart(double x, double y, double halfEraserSize, EraseableStrokePart const& part,
+                                std::vector<Point> const& points, PartList& next) -> bool {
+    const Point* begin = points.data() + part.first;
+    const Point* end = points.data() + part.end;
+    double splitSize = part.splitSize;
+
+    // Split the part, so the eraser removes only a short piece of it
+    if (halfEraserSize != splitSize) {
+        splitSize = halfEraserSize;
+
+        Point const& a = *begin;
+        Point const& b = *(end - 1);
+        double len = a.lineLengthTo(b);
+
+        if (len > halfEraserSize) {
+            double step = halfEraserSize / 2;
 
-            if (deleteAfter) {
-                delete part;
+            this->splitPoints.clear();
+            this->splitPoints.push_back(a);
+            while (len > step) {
+                this->splitPoints.push_back(a.lineTo(b, len));
+                len -= step;
             }
+            std::reverse(this->splitPoints.begin() + 1, this->splitPoints.end());
+            this->splitPoints.push_back(b);
 
-            return;
+            begin = this->splitPoints.data();
+            end = begin + this->splitPoints.size();
         }
     }
-}
-
-auto EraseableStroke::erasePart(double x, double y, double halfEraserSize, EraseableStrokePart* part, PartList* list,
-                                bool* deleteStrokeAfter) -> bool {
-    bool changed = false;
-
-    part->splitFor(halfEraserSize);
 
     double x1 = x - halfEraserSize;
     double x2 = x + halfEraserSize;
     double y1 = y - halfEraserSize;
     double y2 = y + halfEraserSize;
 
-    /**
-     * erase the beginning
-     */
-    for (GList* l = part->getPoints(); l != nullptr;) {
-        auto* p = static_cast<Point*>(l->data);
-        l = l->next;
-        if (p->x >= x1 && p->y >= y1 && p->x <= x2 && p->y <= y2) {
-            part->points = g_list_remove(part->points, p);
-            delete p;
-            changed = true;
-        } else {
-            // only the beginning is handled here
-            break;
-        }
-    }
+    bool changed = false;
+    size_t runStart = next.points.size();
 
-    /**
-     * erase the end
-     */
-    for (GList* l = g_list_last(part->getPoints()); l != nullptr;) {
-        auto* p = static_cast<Point*>(l->data);
-        l = l->prev;
-        if (p->x >= x1 && p->y >= y1 && p->x <= x2 && p->y <= y2) {
-            part->points = g_list_remove(part->points, p);
-            delete p;
-            changed = true;
-        } else {
-            // only the end is handled here
-            break;
+    // Each run of points which are not erased becomes a part, the first one keeps the split size
+    auto endRun = [&]() {
+        if (next.points.size() == runStart) {
+            return;
         }
-    }
 
-    /**
-     * handle the rest
-     */
+        EraseableStrokePart newPart(runStart, next.points.size(), part.width, splitSize);
+        newPart.calcSize(next.points);
+        next.parts.push_back(newPart);
 
-    GList* lists = nullptr;
-    GList* current = nullptr;
+        runStart = next.points.size();
+        splitSize = 0;
+    };
 
-    for (GList* l = part->points; l != nullptr;) {
-        auto* p = static_cast<Point*>(l->data);
-        l = l->next;
+    for (const Point* p = begin; p != end; p++) {
         if (p->x >= x1 && p->y >= y1 && p->x <= x2 && p->y <= y2) {
-            part->points = g_list_remove(part->points, p);
-            delete p;
-            if (current) {
-                lists = g_list_append(lists, current);
-                current = nullptr;
-            }
+            endRun();
             changed = true;
         } else {
-            current = g_list_append(current, p);
-        }
-    }
-
-    if (current) {
-        lists = g_list_append(lists, current);
-        current = nullptr;
-    }
-
-    g_list_free(part->points);
-    part->points = nullptr;
-    if (lists) {
-        part->points = static_cast<GList*>(lists->data);
-        lists = g_list_delete_link(lists, lists);
-
-        int pos = g_list_index(list->data, part) + 1;
-
-        // create data structure for all new (splitted) parts
-        for (GList* l = lists; l != nullptr; l = l->next) {
-            auto* newPart = new EraseableStrokePart(part->width);
-            newPart->points = static_cast<GList*>(l->data);
-            list->data = g_list_insert(list->data, newPart, pos++);
+            next.points.push_back(*p);
         }
-
-        g_list_free(lists);
-    } else {
-        // no parts, all deleted
-        list->data = g_list_remove(list->data, part);
-        *deleteStrokeAfter = true;
     }
+    endRun();
 
     return changed;
 }
@@ -295,18 +261,23 @@ auto EraseableStroke::erasePart(double x, double y, double halfEraserSize, Erase
 auto EraseableStroke::getStroke(Stroke* original) -> GList* {
     GList* list = nullptr;
 
+    // Also called by the render jobs while erasing
+    g_mutex_lock(&this->partLock);
+    std::shared_ptr<PartList> current = this->parts;
+    g_mutex_unlock(&this->partLock);
+
+    std::vector<Point> const& points = current->points;
+
     Stroke* s = nullptr;
     Point lastPoint(NAN, NAN);
-    for (GList* l = this->parts->data; l != nullptr; l = l->next) {
-        auto* p = static_cast<EraseableStrokePart*>(l->data);
-        GList* points = p->getPoints();
-        if (g_list_length(points) < 2) {
+    for (EraseableStrokePart const& p: current->parts) {
+        if (p.getPointCount() < 2) {
             continue;
         }
 
-        Point a = *(static_cast<Point*>(g_list_first(points)->data));
-        Point b = *(static_cast<Point*>(g_list_last(points)->data));
-        a.z = p->width;
+        Point a = points[p.first];
+        Point b = points[p.end - 1];
+        a.z = p.width;
 
         if (!lastPoint.equalsPos(a) || s == nullptr) {
             if (s) {
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -41,15 +42,46 @@ public:
     void draw(cairo_t* cr);
 
 private:
-    void erase(double x, double y, double halfEraserSize, EraseableStrokePart* part, PartList* list);
-    static bool erasePart(double x, double y, double halfEraserSize, EraseableStrokePart* part, PartList* list,
-                          bool* deleteStrokeAfter);
+    enum class Hit { NONE, PART, POINTS };
+
+    /**
+     * Tests the first and the last point of the part
+     */
+    static Hit hitTest(double x, double y, double halfEraserSize, EraseableStrokePart const& part,
+                       std::vector<Point> const& points);
+
+    /**
+     * Adds the points of part which are not erased to next, split into one part for each run of points
+     *
+     * @return true if a point was erased
+     */
+    bool erasePart(double x, double y, double halfEraserSize, EraseableStrokePart const& part,
+                   std::vector<Point> const& points, PartList& next);
+
+    /**
+     * @return a list which isn't used by the render threads anymore, for the next erase
+     */
+    std::shared_ptr<PartList> takeSpare();
 
     void addRepaintRect(double x, double y, double width, double height);
 
 private:
+    /**
+     * Protects parts, which is replaced by erase() and read by the render threads.
+     * A published list is never changed, so the render threads draw it without the lock.
+     */
     GMutex partLock{};
-    PartList* parts = nullptr;
+    std::shared_ptr<PartList> parts;
+
+    /**
+     * The list replaced by the last erase, its memory is reused
+     */
+    std::shared_ptr<PartList> spare;
+
+    /**
+     * The points of the part which is erased, including the split points
+     */
+    std::vector<Point> splitPoints;
 
     Range* repaintRect = nullptr;
 
@@ -1,34 +1,12 @@
 #include "EraseableStrokePart.h"
 
-EraseableStrokePart::EraseableStrokePart(Point a, Point b) {
-    addPoint(a);
-    addPoint(b);
-    this->width = a.z;
+#include <algorithm>
 
-    this->splitSize = 0;
+EraseableStrokePart::EraseableStrokePart(size_t first, size_t end, double width, double splitSize):
+        first(first), end(end), width(width), splitSize(splitSize) {}
 
-    calcSize();
-}
-
-EraseableStrokePart::EraseableStrokePart(double width) {
-    this->points = nullptr;
-    this->width = width;
-    this->splitSize = 0;
-
-    calcSize();
-}
-
-EraseableStrokePart::~EraseableStrokePart() {
-    for (GList* l = this->points; l != nullptr; l = l->next) {
-        auto* p = static_cast<Point*>(l->data);
-        delete p;
-    }
-    g_list_free(this->points);
-    this->points = nullptr;
-}
-
-void EraseableStrokePart::calcSize() {
-    if (this->points == nullptr) {
+void EraseableStrokePart::calcSize(std::vector<Point> const& points) {
+    if (this->first == this->end) {
         this->x = 0;
         this->y = 0;
         this->elementWidth = 0;
@@ -36,17 +14,16 @@ void EraseableStrokePart::calcSize() {
         return;
     }
 
-    double x1 = (static_cast<Point*>(g_list_first(this->points)->data))->x;
-    double y1 = (static_cast<Point*>(g_list_first(this->points)->data))->y;
-    double x2 = (static_cast<Point*>(g_list_first(this->points)->data))->x;
-    double y2 = (static_cast<Point*>(g_list_first(this->points)->data))->y;
+    double x1 = points[this->first].x;
+    double y1 = points[this->first].y;
+    double x2 = x1;
+    double y2 = y1;
 
-    for (GList* l = this->points; l != nullptr; l = l->next) {
-        auto* p = static_cast<Point*>(l->data);
-        x1 = std::min(x1, p->x);
-        x2 = std::max(x2, p->x);
-        y1 = std::min(y1, p->y);
-        y2 = std::max(y2, p->y);
+    for (size_t i = this->first + 1; i < this->end; i++) {
+        x1 = std::min(x1, points[i].x);
+        x2 = std::max(x2, points[i].x);
+        y1 = std::min(y1, points[i].y);
+        y2 = std::max(y2, points[i].y);
     }
 
     this->x = x1;
@@ -55,18 +32,13 @@ void EraseableStrokePart::calcSize() {
     this->elementHeight = y2 - y1;
 }
 
-auto EraseableStrokePart::clone() -> EraseableStrokePart* {
-    auto* part = new EraseableStrokePart(this->width);
+auto EraseableStrokePart::getFirst() const -> size_t { return this->first; }
 
-    for (GList* l = this->points; l != nullptr; l = l->next) {
-        auto* p = static_cast<Point*>(l->data);
-        part->addPoint(*p);
-    }
+auto EraseableStrokePart::getEnd() const -> size_t { return this->end; }
 
-    part->splitSize = this->splitSize;
+auto EraseableStrokePart::getPointCount() const -> size_t { return this->end - this->first; }
 
-    return part;
-}
+auto EraseableStrokePart::getWidth() const -> double { return this->width; }
 
 auto EraseableStrokePart::getX() const -> double { return this->x; }
 
@@ -75,50 +47,3 @@ auto EraseableStrokePart::getY() const -> double { return this->y; }
 auto EraseableStrokePart::getElementWidth() const -> double { return this->elementWidth; }
 
 auto EraseableStrokePart::getElementHeight() const -> double { return this->elementHeight; }
-
-void EraseableStrokePart::addPoint(Point p) {
-    calcSize();
-
-    this->points = g_list_append(this->points, new Point(p));
-}
-
-auto EraseableStrokePart::getWidth() const -> double { return this->width; }
-
-auto EraseableStrokePart::getPoints() -> GList* { return this->points; }
-
-void EraseableStrokePart::clearSplitData() {
-    for (GList* l = this->points->next; l->next != nullptr;) {
-        auto* p = static_cast<Point*>(l->data);
-        delete p;
-        GList* link = l;
-        l = l->next;
-
-        this->points = g_list_delete_link(this->points, link);
-    }
-}
-
-void EraseableStrokePart::splitFor(double halfEraserSize) {
-    if (halfEraserSize == this->splitSize) {
-        return;
-    }
-
-    this->splitSize = halfEraserSize;
-
-    auto* a = static_cast<Point*>(g_list_first(this->points)->data);
-    auto* b = static_cast<Point*>(g_list_last(this->points)->data);
-
-    // nothing to do, the size is enough small
-    if (a->lineLengthTo(*b) <= halfEraserSize) {
-        return;
-    }
-
-    clearSplitData();
-
-    double len = a->lineLengthTo(*b);
-    halfEraserSize /= 2;
-
-    while (len > halfEraserSize) {
-        this->points = g_list_insert(this->points, new Point(a->lineTo(*b, len)), 1);
-        len -= halfEraserSize;
-    }
-}
@@ -11,34 +11,31 @@
 
 #pragma once
 
-#include <string>
+#include <cstddef>
 #include <vector>
 
 #include "model/Point.h"
 
 #include "XournalType.h"
 
+/**
+ * A part is a range of the points of its PartList
+ */
 class EraseableStrokePart {
 public:
-    EraseableStrokePart(Point a, Point b);
-    EraseableStrokePart(double width);
-    virtual ~EraseableStrokePart();
-
-private:
-    EraseableStrokePart(const EraseableStrokePart& part);
+    EraseableStrokePart(size_t first, size_t end, double width, double splitSize = 0);
 
 public:
-    void addPoint(Point p);
-    double getWidth() const;
-
-    GList* getPoints();
-
-    void clearSplitData();
-    void splitFor(double halfEraserSize);
+    size_t getFirst() const;
+    size_t getEnd() const;
+    size_t getPointCount() const;
 
-    EraseableStrokePart* clone();
+    double getWidth() const;
 
-    void calcSize();
+    /**
+     * Calculates the bounds of the points first until end
+     */
+    void calcSize(std::vector<Point> const& points);
 
 public:
     double getX() const;
@@ -46,13 +43,19 @@ public:
     double getElementWidth() const;
     double getElementHeight() const;
 
-    static void printDebugStrokeParts();
-
 private:
+    /**
+     * The points first until (excluding) end
+     */
+    size_t first = 0;
+    size_t end = 0;
+
     double width = 0;
-    double splitSize = 0;
 
-    GList* points = nullptr;
+    /**
+     * The half eraser size the part is split for, 0 if it's not split
+     */
+    double splitSize = 0;
 
     double x = 0;
     double y = 0;
@@ -60,4 +63,5 @@ private:
     double elementHeight = 0;
 
     friend class EraseableStroke;
+    friend class PartList;
 };
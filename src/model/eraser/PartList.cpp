@@ -1,26 +1,23 @@
 #include "PartList.h"
 
-#include "EraseableStrokePart.h"
-
 PartList::PartList() = default;
 
-PartList::~PartList() {
-    for (GList* l = this->data; l != nullptr; l = l->next) {
-        auto* p = static_cast<EraseableStrokePart*>(l->data);
-        delete p;
-    }
-    g_list_free(this->data);
-    this->data = nullptr;
-}
+PartList::~PartList() = default;
 
-void PartList::add(EraseableStrokePart* part) { this->data = g_list_append(this->data, part); }
+void PartList::clear() {
+    this->points.clear();
+    this->parts.clear();
+}
 
-auto PartList::clone() -> PartList* {
-    auto* list = new PartList();
-    for (GList* l = this->data; l != nullptr; l = l->next) {
-        auto* p = static_cast<EraseableStrokePart*>(l->data);
-        list->data = g_list_append(list->data, p->clone());
-    }
+void PartList::addCopy(PartList const& other, EraseableStrokePart const& part) {
+    EraseableStrokePart copy = part;
+    copy.first = this->points.size();
+    this->points.insert(this->points.end(), other.points.begin() + part.first, other.points.begin() + part.end);
+    copy.end = this->points.size();
 
-    return list;
+    this->parts.push_back(copy);
 }
+
+auto PartList::getPoints() const -> std::vector<Point> const& { return this->points; }
+
+auto PartList::getParts() const -> std::vector<EraseableStrokePart> const& { return this->parts; }
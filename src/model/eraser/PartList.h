@@ -11,15 +11,17 @@
 
 #pragma once
 
-#include <string>
+#include <cstddef>
 #include <vector>
 
-#include <gtk/gtk.h>
+#include "model/Point.h"
 
+#include "EraseableStrokePart.h"
 #include "XournalType.h"
 
-class EraseableStrokePart;
-
+/**
+ * The points of all parts in one array, each part is a range of it
+ */
 class PartList {
 public:
     PartList();
@@ -30,11 +32,22 @@ private:
     void operator=(const PartList& list);
 
 public:
-    void add(EraseableStrokePart* part);
-    PartList* clone();
+    /**
+     * Removes all parts, but keeps the memory for reuse
+     */
+    void clear();
+
+    /**
+     * Adds a part with the points first until end of another list
+     */
+    void addCopy(PartList const& other, EraseableStrokePart const& part);
+
+    std::vector<Point> const& getPoints() const;
+    std::vector<EraseableStrokePart> const& getParts() const;
 
 private:
-    GList* data = nullptr;
+    std::vector<Point> points;
+    std::vector<EraseableStrokePart> parts;
 
     friend class EraseableStroke;
 };
@@ -41,6 +41,9 @@ public:
     virtual double getWidth() = 0;
     virtual double getHeight() = 0;
 
+    /**
+     * Can be called from several threads, the pages of one document are rendered one at a time
+     */
     virtual void render(cairo_t* cr, bool forPrinting = false) = 0;
 
     virtual vector<XojPdfRectangle> findText(string& text) = 0;
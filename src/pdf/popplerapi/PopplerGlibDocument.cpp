@@ -8,6 +8,32 @@
 #include "Util.h"
 #include "filesystem.h"
 
+static const char* ATTACH_RENDER_MUTEX = "XOJ_RENDER_MUTEX";
+
+static void freeRenderMutex(gpointer data) {
+    auto* mutex = static_cast<GMutex*>(data);
+    g_mutex_clear(mutex);
+    g_free(mutex);
+}
+
+/**
+ * Poppler can't render several pages of one document at once, so all pages of a document share a mutex.
+ * It's attached to the PopplerDocument, which is kept alive by its pages.
+ */
+static auto getRenderMutex(PopplerDocument* document) -> GMutex* {
+    static GMutex attachMutex;
+
+    g_mutex_lock(&attachMutex);
+    auto* mutex = static_cast<GMutex*>(g_object_get_data(G_OBJECT(document), ATTACH_RENDER_MUTEX));
+    if (mutex == nullptr) {
+        mutex = g_new(GMutex, 1);
+        g_mutex_init(mutex);
+        g_object_set_data_full(G_OBJECT(document), ATTACH_RENDER_MUTEX, mutex, freeRenderMutex);
+    }
+    g_mutex_unlock(&attachMutex);
+
+    return mutex;
+}
 
 PopplerGlibDocument::PopplerGlibDocument() = default;
 
@@ -84,7 +110,7 @@ auto PopplerGlibDocument::getPage(size_t page) -> XojPdfPageSPtr {
     }
 
     PopplerPage* pg = poppler_document_get_page(document, page);
-    XojPdfPageSPtr pageptr = std::make_shared<PopplerGlibPage>(pg);
+    XojPdfPageSPtr pageptr = std::make_shared<PopplerGlibPage>(pg, getRenderMutex(document));
     g_object_unref(pg);
 
     return pageptr;
@@ -1,13 +1,13 @@
 #include "PopplerGlibPage.h"
 
 
-PopplerGlibPage::PopplerGlibPage(PopplerPage* page): page(page) {
+PopplerGlibPage::PopplerGlibPage(PopplerPage* page, GMutex* renderMutex): page(page), renderMutex(renderMutex) {
     if (page != nullptr) {
         g_object_ref(page);
     }
 }
 
-PopplerGlibPage::PopplerGlibPage(const PopplerGlibPage& other): page(other.page) {
+PopplerGlibPage::PopplerGlibPage(const PopplerGlibPage& other): page(other.page), renderMutex(other.renderMutex) {
     if (page != nullptr) {
         g_object_ref(page);
     }
@@ -30,6 +30,7 @@ PopplerGlibPage& PopplerGlibPage::operator=(const PopplerGlibPage& other) {
     }
 
     page = other.page;
+    renderMutex = other.renderMutex;
     if (page != nullptr) {
         g_object_ref(page);
     }
@@ -52,11 +53,13 @@ auto PopplerGlibPage::getHeight() -> double {
 
 void PopplerGlibPage::render(cairo_t* cr, bool forPrinting)  // NOLINT(google-default-arguments)
 {
+    g_mutex_lock(this->renderMutex);
     if (forPrinting) {
         poppler_page_render_for_printing(page, cr);
     } else {
         poppler_page_render(page, cr);
     }
+    g_mutex_unlock(this->renderMutex);
 }
 
 auto PopplerGlibPage::getPageId() -> int { return poppler_page_get_index(page); }
@@ -65,7 +68,9 @@ auto PopplerGlibPage::findText(string& text) -> vector<XojPdfRectangle> {
     vector<XojPdfRectangle> findings;
 
     double height = getHeight();
+    g_mutex_lock(this->renderMutex);
     GList* matches = poppler_page_find_text(page, text.c_str());
+    g_mutex_unlock(this->renderMutex);
 
     for (GList* l = matches; l && l->data; l = g_list_next(l)) {
         auto* rect = static_cast<PopplerRectangle*>(l->data);
@@ -18,7 +18,10 @@
 
 class PopplerGlibPage: public XojPdfPage {
 public:
-    PopplerGlibPage(PopplerPage* page);
+    /**
+     * @param renderMutex Shared by all pages of the document, held while the page is rendered or searched
+     */
+    PopplerGlibPage(PopplerPage* page, GMutex* renderMutex);
     PopplerGlibPage(const PopplerGlibPage& other);
     virtual ~PopplerGlibPage();
     PopplerGlibPage& operator=(const PopplerGlibPage& other);
@@ -35,4 +38,5 @@ public:
 
 private:
     PopplerPage* page;
+    GMutex* renderMutex;
 };
@@ -4,6 +4,8 @@
 #include <cinttypes>
 
 #include "control/Control.h"
+#include "model/Layer.h"
+#include "model/XojPage.h"
 
 #include "XojMsgBox.h"
 #include "config.h"
@@ -88,6 +90,20 @@ void UndoRedoHandler::clearRedo() {
     printContents();
 }
 
+/**
+ * Undo actions may change elements in place, e.g. their color, so the cached renderings of all layers are outdated
+ */
+static void markLayersModified(vector<PageRef> const& pages) {
+    for (PageRef const& page: pages) {
+        if (!page) {
+            continue;
+        }
+        for (Layer* l: *page->getLayers()) {
+            l->markModified();
+        }
+    }
+}
+
 void UndoRedoHandler::undo() {
     if (this->undoList.empty()) {
         return;
@@ -102,6 +118,7 @@ void UndoRedoHandler::undo() {
     Document* doc = control->getDocument();
     doc->lock();
     bool undoResult = undoAction.undo(this->control);
+    markLayersModified(undoAction.getPages());
     doc->unlock();
 
     if (!undoResult) {
@@ -131,6 +148,7 @@ void UndoRedoHandler::redo() {
     Document* doc = control->getDocument();
     doc->lock();
     bool redoResult = redoAction.redo(this->control);
+    markLayersModified(redoAction.getPages());
     doc->unlock();
 
     if (!redoResult) {
@@ -0,0 +1,378 @@
+#include "HitTest.h"
+
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HIT_TEST_X86
+#include <immintrin.h>
+#endif
+
+namespace HitTest {
+
+/**
+ * Covers the rounding differences to the exact segment test, which uses hypot()
+ */
+constexpr double CANDIDATE_SLACK = 1e-6;
+
+static auto detectIsa() -> Isa {
+#ifdef HIT_TEST_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return Isa::SSE2;
+    }
+#endif
+    return Isa::SCALAR;
+}
+
+static const Isa supportedIsa = detectIsa();
+static Isa activeIsa = supportedIsa;
+
+auto getIsa() -> Isa { return activeIsa; }
+
+auto setIsa(Isa isa) -> bool {
+    if (static_cast<int>(isa) > static_cast<int>(supportedIsa)) {
+        return false;
+    }
+
+    activeIsa = isa;
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+// Scalar, also used for the points which don't fill a vector
+
+static auto allInBoxScalar(const double* xs, const double* ys, size_t count, double x1, double y1, double x2,
+                           double y2) -> bool {
+    for (size_t i = 0; i < count; i++) {
+        if (xs[i] < x1 || xs[i] > x2 || ys[i] < y1 || ys[i] > y2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static auto nextSegmentCandidateScalar(const double* xs, const double* ys, size_t from, size_t end, double x,
+                                       double y, double h, double padding) -> size_t {
+    double hDiagonal = h * std::sqrt(2);
+    for (size_t i = from; i < end; i++) {
+        double px = xs[i];
+        double py = ys[i];
+        if (px >= x - h && py >= y - h && px <= x + h && py <= y + h) {
+            return i;
+        }
+
+        double dx = px - xs[i - 1];
+        double dy = py - ys[i - 1];
+        double len = std::sqrt(dx * dx + dy * dy);
+        double cx = x - (xs[i - 1] + px) * 0.5;
+        double cy = y - (ys[i - 1] + py) * 0.5;
+        if (std::sqrt(cx * cx + cy * cy) - hDiagonal <= len * 0.5 + padding + CANDIDATE_SLACK) {
+            return i;
+        }
+    }
+    return end;
+}
+
+static auto inPolygonScalar(double x, double y, std::vector<PolygonEdge> const& edges) -> bool {
+    bool inside = false;
+    for (PolygonEdge const& e: edges) {
+        if (x >= e.rightX || y < e.lowY || y >= e.highY) {
+            continue;
+        }
+        if (x < e.leftX || x - e.anchorX < (y - e.anchorY) / e.dy * e.dx) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+static auto allInPolygonScalar(const double* xs, const double* ys, size_t count,
+                               std::vector<PolygonEdge> const& edges) -> bool {
+    for (size_t i = 0; i < count; i++) {
+        if (!inPolygonScalar(xs[i], ys[i], edges)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef HIT_TEST_X86
+
+////////////////////////////////////////////////////////////
+// SSE2, two points at once
+
+__attribute__((target("sse2"))) static auto allInBoxSse2(const double* xs, const double* ys, size_t count,
+                                                          double x1, double y1, double x2, double y2) -> bool {
+    __m128d vx1 = _mm_set1_pd(x1);
+    __m128d vy1 = _mm_set1_pd(y1);
+    __m128d vx2 = _mm_set1_pd(x2);
+    __m128d vy2 = _mm_set1_pd(y2);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d px = _mm_loadu_pd(xs + i);
+        __m128d py = _mm_loadu_pd(ys + i);
+        __m128d outside = _mm_or_pd(_mm_or_pd(_mm_cmplt_pd(px, vx1), _mm_cmpgt_pd(px, vx2)),
+                                    _mm_or_pd(_mm_cmplt_pd(py, vy1), _mm_cmpgt_pd(py, vy2)));
+        if (_mm_movemask_pd(outside) != 0) {
+            return false;
+        }
+    }
+    return allInBoxScalar(xs + i, ys + i, count - i, x1, y1, x2, y2);
+}
+
+__attribute__((target("sse2"))) static auto nextSegmentCandidateSse2(const double* xs, const double* ys,
+                                                                      size_t from, size_t end, double x, double y,
+                                                                      double h, double padding) -> size_t {
+    __m128d vx = _mm_set1_pd(x);
+    __m128d vy = _mm_set1_pd(y);
+    __m128d vx1 = _mm_set1_pd(x - h);
+    __m128d vy1 = _mm_set1_pd(y - h);
+    __m128d vx2 = _mm_set1_pd(x + h);
+    __m128d vy2 = _mm_set1_pd(y + h);
+    __m128d half = _mm_set1_pd(0.5);
+    __m128d diagonal = _mm_set1_pd(h * std::sqrt(2));
+    __m128d reach = _mm_set1_pd(padding + CANDIDATE_SLACK);
+
+    size_t i = from;
+    for (; i + 2 <= end; i += 2) {
+        __m128d px = _mm_loadu_pd(xs + i);
+        __m128d py = _mm_loadu_pd(ys + i);
+        __m128d lx = _mm_loadu_pd(xs + i - 1);
+        __m128d ly = _mm_loadu_pd(ys + i - 1);
+
+        __m128d inBox = _mm_and_pd(_mm_and_pd(_mm_cmpge_pd(px, vx1), _mm_cmpge_pd(py, vy1)),
+                                   _mm_and_pd(_mm_cmple_pd(px, vx2), _mm_cmple_pd(py, vy2)));
+
+        __m128d dx = _mm_sub_pd(px, lx);
+        __m128d dy = _mm_sub_pd(py, ly);
+        __m128d len = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+        __m128d cx = _mm_sub_pd(vx, _mm_mul_pd(_mm_add_pd(lx, px), half));
+        __m128d cy = _mm_sub_pd(vy, _mm_mul_pd(_mm_add_pd(ly, py), half));
+        __m128d distance = _mm_sub_pd(_mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(cx, cx), _mm_mul_pd(cy, cy))), diagonal);
+        __m128d near = _mm_cmple_pd(distance, _mm_add_pd(_mm_mul_pd(len, half), reach));
+
+        int mask = _mm_movemask_pd(_mm_or_pd(inBox, near));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return nextSegmentCandidateScalar(xs, ys, i, end, x, y, h, padding);
+}
+
+__attribute__((target("sse2"))) static auto allInPolygonSse2(const double* xs, const double* ys, size_t count,
+                                                              std::vector<PolygonEdge> const& edges) -> bool {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d px = _mm_loadu_pd(xs + i);
+        __m128d py = _mm_loadu_pd(ys + i);
+        __m128d inside = _mm_setzero_pd();
+
+        for (PolygonEdge const& e: edges) {
+            __m128d skip = _mm_or_pd(_mm_cmpge_pd(px, _mm_set1_pd(e.rightX)),
+                                     _mm_or_pd(_mm_cmplt_pd(py, _mm_set1_pd(e.lowY)),
+                                               _mm_cmpge_pd(py, _mm_set1_pd(e.highY))));
+            __m128d test1 = _mm_sub_pd(px, _mm_set1_pd(e.anchorX));
+            __m128d test2 = _mm_mul_pd(_mm_div_pd(_mm_sub_pd(py, _mm_set1_pd(e.anchorY)), _mm_set1_pd(e.dy)),
+                                       _mm_set1_pd(e.dx));
+            __m128d crosses = _mm_or_pd(_mm_cmplt_pd(px, _mm_set1_pd(e.leftX)), _mm_cmplt_pd(test1, test2));
+            inside = _mm_xor_pd(inside, _mm_andnot_pd(skip, crosses));
+        }
+
+        if (_mm_movemask_pd(inside) != 0x3) {
+            return false;
+        }
+    }
+    return allInPolygonScalar(xs + i, ys + i, count - i, edges);
+}
+
+////////////////////////////////////////////////////////////
+// AVX2, four points at once
+
+__attribute__((target("avx2"))) static auto allInBoxAvx2(const double* xs, const double* ys, size_t count,
+                                                          double x1, double y1, double x2, double y2) -> bool {
+    __m256d vx1 = _mm256_set1_pd(x1);
+    __m256d vy1 = _mm256_set1_pd(y1);
+    __m256d vx2 = _mm256_set1_pd(x2);
+    __m256d vy2 = _mm256_set1_pd(y2);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d px = _mm256_loadu_pd(xs + i);
+        __m256d py = _mm256_loadu_pd(ys + i);
+        __m256d outside =
+                _mm256_or_pd(_mm256_or_pd(_mm256_cmp_pd(px, vx1, _CMP_LT_OQ), _mm256_cmp_pd(px, vx2, _CMP_GT_OQ)),
+                             _mm256_or_pd(_mm256_cmp_pd(py, vy1, _CMP_LT_OQ), _mm256_cmp_pd(py, vy2, _CMP_GT_OQ)));
+        if (_mm256_movemask_pd(outside) != 0) {
+            return false;
+        }
+    }
+    return allInBoxSse2(xs + i, ys + i, count - i, x1, y1, x2, y2);
+}
+
+__attribute__((target("avx2"))) static auto nextSegmentCandidateAvx2(const double* xs, const double* ys,
+                                                                      size_t from, size_t end, double x, double y,
+                                                                      double h, double padding) -> size_t {
+    __m256d vx = _mm256_set1_pd(x);
+    __m256d vy = _mm256_set1_pd(y);
+    __m256d vx1 = _mm256_set1_pd(x - h);
+    __m256d vy1 = _mm256_set1_pd(y - h);
+    __m256d vx2 = _mm256_set1_pd(x + h);
+    __m256d vy2 = _mm256_set1_pd(y + h);
+    __m256d half = _mm256_set1_pd(0.5);
+    __m256d diagonal = _mm256_set1_pd(h * std::sqrt(2));
+    __m256d reach = _mm256_set1_pd(padding + CANDIDATE_SLACK);
+
+    size_t i = from;
+    for (; i + 4 <= end; i += 4) {
+        __m256d px = _mm256_loadu_pd(xs + i);
+        __m256d py = _mm256_loadu_pd(ys + i);
+        __m256d lx = _mm256_loadu_pd(xs + i - 1);
+        __m256d ly = _mm256_loadu_pd(ys + i - 1);
+
+        __m256d inBox =
+                _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(px, vx1, _CMP_GE_OQ), _mm256_cmp_pd(py, vy1, _CMP_GE_OQ)),
+                              _mm256_and_pd(_mm256_cmp_pd(px, vx2, _CMP_LE_OQ), _mm256_cmp_pd(py, vy2, _CMP_LE_OQ)));
+
+        __m256d dx = _mm256_sub_pd(px, lx);
+        __m256d dy = _mm256_sub_pd(py, ly);
+        __m256d len = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+        __m256d cx = _mm256_sub_pd(vx, _mm256_mul_pd(_mm256_add_pd(lx, px), half));
+        __m256d cy = _mm256_sub_pd(vy, _mm256_mul_pd(_mm256_add_pd(ly, py), half));
+        __m256d distance =
+                _mm256_sub_pd(_mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(cx, cx), _mm256_mul_pd(cy, cy))), diagonal);
+        __m256d near = _mm256_cmp_pd(distance, _mm256_add_pd(_mm256_mul_pd(len, half), reach), _CMP_LE_OQ);
+
+        int mask = _mm256_movemask_pd(_mm256_or_pd(inBox, near));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return nextSegmentCandidateSse2(xs, ys, i, end, x, y, h, padding);
+}
+
+__attribute__((target("avx2"))) static auto allInPolygonAvx2(const double* xs, const double* ys, size_t count,
+                                                              std::vector<PolygonEdge> const& edges) -> bool {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d px = _mm256_loadu_pd(xs + i);
+        __m256d py = _mm256_loadu_pd(ys + i);
+        __m256d inside = _mm256_setzero_pd();
+
+        for (PolygonEdge const& e: edges) {
+            __m256d skip = _mm256_or_pd(_mm256_cmp_pd(px, _mm256_set1_pd(e.rightX), _CMP_GE_OQ),
+                                        _mm256_or_pd(_mm256_cmp_pd(py, _mm256_set1_pd(e.lowY), _CMP_LT_OQ),
+                                                     _mm256_cmp_pd(py, _mm256_set1_pd(e.highY), _CMP_GE_OQ)));
+            __m256d test1 = _mm256_sub_pd(px, _mm256_set1_pd(e.anchorX));
+            __m256d test2 = _mm256_mul_pd(
+                    _mm256_div_pd(_mm256_sub_pd(py, _mm256_set1_pd(e.anchorY)), _mm256_set1_pd(e.dy)),
+                    _mm256_set1_pd(e.dx));
+            __m256d crosses = _mm256_or_pd(_mm256_cmp_pd(px, _mm256_set1_pd(e.leftX), _CMP_LT_OQ),
+                                           _mm256_cmp_pd(test1, test2, _CMP_LT_OQ));
+            inside = _mm256_xor_pd(inside, _mm256_andnot_pd(skip, crosses));
+        }
+
+        if (_mm256_movemask_pd(inside) != 0xF) {
+            return false;
+        }
+    }
+    return allInPolygonSse2(xs + i, ys + i, count - i, edges);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////
+
+auto allInBox(const double* xs, const double* ys, size_t count, double x1, double y1, double x2, double y2)
+        -> bool {
+    switch (activeIsa) {
+#ifdef HIT_TEST_X86
+        case Isa::AVX2:
+            return allInBoxAvx2(xs, ys, count, x1, y1, x2, y2);
+        case Isa::SSE2:
+            return allInBoxSse2(xs, ys, count, x1, y1, x2, y2);
+#endif
+        default:
+            return allInBoxScalar(xs, ys, count, x1, y1, x2, y2);
+    }
+}
+
+auto nextSegmentCandidate(const double* xs, const double* ys, size_t from, size_t end, double x, double y, double h,
+                          double padding) -> size_t {
+    if (from >= end) {
+        return end;
+    }
+    if (from == 0) {
+        // The first point has no segment, which is left to the exact test
+        return 0;
+    }
+
+    switch (activeIsa) {
+#ifdef HIT_TEST_X86
+        case Isa::AVX2:
+            return nextSegmentCandidateAvx2(xs, ys, from, end, x, y, h, padding);
+        case Isa::SSE2:
+            return nextSegmentCandidateSse2(xs, ys, from, end, x, y, h, padding);
+#endif
+        default:
+            return nextSegmentCandidateScalar(xs, ys, from, end, x, y, h, padding);
+    }
+}
+
+auto polygonEdges(const double* xs, const double* ys, size_t count) -> std::vector<PolygonEdge> {
+    std::vector<PolygonEdge> edges;
+    if (count < 2) {
+        return edges;
+    }
+
+    edges.reserve(count);
+
+    // The polygon is closed by the edge from the last to the first point
+    double lastX = xs[count - 1];
+    double lastY = ys[count - 1];
+    for (size_t i = 0; i < count; lastX = xs[i], lastY = ys[i], i++) {
+        double curX = xs[i];
+        double curY = ys[i];
+        if (curY == lastY) {
+            continue;
+        }
+
+        PolygonEdge e{};
+        e.rightX = curX < lastX ? lastX : curX;
+        e.leftX = static_cast<int>(curX < lastX ? curX : lastX);
+        e.dx = lastX - curX;
+        e.dy = lastY - curY;
+        if (curY < lastY) {
+            e.lowY = curY;
+            e.highY = lastY;
+            e.anchorX = curX;
+            e.anchorY = curY;
+        } else {
+            e.lowY = lastY;
+            e.highY = curY;
+            e.anchorX = lastX;
+            e.anchorY = lastY;
+        }
+        edges.push_back(e);
+    }
+
+    return edges;
+}
+
+auto allInPolygon(const double* xs, const double* ys, size_t count, std::vector<PolygonEdge> const& edges) -> bool {
+    switch (activeIsa) {
+#ifdef HIT_TEST_X86
+        case Isa::AVX2:
+            return allInPolygonAvx2(xs, ys, count, edges);
+        case Isa::SSE2:
+            return allInPolygonSse2(xs, ys, count, edges);
+#endif
+        default:
+            return allInPolygonScalar(xs, ys, count, edges);
+    }
+}
+
+}  // namespace HitTest
@@ -0,0 +1,88 @@
+/*
+ * Xournal++
+ *
+ * Hit tests of many points at once, for the eraser and the selection
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * The points are given as separate x and y arrays and are tested several at once with SSE2 or AVX2,
+ * whichever the CPU supports. The results are the same as testing each point on its own.
+ */
+namespace HitTest {
+
+enum class Isa { SCALAR, SSE2, AVX2 };
+
+/**
+ * @return the instruction set used by the tests, the best one the CPU supports by default
+ */
+Isa getIsa();
+
+/**
+ * Selects the instruction set, for tests and benchmarks. An instruction set the CPU doesn't support is ignored.
+ *
+ * @return true if isa is used now
+ */
+bool setIsa(Isa isa);
+
+/**
+ * @return true if all points are in the rectangle x1, y1, x2, y2, including its border
+ */
+bool allInBox(const double* xs, const double* ys, size_t count, double x1, double y1, double x2, double y2);
+
+/**
+ * Finds the next point which may be hit by the eraser square of half size h around x, y: the point is in the
+ * square, or the segment from the previous point to it may pass the square. The candidates still have to be
+ * checked exactly, the others can't be hit. The first point is always a candidate.
+ *
+ * @param padding Added to the half length of a segment
+ * @return the first candidate in from until (excluding) end, or end if there is none
+ */
+size_t nextSegmentCandidate(const double* xs, const double* ys, size_t from, size_t end, double x, double y, double h,
+                            double padding);
+
+/**
+ * An edge of a polygon, prepared for the even-odd test
+ */
+struct PolygonEdge {
+    /**
+     * Points at the right of rightX or outside lowY until (excluding) highY don't cross the edge
+     */
+    double rightX;
+    double lowY;
+    double highY;
+
+    /**
+     * Points at the left of leftX cross the edge, leftX is rounded towards 0
+     */
+    double leftX;
+
+    /**
+     * The point of the edge at lowY, and the direction of the edge
+     */
+    double anchorX;
+    double anchorY;
+    double dx;
+    double dy;
+};
+
+/**
+ * The edges of the closed polygon through the points, horizontal edges are left out
+ */
+std::vector<PolygonEdge> polygonEdges(const double* xs, const double* ys, size_t count);
+
+/**
+ * @return true if all points are inside of the polygon, with the even-odd rule
+ */
+bool allInPolygon(const double* xs, const double* ys, size_t count, std::vector<PolygonEdge> const& edges);
+
+}  // namespace HitTest
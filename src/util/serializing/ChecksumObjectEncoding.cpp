@@ -0,0 +1,27 @@
+#include "ChecksumObjectEncoding.h"
+
+ChecksumObjectEncoding::ChecksumObjectEncoding() { this->checksum = g_checksum_new(G_CHECKSUM_SHA256); }
+
+ChecksumObjectEncoding::~ChecksumObjectEncoding() {
+    g_checksum_free(this->checksum);
+    if (this->data) {
+        g_string_free(this->data, true);
+    }
+}
+
+void ChecksumObjectEncoding::addData(const void* data, int len) {
+    flushStr();
+    g_checksum_update(this->checksum, static_cast<const guchar*>(data), len);
+}
+
+auto ChecksumObjectEncoding::getChecksum() -> std::string {
+    flushStr();
+    return g_checksum_get_string(this->checksum);
+}
+
+void ChecksumObjectEncoding::flushStr() {
+    if (this->data->len > 0) {
+        g_checksum_update(this->checksum, reinterpret_cast<const guchar*>(this->data->str), this->data->len);
+        g_string_truncate(this->data, 0);
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * Xournal++
+ *
+ * Serialized stream which is only hashed
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <string>
+
+#include "ObjectEncoding.h"
+
+/**
+ * Computes the SHA256 of the data instead of keeping it, to compare objects without storing their serialized form
+ */
+class ChecksumObjectEncoding: public ObjectEncoding {
+public:
+    ChecksumObjectEncoding();
+    virtual ~ChecksumObjectEncoding();
+
+public:
+    virtual void addData(const void* data, int len);
+
+    /**
+     * @return the checksum of all data written, as hex string. Nothing can be written afterwards.
+     */
+    std::string getChecksum();
+
+private:
+    /**
+     * Hashes the type markers collected by addStr() since the last call, so they stay in order with the data
+     */
+    void flushStr();
+
+private:
+    GChecksum* checksum = nullptr;
+};
@@ -69,24 +69,10 @@ void DocumentView::drawText(cairo_t* cr, Text* t) {
 }
 
 void DocumentView::drawImage(cairo_t* cr, Image* i) {
-    cairo_matrix_t defaultMatrix = {0};
-    cairo_get_matrix(cr, &defaultMatrix);
-
-    cairo_surface_t* img = i->getImage();
-    int width = cairo_image_surface_get_width(img);
-    int height = cairo_image_surface_get_height(img);
-
     cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
 
-    double xFactor = i->getElementWidth() / width;
-    double yFactor = i->getElementHeight() / height;
-
-    cairo_scale(cr, xFactor, yFactor);
-
-    cairo_set_source_surface(cr, img, i->getX() / xFactor, i->getY() / yFactor);
-    cairo_paint(cr);
-
-    cairo_set_matrix(cr, &defaultMatrix);
+    i->getMipmap().paint(cr, i->getX(), i->getY(), i->getElementWidth(), i->getElementHeight(), i->getImage(),
+                         [i]() { return i->loadImage(); });
 }
 
 void DocumentView::drawTexImage(cairo_t* cr, TexImage* texImage) {
@@ -96,37 +82,38 @@ void DocumentView::drawTexImage(cairo_t* cr, TexImage* texImage) {
     PopplerDocument* pdf = texImage->getPdf();
     cairo_surface_t* img = texImage->getImage();
 
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+
     if (pdf != nullptr) {
         if (poppler_document_get_n_pages(pdf) < 1) {
             g_warning("Got latex PDf without pages!: %s", texImage->getText().c_str());
             return;
         }
 
-        PopplerPage* page = poppler_document_get_page(pdf, 0);
-
-        double pageWidth = 0;
-        double pageHeight = 0;
-        poppler_page_get_size(page, &pageWidth, &pageHeight);
-
-        double xFactor = texImage->getElementWidth() / pageWidth;
-        double yFactor = texImage->getElementHeight() / pageHeight;
-
-        cairo_translate(cr, texImage->getX(), texImage->getY());
-        cairo_scale(cr, xFactor, yFactor);
-        poppler_page_render(page, cr);
-    } else if (img != nullptr) {
-        int width = cairo_image_surface_get_width(img);
-        int height = cairo_image_surface_get_height(img);
+        auto renderPdf = [pdf, texImage](cairo_t* crTex) {
+            PopplerPage* page = poppler_document_get_page(pdf, 0);
 
-        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+            double pageWidth = 0;
+            double pageHeight = 0;
+            poppler_page_get_size(page, &pageWidth, &pageHeight);
 
-        double xFactor = texImage->getElementWidth() / width;
-        double yFactor = texImage->getElementHeight() / height;
+            double xFactor = texImage->getElementWidth() / pageWidth;
+            double yFactor = texImage->getElementHeight() / pageHeight;
 
-        cairo_scale(cr, xFactor, yFactor);
+            cairo_scale(crTex, xFactor, yFactor);
+            poppler_page_render(page, crTex);
+            g_object_unref(page);
+        };
 
-        cairo_set_source_surface(cr, img, texImage->getX() / xFactor, texImage->getY() / yFactor);
-        cairo_paint(cr);
+        if (!texImage->getRenderCache().paint(cr, texImage->getX(), texImage->getY(), texImage->getElementWidth(),
+                                              texImage->getElementHeight(), renderPdf)) {
+            // Vector output for export and printing
+            cairo_translate(cr, texImage->getX(), texImage->getY());
+            renderPdf(cr);
+        }
+    } else if (img != nullptr) {
+        texImage->getMipmap().paint(cr, texImage->getX(), texImage->getY(), texImage->getElementWidth(),
+                                    texImage->getElementHeight(), img, nullptr);
     }
 
     cairo_set_matrix(cr, &defaultMatrix);
@@ -156,7 +143,19 @@ void DocumentView::drawLayer(cairo_t* cr, Layer* l) {
     int drawn = 0;
     int notDrawn = 0;
 #endif  // DEBUG_SHOW_REPAINT_BOUNDS
-    for (Element* e: *l->getElements()) {
+
+    // Only visit the elements near the repaint area, if there is one
+    vector<Element*> areaElements;
+    vector<Element*>* elements = l->getElements();
+    if (this->lX != -1) {
+        areaElements = l->getElementsInArea(this->lX, this->lY, this->lWidth, this->lHeight);
+        elements = &areaElements;
+#ifdef DEBUG_SHOW_REPAINT_BOUNDS
+        notDrawn += l->getElements()->size() - areaElements.size();
+#endif  // DEBUG_SHOW_REPAINT_BOUNDS
+    }
+
+    for (Element* e: *elements) {
 #ifdef DEBUG_SHOW_ELEMENT_BOUNDS
         cairo_set_source_rgb(cr, 0, 1, 0);
         cairo_set_line_width(cr, 1);
@@ -166,7 +165,7 @@ void DocumentView::drawLayer(cairo_t* cr, Layer* l) {
         // cairo_new_path(cr);
 
         if (this->lX != -1) {
-            if (e->intersectsArea(this->lX, this->lY, this->width, this->height)) {
+            if (e->intersectsArea(this->lX, this->lY, this->lWidth, this->lHeight)) {
                 drawElement(cr, e);
 #ifdef DEBUG_SHOW_REPAINT_BOUNDS
                 drawn++;
@@ -192,23 +191,21 @@ void DocumentView::drawLayer(cairo_t* cr, Layer* l) {
 }
 
 void DocumentView::paintBackgroundImage() {
-    GdkPixbuf* pixbuff = page->getBackgroundImage().getPixbuf();
+    BackgroundImage& backgroundImage = page->getBackgroundImage();
+    GdkPixbuf* pixbuff = backgroundImage.getPixbuf();
     if (pixbuff) {
-        cairo_matrix_t matrix = {0};
-        cairo_get_matrix(cr, &matrix);
-
-        int width = gdk_pixbuf_get_width(pixbuff);
-        int height = gdk_pixbuf_get_height(pixbuff);
-
-        double sx = page->getWidth() / width;
-        double sy = page->getHeight() / height;
-
-        cairo_scale(cr, sx, sy);
-
-        gdk_cairo_set_source_pixbuf(cr, pixbuff, 0, 0);
-        cairo_paint(cr);
-
-        cairo_set_matrix(cr, &matrix);
+        backgroundImage.getMipmap()->paint(cr, 0, 0, page->getWidth(), page->getHeight(), nullptr, [pixbuff]() {
+            int width = gdk_pixbuf_get_width(pixbuff);
+            int height = gdk_pixbuf_get_height(pixbuff);
+
+            cairo_surface_t* img = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+            cairo_t* crImg = cairo_create(img);
+            gdk_cairo_set_source_pixbuf(crImg, pixbuff, 0, 0);
+            cairo_paint(crImg);
+            cairo_destroy(crImg);
+
+            return img;
+        });
     }
 }
 
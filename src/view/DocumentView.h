@@ -88,6 +88,11 @@ public:
      */
     void drawLayer(cairo_t* cr, Layer* l);
 
+    /**
+     * Draw a single element, without checking the area limit
+     */
+    void drawElement(cairo_t* cr, Element* e) const;
+
     /**
      * Last step in drawing
      */
@@ -98,8 +103,6 @@ private:
     static void drawImage(cairo_t* cr, Image* i);
     static void drawTexImage(cairo_t* cr, TexImage* texImage);
 
-    void drawElement(cairo_t* cr, Element* e) const;
-
     void paintBackgroundImage();
 
 private:
@@ -8,11 +8,12 @@ PdfView::PdfView() = default;
 
 PdfView::~PdfView() = default;
 
-void PdfView::drawPage(PdfCache* cache, const XojPdfPageSPtr& popplerPage, cairo_t* cr, double zoom, double width,
-                       double height, bool forPrinting) {
+auto PdfView::drawPage(PdfCache* cache, const XojPdfPageSPtr& popplerPage, cairo_t* cr, double zoom, double width,
+                       double height, bool forPrinting, bool allowApproximation) -> bool {
+    bool exact = true;
     if (popplerPage) {
         if (cache && !forPrinting) {
-            cache->render(cr, popplerPage, zoom);
+            exact = cache->render(cr, popplerPage, zoom, allowApproximation);
         } else {
             popplerPage->render(cr, forPrinting);
         }
@@ -35,4 +36,5 @@ void PdfView::drawPage(PdfCache* cache, const XojPdfPageSPtr& popplerPage, cairo
         cairo_move_to(cr, width / 2 - extents.width / 2, height / 2 - extents.height / 2);
         cairo_show_text(cr, strMissing.c_str());
     }
+    return exact;
 }
@@ -22,6 +22,10 @@ private:
     virtual ~PdfView();
 
 public:
-    static void drawPage(PdfCache* cache, const XojPdfPageSPtr& popplerPage, cairo_t* cr, double zoom, double width,
-                         double height, bool forPrinting = false);
+    /**
+     * @param allowApproximation Paint another cached resolution scaled, if the page is not cached with this zoom
+     * @return false if another resolution was painted
+     */
+    static bool drawPage(PdfCache* cache, const XojPdfPageSPtr& popplerPage, cairo_t* cr, double zoom, double width,
+                         double height, bool forPrinting = false, bool allowApproximation = false);
 };
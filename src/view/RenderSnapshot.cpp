@@ -0,0 +1,96 @@
+#include "RenderSnapshot.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "model/Document.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "model/eraser/EraseableStroke.h"
+
+#include "DocumentView.h"
+
+RenderSnapshot::RenderSnapshot(PageRef page, size_t firstLayer, size_t endLayer, double x, double y, double width,
+                               double height):
+        page(std::move(page)) {
+    std::vector<Layer*> const& layers = *this->page->getLayers();
+    for (size_t i = firstLayer; i < endLayer && i < layers.size(); i++) {
+        Layer* l = layers[i];
+        if (!l->isVisible()) {
+            continue;
+        }
+
+        for (Element* e: l->getElementsInArea(x, y, width, height)) {
+            if (!e->intersectsArea(x, y, width, height)) {
+                continue;
+            }
+
+            Item item{l, e, {}};
+            if (e->getType() == ELEMENT_STROKE) {
+                auto* s = dynamic_cast<Stroke*>(e);
+                if (EraseableStroke* eraseable = s->getEraseable()) {
+                    // The eraser changes the parts without the document lock
+                    GList* parts = eraseable->getStroke(s);
+                    for (GList* p = parts; p != nullptr; p = p->next) {
+                        item.copies.emplace_back(static_cast<Stroke*>(p->data));
+                    }
+                    g_list_free(parts);
+
+                    if (item.copies.empty()) {
+                        continue;
+                    }
+                } else {
+                    item.copies.emplace_back(s->cloneStroke());
+                }
+            }
+
+            this->items.push_back(std::move(item));
+        }
+    }
+}
+
+RenderSnapshot::~RenderSnapshot() = default;
+
+auto RenderSnapshot::isEmpty() const -> bool { return this->items.empty(); }
+
+auto RenderSnapshot::isOnPage(Item const& item) const -> bool {
+    // Only the pointers are compared, the layer or the element may be freed already
+    std::vector<Layer*> const& layers = *this->page->getLayers();
+    if (std::find(layers.begin(), layers.end(), item.layer) == layers.end()) {
+        return false;
+    }
+    return item.layer->indexOf(item.original) != Layer::InvalidElementIndex;
+}
+
+void RenderSnapshot::draw(cairo_t* cr, DocumentView& view, Document* doc) {
+    Layer* currentLayer = nullptr;
+    auto startLayer = [&](Item const& item) {
+        // Like DocumentView::drawLayer()
+        if (item.layer != currentLayer) {
+            cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+            currentLayer = item.layer;
+        }
+    };
+
+    for (size_t i = 0; i < this->items.size();) {
+        Item const& item = this->items[i];
+        if (!item.copies.empty()) {
+            startLayer(item);
+            for (auto const& s: item.copies) {
+                view.drawStroke(cr, s.get());
+            }
+            i++;
+            continue;
+        }
+
+        // Consecutive texts and images are drawn with one lock
+        doc->lock();
+        for (; i < this->items.size() && this->items[i].copies.empty(); i++) {
+            startLayer(this->items[i]);
+            if (isOnPage(this->items[i])) {
+                view.drawElement(cr, this->items[i].original);
+            }
+        }
+        doc->unlock();
+    }
+}
@@ -0,0 +1,84 @@
+/*
+ * Xournal++
+ *
+ * A copy of the strokes of a page area, drawn without the document lock
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <gtk/gtk.h>
+
+#include "model/PageRef.h"
+
+class Document;
+class DocumentView;
+class Element;
+class Layer;
+class Stroke;
+
+/**
+ * Strokes are copied while the document is locked, so the page can be edited while they are drawn.
+ * A copy shares the points and the render cache with the original stroke until the original is changed.
+ * Texts and images are cheap to draw but expensive to copy, they are drawn from the original element
+ * with the document locked again shortly, if they are still on their layer.
+ *
+ * If the page changes meanwhile, the changed area is rerendered afterwards anyway.
+ */
+class RenderSnapshot {
+public:
+    /**
+     * Copies the elements of the visible layers firstLayer up to (excluding) endLayer which intersect
+     * the area in page coordinates, has to be called with the document locked
+     */
+    RenderSnapshot(PageRef page, size_t firstLayer, size_t endLayer, double x, double y, double width,
+                   double height);
+    virtual ~RenderSnapshot();
+
+    RenderSnapshot(const RenderSnapshot&) = delete;
+    RenderSnapshot& operator=(const RenderSnapshot&) = delete;
+
+public:
+    /**
+     * Draws the elements in their order, without holding the document lock while drawing the strokes
+     *
+     * @param view Initialized with initDrawing() for cr
+     */
+    void draw(cairo_t* cr, DocumentView& view, Document* doc);
+
+    /**
+     * @return true if there are no elements to draw
+     */
+    bool isEmpty() const;
+
+private:
+    struct Item {
+        Layer* layer;
+
+        /**
+         * Only dereferenced with the document locked and after it was found on its layer
+         */
+        Element* original;
+
+        /**
+         * The copy of a stroke, several parts if it's being erased. Empty for other elements.
+         */
+        std::vector<std::unique_ptr<Stroke>> copies;
+    };
+
+    /**
+     * @return true if the original element of the item still exists, called with the document locked
+     */
+    bool isOnPage(Item const& item) const;
+
+private:
+    PageRef page;
+    std::vector<Item> items;
+};
@@ -1,5 +1,9 @@
 #include "StrokeView.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "model/Stroke.h"
 #include "model/eraser/EraseableStroke.h"
 #include "util/LoopUtil.h"
@@ -7,14 +11,50 @@
 #include "DocumentView.h"
 
 StrokeView::StrokeView(cairo_t* cr, Stroke* s, int startPoint, double scaleFactor, bool noAlpha):
-        cr(cr), s(s), startPoint(startPoint), scaleFactor(scaleFactor), noAlpha(noAlpha) {}
+        cr(cr), s(s), startPoint(startPoint), scaleFactor(scaleFactor), noAlpha(noAlpha) {
+    // Points closer together than a device pixel are not needed at small zoom levels
+    double dx = 1;
+    double dy = 0;
+    cairo_user_to_device_distance(cr, &dx, &dy);
+    this->level = StrokeRenderCache::getLevel(std::hypot(dx, dy));
 
+    if (this->level > 0) {
+        this->simplifiedPoints = s->getRenderCache().getSimplified(s->getPointStorage(), this->level);
+    }
+}
 
-void StrokeView::drawFillStroke() {
-    for_first_then_each(
-            s->getPointVector(), [this](auto const& first) { cairo_move_to(this->cr, first.x, first.y); },
-            [this](auto const& other) { cairo_line_to(this->cr, other.x, other.y); });
+auto StrokeView::getPointCount() const -> size_t {
+    return this->simplifiedPoints ? this->simplifiedPoints->size() : s->getPointStorage().size();
+}
+
+auto StrokeView::getPoint(size_t i) const -> Point {
+    return this->simplifiedPoints ? (*this->simplifiedPoints)[i] : s->getPointStorage().get(i);
+}
+
+void StrokeView::appendPolyline() {
+    if (this->simplifiedPoints) {
+        for_first_then_each(
+                *this->simplifiedPoints, [this](auto const& first) { cairo_move_to(this->cr, first.x, first.y); },
+                [this](auto const& other) { cairo_line_to(this->cr, other.x, other.y); });
+        return;
+    }
+
+    // Only the coordinate arrays are read
+    StrokePoints const& points = s->getPointStorage();
+    if (points.empty()) {
+        return;
+    }
 
+    const double* xs = points.xData();
+    const double* ys = points.yData();
+    cairo_move_to(this->cr, xs[0], ys[0]);
+    for (size_t i = 1; i < points.size(); i++) {
+        cairo_line_to(this->cr, xs[i], ys[i]);
+    }
+}
+
+void StrokeView::drawFillStroke() {
+    appendPolyline();
     cairo_fill(cr);
 }
 
@@ -88,9 +128,7 @@ void StrokeView::drawNoPressure() {
     cairo_set_line_width(cr, width * scaleFactor);
     applyDashed(0);
 
-    for_first_then_each(
-            s->getPointVector(), [this](auto const& first) { cairo_move_to(cr, first.x, first.y); },
-            [this](auto const& other) { cairo_line_to(cr, other.x, other.y); });
+    appendPolyline();
     cairo_stroke(cr);
 
     if (group) {
@@ -110,20 +148,124 @@ void StrokeView::drawNoPressure() {
  * lines with different widths needs to be drawn
  */
 void StrokeView::drawWithPressure() {
+    const double* dashes = nullptr;
+    int dashCount = 0;
+    if (!s->getLineStyle().getDashes(dashes, dashCount)) {
+        // Not dashed: one outline around all segments, which is filled at once
+        s->getRenderCache().appendOutline(cr, scaleFactor, level, [this]() { buildPressureOutline(); });
+        cairo_set_fill_rule(cr, CAIRO_FILL_RULE_WINDING);
+        cairo_fill(cr);
+        return;
+    }
+
     double dashOffset = 0;
 
-    for (auto p1i = begin(s->getPointVector()), p2i = std::next(p1i), endi = end(s->getPointVector());
-         p1i != endi && p2i != endi; ++p1i, ++p2i) {
-        auto width = p1i->z != Point::NO_PRESSURE ? p1i->z : s->getWidth();
+    size_t count = getPointCount();
+    for (size_t i = 1; i < count; i++) {
+        Point p1 = getPoint(i - 1);
+        Point p2 = getPoint(i);
+        auto width = p1.z != Point::NO_PRESSURE ? p1.z : s->getWidth();
         cairo_set_line_width(cr, width * scaleFactor);
         applyDashed(dashOffset);
-        cairo_move_to(cr, p1i->x, p1i->y);
-        cairo_line_to(cr, p2i->x, p2i->y);
+        cairo_move_to(cr, p1.x, p1.y);
+        cairo_line_to(cr, p2.x, p2.y);
         cairo_stroke(cr);
-        dashOffset += p1i->lineLengthTo(*p2i);
+        dashOffset += p1.lineLengthTo(p2);
     }
 }
 
+/**
+ * @return the turn from the direction from to the direction to, between -pi and pi
+ */
+static auto turnAngle(double from, double to) -> double { return std::remainder(to - from, 2 * M_PI); }
+
+/**
+ * Connects the sides of two segments at p: with an arc on the outer side of the turn, through p on the inner side
+ */
+static void addJoin(cairo_t* cr, Point const& p, double radius, double angle, double turn) {
+    if (turn < 0) {
+        cairo_arc_negative(cr, p.x, p.y, radius, angle, angle + turn);
+    } else {
+        cairo_line_to(cr, p.x, p.y);
+    }
+}
+
+/**
+ * Adds one closed outline around the stroke: the left side forward and the right side back, with round caps at
+ * both ends and round joins. Filled with the winding rule it covers the same area as the round-capped segments,
+ * also where the stroke crosses itself. Where the width changes, the cap of the wider segment is not fully covered,
+ * the outline deviates by at most the width change.
+ */
+void StrokeView::buildPressureOutline() {
+    struct Segment {
+        Point a;
+        Point b;
+        double radius;
+        double angle;
+    };
+
+    size_t count = getPointCount();
+    std::vector<Segment> segments;
+    segments.reserve(count);
+    for (size_t i = 1; i < count; i++) {
+        Point p1 = getPoint(i - 1);
+        Point p2 = getPoint(i);
+        if (p1.equalsPos(p2)) {
+            // No direction, covered by the neighbours
+            continue;
+        }
+        auto width = p1.z != Point::NO_PRESSURE ? p1.z : s->getWidth();
+        segments.push_back({p1, p2, width * scaleFactor / 2, std::atan2(p2.y - p1.y, p2.x - p1.x)});
+    }
+
+    if (segments.empty()) {
+        if (count > 0) {
+            // All points at one position, a dot
+            Point p = getPoint(0);
+            auto width = p.z != Point::NO_PRESSURE ? p.z : s->getWidth();
+            cairo_new_sub_path(cr);
+            cairo_arc(cr, p.x, p.y, width * scaleFactor / 2, 0, 2 * M_PI);
+            cairo_close_path(cr);
+        }
+        return;
+    }
+
+    cairo_new_sub_path(cr);
+
+    for (size_t i = 0; i < segments.size(); i++) {
+        Segment const& seg = segments[i];
+        double nx = -std::sin(seg.angle) * seg.radius;
+        double ny = std::cos(seg.angle) * seg.radius;
+        cairo_line_to(cr, seg.a.x + nx, seg.a.y + ny);
+        cairo_line_to(cr, seg.b.x + nx, seg.b.y + ny);
+        if (i + 1 < segments.size()) {
+            Segment const& next = segments[i + 1];
+            addJoin(cr, seg.b, std::max(seg.radius, next.radius), seg.angle + M_PI / 2,
+                    turnAngle(seg.angle, next.angle));
+        }
+    }
+
+    Segment const& last = segments.back();
+    cairo_arc_negative(cr, last.b.x, last.b.y, last.radius, last.angle + M_PI / 2, last.angle - M_PI / 2);
+
+    for (size_t i = segments.size(); i-- > 0;) {
+        Segment const& seg = segments[i];
+        double nx = -std::sin(seg.angle) * seg.radius;
+        double ny = std::cos(seg.angle) * seg.radius;
+        cairo_line_to(cr, seg.b.x - nx, seg.b.y - ny);
+        cairo_line_to(cr, seg.a.x - nx, seg.a.y - ny);
+        if (i > 0) {
+            Segment const& previous = segments[i - 1];
+            addJoin(cr, seg.a, std::max(seg.radius, previous.radius), seg.angle - M_PI / 2,
+                    turnAngle(seg.angle, previous.angle));
+        }
+    }
+
+    Segment const& first = segments.front();
+    cairo_arc_negative(cr, first.a.x, first.a.y, first.radius, first.angle - M_PI / 2, first.angle - 3 * M_PI / 2);
+    cairo_close_path(cr);
+}
+
 void StrokeView::paint(bool dontRenderEditingStroke) {
     cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
     cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
@@ -11,8 +11,13 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include <gtk/gtk.h>
 
+#include "model/Point.h"
+
 class Stroke;
 
 class StrokeView {
@@ -30,6 +35,17 @@ public:
     void changeCairoSource(bool markAudioStroke);
 
 private:
+    /**
+     * The points to draw, simplified depending on the scale of cr
+     */
+    size_t getPointCount() const;
+    Point getPoint(size_t i) const;
+
+    /**
+     * Adds the points as one line to the path
+     */
+    void appendPolyline();
+
     void drawFillStroke();
     void applyDashed(double offset);
     static void drawEraseableStroke(cairo_t* cr, Stroke* s);
@@ -45,6 +61,11 @@ private:
      */
     void drawWithPressure();
 
+    /**
+     * Creates the outline of a stroke with pressure on the current path
+     */
+    void buildPressureOutline();
+
 
 private:
     cairo_t* cr;
@@ -53,4 +74,10 @@ private:
     int startPoint;
     double scaleFactor;
     bool noAlpha;
+
+    /**
+     * Level of detail, 0 if all points are drawn
+     */
+    int level = 0;
+    std::shared_ptr<const std::vector<Point>> simplifiedPoints;
 };
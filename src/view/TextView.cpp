@@ -1,5 +1,7 @@
 #include "TextView.h"
 
+#include <array>
+
 #include "control/settings/Settings.h"
 #include "model/Text.h"
 #include "pdf/base/XojPdfPage.h"
@@ -39,76 +41,123 @@ void TextView::updatePangoFont(PangoLayout* layout, const Text* t) {
     pango_font_description_free(desc);
 }
 
+/**
+ * The contexts of the cached layouts per role, with the font options of an image surface like the TextEditor
+ */
+static std::array<PangoContext*, 2> cachedLayoutContexts{};
+
+/**
+ * The render threads share their context, so they use it one after the other
+ */
+static GMutex renderContextMutex;
+
+static auto getCachedLayoutContext(TextLayoutCache::Role role) -> PangoContext* {
+    PangoContext*& context = cachedLayoutContexts[static_cast<size_t>(role)];
+    if (context == nullptr) {
+        // An own font map, the default font map must only be used by its thread
+        PangoFontMap* fontMap = pango_cairo_font_map_new();
+        context = pango_font_map_create_context(fontMap);
+        g_object_unref(fontMap);
+
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+        cairo_t* cr = cairo_create(surface);
+        pango_cairo_update_context(cr, context);
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+
+        pango_context_set_matrix(context, nullptr);
+    }
+
+    // Changing the context relayouts all layouts, so only do it if needed
+    if (pango_cairo_context_get_resolution(context) != textDpi) {
+        pango_cairo_context_set_resolution(context, textDpi);
+    }
+
+    return context;
+}
+
+void TextView::useLayout(const Text* t, std::function<void(PangoLayout*)> const& use) {
+    string str = t->getText();
+
+    bool ui = g_main_context_is_owner(g_main_context_default());
+    TextLayoutCache::Role role = ui ? TextLayoutCache::Role::UI : TextLayoutCache::Role::RENDER;
+    if (!ui) {
+        g_mutex_lock(&renderContextMutex);
+    }
+
+    PangoContext* context = getCachedLayoutContext(role);
+    t->getLayoutCache().use(
+            str, t->getFontName(), t->getFontSize(), textDpi, role,
+            [&]() {
+                PangoLayout* layout = pango_layout_new(context);
+                updatePangoFont(layout, t);
+                pango_layout_set_text(layout, str.c_str(), str.length());
+                return layout;
+            },
+            use);
+
+    if (!ui) {
+        g_mutex_unlock(&renderContextMutex);
+    }
+}
+
 void TextView::drawText(cairo_t* cr, const Text* t) {
     cairo_save(cr);
 
     cairo_translate(cr, t->getX(), t->getY());
 
-    PangoLayout* layout = initPango(cr, t);
-    string str = t->getText();
-    pango_layout_set_text(layout, str.c_str(), str.length());
+    if (cairo_surface_get_type(cairo_get_target(cr)) == CAIRO_SURFACE_TYPE_IMAGE) {
+        useLayout(t, [cr](PangoLayout* layout) { pango_cairo_show_layout(cr, layout); });
+    } else {
+        // Export and printing use the font options of their surface
+        PangoLayout* layout = initPango(cr, t);
+        string str = t->getText();
+        pango_layout_set_text(layout, str.c_str(), str.length());
 
-    pango_cairo_show_layout(cr, layout);
+        pango_cairo_show_layout(cr, layout);
 
-    g_object_unref(layout);
+        g_object_unref(layout);
+    }
 
     cairo_restore(cr);
 }
 
 auto TextView::findText(const Text* t, string& search) -> vector<XojPdfRectangle> {
-    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
-    cairo_t* cr = cairo_create(surface);
-
-    PangoLayout* layout = initPango(cr, t);
-    string str = t->getText();
-    pango_layout_set_text(layout, str.c_str(), str.length());
-
-
     string text = t->getText();
 
     string srch = StringUtils::toLowerCase(search);
 
     vector<XojPdfRectangle> list;
 
-    int pos = -1;
-    do {
-        pos = StringUtils::toLowerCase(text).find(srch, pos + 1);
-        if (pos != -1) {
-            XojPdfRectangle mark;
-            PangoRectangle rect = {0};
-            pango_layout_index_to_pos(layout, pos, &rect);
-            mark.x1 = (static_cast<double>(rect.x)) / PANGO_SCALE + t->getX();
-            mark.y1 = (static_cast<double>(rect.y)) / PANGO_SCALE + t->getY();
-
-            pango_layout_index_to_pos(layout, pos + srch.length(), &rect);
-            mark.x2 = (static_cast<double>(rect.x) + rect.width) / PANGO_SCALE + t->getX();
-            mark.y2 = (static_cast<double>(rect.y) + rect.height) / PANGO_SCALE + t->getY();
-
-            list.push_back(mark);
-        }
-    } while (pos != -1);
-
-    g_object_unref(layout);
-    cairo_surface_destroy(surface);
-    cairo_destroy(cr);
+    useLayout(t, [&](PangoLayout* layout) {
+        int pos = -1;
+        do {
+            pos = StringUtils::toLowerCase(text).find(srch, pos + 1);
+            if (pos != -1) {
+                XojPdfRectangle mark;
+                PangoRectangle rect = {0};
+                pango_layout_index_to_pos(layout, pos, &rect);
+                mark.x1 = (static_cast<double>(rect.x)) / PANGO_SCALE + t->getX();
+                mark.y1 = (static_cast<double>(rect.y)) / PANGO_SCALE + t->getY();
+
+                pango_layout_index_to_pos(layout, pos + srch.length(), &rect);
+                mark.x2 = (static_cast<double>(rect.x) + rect.width) / PANGO_SCALE + t->getX();
+                mark.y2 = (static_cast<double>(rect.y) + rect.height) / PANGO_SCALE + t->getY();
+
+                list.push_back(mark);
+            }
+        } while (pos != -1);
+    });
 
     return list;
 }
 
 void TextView::calcSize(const Text* t, double& width, double& height) {
-    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
-    cairo_t* cr = cairo_create(surface);
-
-    PangoLayout* layout = initPango(cr, t);
-    string str = t->getText();
-    pango_layout_set_text(layout, str.c_str(), str.length());
-    int w = 0;
-    int h = 0;
-    pango_layout_get_size(layout, &w, &h);
-    width = (static_cast<double>(w)) / PANGO_SCALE;
-    height = (static_cast<double>(h)) / PANGO_SCALE;
-    g_object_unref(layout);
-
-    cairo_surface_destroy(surface);
-    cairo_destroy(cr);
+    useLayout(t, [&](PangoLayout* layout) {
+        int w = 0;
+        int h = 0;
+        pango_layout_get_size(layout, &w, &h);
+        width = (static_cast<double>(w)) / PANGO_SCALE;
+        height = (static_cast<double>(h)) / PANGO_SCALE;
+    });
 }
@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include <gtk/gtk.h>
 
 #include "pdf/base/XojPdfPage.h"
@@ -49,4 +51,10 @@ public:
      * Sets the font name from Text model
      */
     static void updatePangoFont(PangoLayout* layout, const Text* t);
+
+private:
+    /**
+     * Calls use with the cached layout of the text, which is built if needed
+     */
+    static void useLayout(const Text* t, std::function<void(PangoLayout*)> const& use);
 };
@@ -0,0 +1,53 @@
+#include "BackgroundPatternCache.h"
+
+/**
+ * The count of cells kept, there are only a few background types and zoom levels in use at the same time
+ */
+constexpr size_t MAX_CACHED_CELLS = 32;
+
+BackgroundPatternCache::BackgroundPatternCache() { g_mutex_init(&this->cacheMutex); }
+
+BackgroundPatternCache::~BackgroundPatternCache() {
+    for (Entry& e: this->entries) {
+        cairo_surface_destroy(e.surface);
+    }
+    g_mutex_clear(&this->cacheMutex);
+}
+
+auto BackgroundPatternCache::getInstance() -> BackgroundPatternCache& {
+    static BackgroundPatternCache instance;
+    return instance;
+}
+
+auto BackgroundPatternCache::get(std::string const& key, std::function<cairo_surface_t*()> const& create)
+        -> cairo_surface_t* {
+    g_mutex_lock(&this->cacheMutex);
+
+    auto it = this->index.find(key);
+    if (it != this->index.end()) {
+        this->entries.splice(this->entries.begin(), this->entries, it->second);
+        cairo_surface_t* surface = cairo_surface_reference(it->second->surface);
+        g_mutex_unlock(&this->cacheMutex);
+        return surface;
+    }
+
+    // Rendering a cell is cheap, it's done while locked so it's only done once
+    cairo_surface_t* surface = create();
+    if (surface == nullptr) {
+        g_mutex_unlock(&this->cacheMutex);
+        return nullptr;
+    }
+
+    this->entries.push_front({key, surface});
+    this->index[key] = this->entries.begin();
+
+    while (this->entries.size() > MAX_CACHED_CELLS) {
+        this->index.erase(this->entries.back().key);
+        cairo_surface_destroy(this->entries.back().surface);
+        this->entries.pop_back();
+    }
+
+    surface = cairo_surface_reference(surface);
+    g_mutex_unlock(&this->cacheMutex);
+    return surface;
+}
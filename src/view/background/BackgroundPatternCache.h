@@ -0,0 +1,56 @@
+/*
+ * Xournal++
+ *
+ * Rendered repeat cells of background patterns, shared by all pages
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include <gtk/gtk.h>
+
+/**
+ * Thread safe, the pages are rendered by several threads
+ */
+class BackgroundPatternCache {
+private:
+    BackgroundPatternCache();
+    virtual ~BackgroundPatternCache();
+
+public:
+    BackgroundPatternCache(const BackgroundPatternCache&) = delete;
+    BackgroundPatternCache& operator=(const BackgroundPatternCache&) = delete;
+
+    static BackgroundPatternCache& getInstance();
+
+public:
+    /**
+     * Returns the surface cached for key, or creates it with create and caches it
+     *
+     * @return A new reference to the surface, nullptr if create failed
+     */
+    cairo_surface_t* get(std::string const& key, std::function<cairo_surface_t*()> const& create);
+
+private:
+    struct Entry {
+        std::string key;
+        cairo_surface_t* surface;
+    };
+
+    GMutex cacheMutex{};
+
+    /**
+     * The most recently used entry is at the front
+     */
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+};
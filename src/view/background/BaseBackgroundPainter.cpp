@@ -1,7 +1,26 @@
 #include "BaseBackgroundPainter.h"
 
+#include <cmath>
+
+#include "BackgroundPatternCache.h"
 #include "Util.h"
 
+/**
+ * A cell surface contains as many cells that it has at least this size,
+ * so the rounding of its size to pixels doesn't distort the pattern
+ */
+constexpr double MIN_CELL_PIXELS = 128;
+
+/**
+ * Bigger cells are not worth caching, the lines / dots are drawn directly
+ */
+constexpr double MAX_CELL_PIXELS = 2048;
+
+/**
+ * Steps of the sub pixel position of the pattern which are distinguished
+ */
+constexpr double PHASE_STEPS = 4;
+
 BaseBackgroundPainter::BaseBackgroundPainter() { resetConfig(); }
 
 BaseBackgroundPainter::~BaseBackgroundPainter() = default;
@@ -52,3 +71,86 @@ void BaseBackgroundPainter::paintBackgroundColor() {
     cairo_rectangle(cr, 0, 0, width, height);
     cairo_fill(cr);
 }
+
+auto BaseBackgroundPainter::fillWithPattern(std::string const& key, double cellWidth, double cellHeight,
+                                            double originX, double originY, Rectangle<double> const& area,
+                                            std::function<void(cairo_t*)> const& drawCell) -> bool {
+    if (cairo_surface_get_type(cairo_get_target(cr)) != CAIRO_SURFACE_TYPE_IMAGE) {
+        // Keep vector output for PDF / SVG export and printing
+        return false;
+    }
+
+    cairo_matrix_t matrix;
+    cairo_get_matrix(cr, &matrix);
+    if (matrix.xy != 0 || matrix.yx != 0 || matrix.xx <= 0 || matrix.xx != matrix.yy) {
+        return false;
+    }
+    double scale = matrix.xx;
+
+    // Several cells per surface, so the pixel size of the surface fits the page size of the cells well
+    int cellsX = static_cast<int>(std::ceil(MIN_CELL_PIXELS / (cellWidth * scale)));
+    int cellsY = static_cast<int>(std::ceil(MIN_CELL_PIXELS / (cellHeight * scale)));
+    int pixelsX = static_cast<int>(std::lround(cellsX * cellWidth * scale));
+    int pixelsY = static_cast<int>(std::lround(cellsY * cellHeight * scale));
+    if (pixelsX > MAX_CELL_PIXELS || pixelsY > MAX_CELL_PIXELS) {
+        return false;
+    }
+
+    double scaleX = pixelsX / (cellsX * cellWidth);
+    double scaleY = pixelsY / (cellsY * cellHeight);
+
+    // Align the pixels of the cell with the device pixels, so the pattern is not blurred
+    double deviceX = originX;
+    double deviceY = originY;
+    cairo_user_to_device(cr, &deviceX, &deviceY);
+    double phaseX = std::round((deviceX - std::floor(deviceX)) * PHASE_STEPS) / PHASE_STEPS;
+    double phaseY = std::round((deviceY - std::floor(deviceY)) * PHASE_STEPS) / PHASE_STEPS;
+
+    std::string cellKey = key + "@" + std::to_string(scale) + "/" + std::to_string(phaseX) + "/" +
+                          std::to_string(phaseY) + "/" + std::to_string(lineWidthFactor);
+
+    cairo_surface_t* cell = BackgroundPatternCache::getInstance().get(cellKey, [&]() -> cairo_surface_t* {
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, pixelsX, pixelsY);
+        cairo_t* crCell = cairo_create(surface);
+        cairo_translate(crCell, phaseX, phaseY);
+        cairo_scale(crCell, scaleX, scaleY);
+
+        // Draw the neighbours, too, for the content reaching into this cell
+        for (int x = -1; x <= cellsX; x++) {
+            for (int y = -1; y <= cellsY; y++) {
+                cairo_save(crCell);
+                cairo_translate(crCell, x * cellWidth, y * cellHeight);
+                drawCell(crCell);
+                cairo_restore(crCell);
+            }
+        }
+
+        cairo_destroy(crCell);
+        return surface;
+    });
+
+    if (cell == nullptr) {
+        return false;
+    }
+
+    cairo_pattern_t* pattern = cairo_pattern_create_for_surface(cell);
+    cairo_pattern_set_extend(pattern, CAIRO_EXTEND_REPEAT);
+
+    // Page coordinates to cell pixels
+    cairo_matrix_t patternMatrix;
+    cairo_matrix_init_translate(&patternMatrix, phaseX, phaseY);
+    cairo_matrix_scale(&patternMatrix, scaleX, scaleY);
+    cairo_matrix_translate(&patternMatrix, -originX, -originY);
+    cairo_pattern_set_matrix(pattern, &patternMatrix);
+
+    cairo_save(cr);
+    cairo_set_source(cr, pattern);
+    cairo_rectangle(cr, area.x, area.y, area.width, area.height);
+    cairo_fill(cr);
+    cairo_restore(cr);
+
+    cairo_pattern_destroy(pattern);
+    cairo_surface_destroy(cell);
+
+    return true;
+}
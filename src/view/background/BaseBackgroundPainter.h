@@ -11,11 +11,16 @@
 
 #pragma once
 
+#include <functional>
+#include <string>
+
 #include <gtk/gtk.h>
 
 #include "model/PageRef.h"
 #include "util/Color.h"
 
+#include "Rectangle.h"
+
 #include "BackgroundConfig.h"
 
 class BaseBackgroundPainter {
@@ -40,6 +45,24 @@ public:
 protected:
     void paintBackgroundColor();
 
+    /**
+     * Fills area with a repeated cell. The cell is rendered once per zoom and shared by all pages,
+     * which is much faster than drawing each line / dot.
+     *
+     * Only done for raster targets: for export and printing false is returned, and the painter has to draw directly.
+     *
+     * @param key Identifies the cell content (type and all parameters), the zoom is added
+     * @param cellWidth The width of the cell in page coordinates
+     * @param cellHeight The height of the cell in page coordinates
+     * @param originX The position of a cell in page coordinates
+     * @param originY The position of a cell in page coordinates
+     * @param area The area to fill in page coordinates
+     * @param drawCell Draws the content of one cell at (0, 0). Content reaching out of the cell is
+     *                 visible on the neighbouring cells.
+     */
+    bool fillWithPattern(std::string const& key, double cellWidth, double cellHeight, double originX,
+                         double originY, Rectangle<double> const& area, std::function<void(cairo_t*)> const& drawCell);
+
 private:
 protected:
     BackgroundConfig* config = nullptr;
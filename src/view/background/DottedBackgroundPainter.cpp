@@ -1,5 +1,8 @@
 #include "DottedBackgroundPainter.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "Util.h"
 
 DottedBackgroundPainter::DottedBackgroundPainter() = default;
@@ -18,6 +21,26 @@ void DottedBackgroundPainter::paint() {
 }
 
 void DottedBackgroundPainter::paintBackgroundDotted() {
+    // Dots at drawRaster1 * (i + 1), as long as they are within the page
+    int countX = std::max(0, static_cast<int>(std::ceil(width / drawRaster1 - 1)));
+    int countY = std::max(0, static_cast<int>(std::ceil(height / drawRaster1 - 1)));
+    double half = drawRaster1 / 2;
+    Rectangle<double> area(half, half, countX * drawRaster1, countY * drawRaster1);
+
+    std::string key = "dotted/" + std::to_string(uint32_t(foregroundColor1)) + "/" + std::to_string(lineWidth) + "/" +
+                      std::to_string(drawRaster1);
+    bool filled = fillWithPattern(key, drawRaster1, drawRaster1, 0, 0, area, [this](cairo_t* crCell) {
+        Util::cairo_set_source_rgbi(crCell, this->foregroundColor1);
+        cairo_set_line_width(crCell, lineWidth * lineWidthFactor);
+        cairo_set_line_cap(crCell, CAIRO_LINE_CAP_ROUND);
+        cairo_move_to(crCell, 0, 0);
+        cairo_line_to(crCell, 0, 0);
+        cairo_stroke(crCell);
+    });
+    if (filled) {
+        return;
+    }
+
     Util::cairo_set_source_rgbi(cr, this->foregroundColor1);
 
     cairo_set_line_width(cr, lineWidth * lineWidthFactor);
@@ -57,6 +57,10 @@ void GraphBackgroundPainter::paintBackgroundGraph() {
 
     auto pos = [dr1 = drawRaster1](int i) { return dr1 + i * dr1; };
 
+    if (paintGraphPattern(marginLeftRight, marginTopBottom, snappingOffset)) {
+        return;
+    }
+
     for (int x = 0; pos(x) < width; ++x) {
         if (pos(x) < margin1 || pos(x) > (width - margin1)) {
             continue;
@@ -76,3 +80,70 @@ void GraphBackgroundPainter::paintBackgroundGraph() {
 
     cairo_stroke(cr);
 }
+
+/**
+ * Draws the vertical and the horizontal lines each with a repeated pattern
+ *
+ * @return false if the lines need to be drawn directly
+ */
+auto GraphBackgroundPainter::paintGraphPattern(double marginLeftRight, double marginTopBottom, double snappingOffset)
+        -> bool {
+    auto pos = [dr1 = drawRaster1](int i) { return dr1 + i * dr1; };
+
+    // The same lines as drawn directly
+    int firstX = -1;
+    int lastX = -1;
+    for (int x = 0; pos(x) < width; ++x) {
+        if (pos(x) < margin1 || pos(x) > (width - margin1)) {
+            continue;
+        }
+        firstX = firstX < 0 ? x : firstX;
+        lastX = x;
+    }
+
+    int firstY = -1;
+    int lastY = -1;
+    for (int y = 0; pos(y) < height; ++y) {
+        if (pos(y) < margin1 || pos(y) > (height - marginTopBottom)) {
+            continue;
+        }
+        firstY = firstY < 0 ? y : firstY;
+        lastY = y;
+    }
+
+    std::string key = "graph/" + std::to_string(uint32_t(foregroundColor1)) + "/" + std::to_string(lineWidth) + "/" +
+                      std::to_string(drawRaster1);
+    double half = drawRaster1 / 2;
+
+    if (firstX >= 0) {
+        Rectangle<double> area(pos(firstX) - half, marginTopBottom - snappingOffset, pos(lastX) - pos(firstX) + 2 * half,
+                               height - 2 * marginTopBottom);
+        bool filled = fillWithPattern(key + "/v", drawRaster1, drawRaster1, 0, 0, area, [this](cairo_t* crCell) {
+            Util::cairo_set_source_rgbi(crCell, this->foregroundColor1);
+            cairo_set_line_width(crCell, lineWidth * lineWidthFactor);
+            cairo_move_to(crCell, 0, 0);
+            cairo_line_to(crCell, 0, drawRaster1);
+            cairo_stroke(crCell);
+        });
+        if (!filled) {
+            return false;
+        }
+    }
+
+    if (firstY >= 0) {
+        Rectangle<double> area(marginLeftRight, pos(firstY) - half, width - 2 * marginLeftRight,
+                               pos(lastY) - pos(firstY) + 2 * half);
+        bool filled = fillWithPattern(key + "/h", drawRaster1, drawRaster1, 0, 0, area, [this](cairo_t* crCell) {
+            Util::cairo_set_source_rgbi(crCell, this->foregroundColor1);
+            cairo_set_line_width(crCell, lineWidth * lineWidthFactor);
+            cairo_move_to(crCell, 0, 0);
+            cairo_line_to(crCell, drawRaster1, 0);
+            cairo_stroke(crCell);
+        });
+        if (!filled) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -33,4 +33,5 @@ public:
 
 private:
     void updateGraphColor();
+    bool paintGraphPattern(double marginLeftRight, double marginTopBottom, double snappingOffset);
 };
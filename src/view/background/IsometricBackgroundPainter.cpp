@@ -1,6 +1,8 @@
 #include "IsometricBackgroundPainter.h"
 
+#include <algorithm>
 #include <cmath>
+#include <string>
 
 #include "Util.h"
 
@@ -124,6 +126,10 @@ void IsometricBackgroundPainter::paint() {
     const auto contentXOffset = (width - contentWidth) / 2;
     const auto contentYOffset = (height - contentHeight) / 2;
 
+    if (paintPattern(cols, rows, xstep, ystep, contentXOffset, contentYOffset)) {
+        return;
+    }
+
     if (drawLines) {
         auto drawLine = [&](double x1, double y1, double x2, double y2) {
             cairo_move_to(cr, contentXOffset + x1, contentYOffset + y1);
@@ -140,3 +146,87 @@ void IsometricBackgroundPainter::paint() {
 
     cairo_stroke(cr);
 }
+
+/**
+ * Fills the grid with a repeated cell of 2 x 2 steps
+ *
+ * @return false if the grid needs to be drawn directly
+ */
+auto IsometricBackgroundPainter::paintPattern(int cols, int rows, double xstep, double ystep, double xoffset,
+                                              double yoffset) -> bool {
+    const double lw = lineWidth * lineWidthFactor;
+    const auto contentWidth = cols * xstep;
+
+    std::string key = std::string(drawLines ? "isometric-lines/" : "isometric-dots/") +
+                      std::to_string(uint32_t(foregroundColor1)) + "/" + std::to_string(lineWidth) + "/" +
+                      std::to_string(drawRaster1);
+
+    auto prepare = [this, lw](cairo_t* crCell) {
+        Util::cairo_set_source_rgbi(crCell, this->foregroundColor1);
+        cairo_set_line_width(crCell, lw);
+        cairo_set_line_cap(crCell, CAIRO_LINE_CAP_ROUND);
+    };
+
+    if (!drawLines) {
+        // Dots are on every second grid point, alternating by column
+        const double ext = std::min(xstep, ystep) / 2;
+        if (lw >= ext) {
+            return false;
+        }
+
+        const auto dottedHeight = (rows - rows % 2) * ystep;
+        Rectangle<double> area(xoffset - ext, yoffset - ext, contentWidth + 2 * ext, dottedHeight + 2 * ext);
+        return fillWithPattern(key, 2 * xstep, 2 * ystep, xoffset, yoffset, area, [&](cairo_t* crCell) {
+            prepare(crCell);
+            cairo_move_to(crCell, 0, ystep);
+            cairo_line_to(crCell, 0, ystep);
+            cairo_move_to(crCell, xstep, 0);
+            cairo_line_to(crCell, xstep, 0);
+            cairo_stroke(crCell);
+        });
+    }
+
+    // The diagonals only follow a regular pattern if the grid has an even size
+    if (cols % 2 != 0 || rows % 2 != 0) {
+        return false;
+    }
+
+    const auto contentHeight = rows * ystep;
+    Rectangle<double> area(xoffset - lw / 2, yoffset, contentWidth + lw, contentHeight);
+    bool filled = fillWithPattern(key, 2 * xstep, 2 * ystep, xoffset, yoffset, area, [&](cairo_t* crCell) {
+        prepare(crCell);
+
+        // Vertical lines
+        cairo_move_to(crCell, 0, 0);
+        cairo_line_to(crCell, 0, 2 * ystep);
+        cairo_move_to(crCell, xstep, 0);
+        cairo_line_to(crCell, xstep, 2 * ystep);
+
+        // Diagonals from top right to bottom left
+        cairo_move_to(crCell, xstep, 0);
+        cairo_line_to(crCell, 0, ystep);
+        cairo_move_to(crCell, 2 * xstep, ystep);
+        cairo_line_to(crCell, xstep, 2 * ystep);
+
+        // Diagonals from top left to bottom right
+        cairo_move_to(crCell, xstep, 0);
+        cairo_line_to(crCell, 2 * xstep, ystep);
+        cairo_move_to(crCell, 0, ystep);
+        cairo_line_to(crCell, xstep, 2 * ystep);
+
+        cairo_stroke(crCell);
+    });
+
+    if (!filled) {
+        return false;
+    }
+
+    // The top and bottom line are not part of the pattern
+    cairo_move_to(cr, xoffset, yoffset);
+    cairo_line_to(cr, xoffset + contentWidth, yoffset);
+    cairo_move_to(cr, xoffset, yoffset + contentHeight);
+    cairo_line_to(cr, xoffset + contentWidth, yoffset + contentHeight);
+    cairo_stroke(cr);
+
+    return true;
+}
@@ -30,6 +30,9 @@ public:
      */
     virtual void resetConfig() override;
 
+private:
+    bool paintPattern(int cols, int rows, double xstep, double ystep, double xoffset, double yoffset);
+
 private:
     bool drawLines;
 };
@@ -1,5 +1,7 @@
 #include "LineBackgroundPainter.h"
 
+#include <string>
+
 #include "Util.h"
 
 LineBackgroundPainter::LineBackgroundPainter(bool verticalLine): verticalLine(verticalLine) {}
@@ -33,6 +35,21 @@ void LineBackgroundPainter::paintBackgroundRuled() {
 
     int numLines = static_cast<int>((height - headerSize - footerSize) / (roulingSize + lineWidth * lineWidthFactor));
 
+    if (numLines > 0) {
+        std::string key = "ruled/" + std::to_string(uint32_t(foregroundColor1)) + "/" + std::to_string(lineWidth);
+        Rectangle<double> area(0, headerSize - roulingSize / 2, width, numLines * roulingSize);
+        bool filled = fillWithPattern(key, roulingSize, roulingSize, 0, headerSize, area, [this](cairo_t* crCell) {
+            Util::cairo_set_source_rgbi(crCell, this->foregroundColor1);
+            cairo_set_line_width(crCell, lineWidth * lineWidthFactor);
+            cairo_move_to(crCell, 0, 0);
+            cairo_line_to(crCell, roulingSize, 0);
+            cairo_stroke(crCell);
+        });
+        if (filled) {
+            return;
+        }
+    }
+
     double offset = headerSize;
 
     for (int i = 0; i < numLines; i++) {
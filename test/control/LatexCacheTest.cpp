@@ -0,0 +1,108 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "control/latex/LatexCache.h"
+
+#include <chrono>
+#include <string>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <glib.h>
+
+#include "filesystem.h"
+
+class LatexCacheTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(LatexCacheTest);
+
+    CPPUNIT_TEST(testKey);
+    CPPUNIT_TEST(testStoreLookup);
+    CPPUNIT_TEST(testEvictLeastRecentlyUsed);
+    CPPUNIT_TEST(testDisabled);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {
+        gchar* tmp = g_dir_make_tmp("xournalpp-latex-XXXXXX", nullptr);
+        CPPUNIT_ASSERT(tmp != nullptr);
+        this->dir = tmp;
+        g_free(tmp);
+    }
+
+    void tearDown() {
+        std::error_code ec;
+        fs::remove_all(this->dir, ec);
+    }
+
+    /**
+     * Sets the time of the last use of a cached formula
+     */
+    void setLastUse(const std::string& key, std::chrono::seconds age) {
+        fs::last_write_time(this->dir / (key + ".pdf"), fs::file_time_type::clock::now() - age);
+    }
+
+    void testKey() {
+        std::string key = LatexCache::makeKey("x^2", "pdflatex");
+        CPPUNIT_ASSERT_EQUAL(key, LatexCache::makeKey("x^2", "pdflatex"));
+        CPPUNIT_ASSERT(key != LatexCache::makeKey("x^3", "pdflatex"));
+        CPPUNIT_ASSERT(key != LatexCache::makeKey("x^2", "lualatex"));
+
+        // The command and the file are separated
+        CPPUNIT_ASSERT(LatexCache::makeKey("ab", "c") != LatexCache::makeKey("b", "ca"));
+    }
+
+    void testStoreLookup() {
+        LatexCache cache(this->dir, 1024 * 1024);
+
+        CPPUNIT_ASSERT(!cache.lookup("formula"));
+
+        cache.store("formula", std::string("%PDF\0binary", 11));
+        auto pdf = cache.lookup("formula");
+        CPPUNIT_ASSERT(pdf);
+        CPPUNIT_ASSERT_EQUAL(std::string("%PDF\0binary", 11), *pdf);
+
+        // Shared by all instances using the directory
+        LatexCache other(this->dir, 1024 * 1024);
+        CPPUNIT_ASSERT(other.lookup("formula"));
+    }
+
+    void testEvictLeastRecentlyUsed() {
+        LatexCache cache(this->dir, 250);
+        std::string pdf(100, 'x');
+
+        cache.store("a", pdf);
+        setLastUse("a", std::chrono::seconds(100));
+        cache.store("b", pdf);
+        setLastUse("b", std::chrono::seconds(50));
+
+        // Using a makes b the least recently used
+        CPPUNIT_ASSERT(cache.lookup("a"));
+        cache.store("c", pdf);
+
+        CPPUNIT_ASSERT(cache.lookup("a"));
+        CPPUNIT_ASSERT(!cache.lookup("b"));
+        CPPUNIT_ASSERT(cache.lookup("c"));
+    }
+
+    void testDisabled() {
+        LatexCache cache(this->dir, 0);
+        cache.store("formula", "%PDF");
+        CPPUNIT_ASSERT(!cache.lookup("formula"));
+    }
+
+private:
+    fs::path dir;
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(LatexCacheTest);
@@ -0,0 +1,188 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "control/ThumbnailCache.h"
+#include "model/BackgroundImage.h"
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "filesystem.h"
+
+class ThumbnailCacheTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(ThumbnailCacheTest);
+
+    CPPUNIT_TEST(testStoreLookup);
+    CPPUNIT_TEST(testKeyChangesWithContent);
+    CPPUNIT_TEST(testKeyChangesWithBackgroundFile);
+    CPPUNIT_TEST(testKeyIndependentOfVersion);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {
+        gchar* tmp = g_dir_make_tmp("xournalpp-thumbnail-XXXXXX", nullptr);
+        CPPUNIT_ASSERT(tmp != nullptr);
+        this->dir = tmp;
+        g_free(tmp);
+    }
+
+    void tearDown() {
+        std::error_code ec;
+        fs::remove_all(this->dir, ec);
+    }
+
+    static cairo_surface_t* createSurface(int width, int height) {
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+        cairo_t* cr = cairo_create(surface);
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_paint(cr);
+        cairo_set_source_rgb(cr, 0.2, 0.4, 0.6);
+        cairo_rectangle(cr, 2, 3, width / 2, height / 2);
+        cairo_fill(cr);
+        cairo_destroy(cr);
+        return surface;
+    }
+
+    static PageRef createPage(Document& doc) {
+        auto page = std::make_shared<XojPage>(200, 300);
+        // Creates the first layer
+        page->getSelectedLayer();
+        doc.addPage(page);
+        return page;
+    }
+
+    static Stroke* createStroke() {
+        auto* s = new Stroke();
+        s->addPoint(Point(10, 10));
+        s->addPoint(Point(20, 20));
+        return s;
+    }
+
+    void testStoreLookup() {
+        ThumbnailCache cache(this->dir, 1024 * 1024);
+
+        cairo_surface_t* preview = createSurface(20, 30);
+        cache.store("key", preview);
+
+        cairo_surface_t* restored = cache.lookup("key", 20, 30);
+        CPPUNIT_ASSERT(restored != nullptr);
+
+        cairo_surface_flush(preview);
+        for (int y = 0; y < 30; y++) {
+            auto* expected = reinterpret_cast<uint32_t*>(cairo_image_surface_get_data(preview) +
+                                                         y * cairo_image_surface_get_stride(preview));
+            auto* actual = reinterpret_cast<uint32_t*>(cairo_image_surface_get_data(restored) +
+                                                       y * cairo_image_surface_get_stride(restored));
+            for (int x = 0; x < 20; x++) {
+                CPPUNIT_ASSERT_EQUAL(expected[x], actual[x]);
+            }
+        }
+        cairo_surface_destroy(restored);
+        cairo_surface_destroy(preview);
+
+        // Another size or another key is not found
+        CPPUNIT_ASSERT(cache.lookup("key", 10, 30) == nullptr);
+        CPPUNIT_ASSERT(cache.lookup("other", 20, 30) == nullptr);
+    }
+
+    void testKeyChangesWithContent() {
+        ThumbnailCache cache(this->dir, 1024 * 1024);
+        DocumentHandler handler;
+        Document doc(&handler);
+        PageRef page = createPage(doc);
+
+        // Not saved yet
+        CPPUNIT_ASSERT(cache.makeKey(&doc, page, 100, 150).empty());
+
+        doc.setFilepath(this->dir / "test.xopp");
+        std::string key = cache.makeKey(&doc, page, 100, 150);
+        CPPUNIT_ASSERT(!key.empty());
+        CPPUNIT_ASSERT_EQUAL(key, cache.makeKey(&doc, page, 100, 150));
+        CPPUNIT_ASSERT(key != cache.makeKey(&doc, page, 50, 75));
+
+        Stroke* s = createStroke();
+        page->getSelectedLayer()->addElement(s);
+
+        std::string withStroke = cache.makeKey(&doc, page, 100, 150);
+        CPPUNIT_ASSERT(key != withStroke);
+
+        // Changed in place, the hash of the layer is computed again after markModified()
+        s->setWidth(5);
+        page->getSelectedLayer()->markModified();
+        CPPUNIT_ASSERT(withStroke != cache.makeKey(&doc, page, 100, 150));
+    }
+
+    void testKeyIndependentOfVersion() {
+        DocumentHandler handler;
+        Document doc(&handler);
+        doc.setFilepath(this->dir / "test.xopp");
+        PageRef page = createPage(doc);
+        page->getSelectedLayer()->addElement(createStroke());
+
+        ThumbnailCache cache(this->dir, 1024 * 1024);
+        std::string key = cache.makeKey(&doc, page, 100, 150);
+
+        // The same content with other layer versions, like after opening the document again
+        Document other(&handler);
+        other.setFilepath(this->dir / "test.xopp");
+        PageRef otherPage = createPage(other);
+        otherPage->getSelectedLayer()->addElement(createStroke());
+        CPPUNIT_ASSERT(page->getSelectedLayer()->getVersion() != otherPage->getSelectedLayer()->getVersion());
+
+        ThumbnailCache otherCache(this->dir, 1024 * 1024);
+        CPPUNIT_ASSERT_EQUAL(key, otherCache.makeKey(&other, otherPage, 100, 150));
+    }
+
+    void testKeyChangesWithBackgroundFile() {
+        fs::path imagePath = this->dir / "background.png";
+        cairo_surface_t* image = createSurface(10, 10);
+        cairo_surface_write_to_png(image, imagePath.u8string().c_str());
+        cairo_surface_destroy(image);
+
+        DocumentHandler handler;
+        Document doc(&handler);
+        doc.setFilepath(this->dir / "test.xopp");
+        PageRef page = createPage(doc);
+
+        BackgroundImage background;
+        background.loadFile(imagePath, nullptr);
+        page->setBackgroundImage(background);
+        page->setBackgroundType(PageType(PageTypeFormat::Image));
+
+        ThumbnailCache cache(this->dir, 1024 * 1024);
+        std::string key = cache.makeKey(&doc, page, 100, 150);
+
+        // The file is replaced, the path stays the same
+        image = createSurface(40, 40);
+        cairo_surface_write_to_png(image, imagePath.u8string().c_str());
+        cairo_surface_destroy(image);
+        fs::last_write_time(imagePath, fs::last_write_time(imagePath) + std::chrono::seconds(10));
+
+        CPPUNIT_ASSERT(key != cache.makeKey(&doc, page, 100, 150));
+    }
+
+private:
+    fs::path dir;
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(ThumbnailCacheTest);
@@ -0,0 +1,491 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/Stroke.h"
+
+#include "HitTest.h"
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/**
+ * Stroke::intersects() as it was before, testing every point and segment of the stroke
+ */
+static auto referenceStrokeIntersects(const double* xs, const double* ys, size_t count, double x, double y,
+                                      double halfEraserSize, double* gap) -> bool {
+    if (count == 0) {
+        return false;
+    }
+
+    double x1 = x - halfEraserSize;
+    double x2 = x + halfEraserSize;
+    double y1 = y - halfEraserSize;
+    double y2 = y + halfEraserSize;
+
+    double lastX = xs[0];
+    double lastY = ys[0];
+    for (size_t i = 0; i < count; i++) {
+        double px = xs[i];
+        double py = ys[i];
+
+        if (px >= x1 && py >= y1 && px <= x2 && py <= y2) {
+            if (gap) {
+                *gap = 0;
+            }
+            return true;
+        }
+
+        double len = std::hypot(px - lastX, py - lastY);
+        if (len >= halfEraserSize) {
+            double p = std::abs((x - lastX) * (lastY - py) + (y - lastY) * (px - lastX)) / len;
+
+            if (p <= halfEraserSize) {
+                double centerX = (lastX + px) / 2;
+                double centerY = (lastY + py) / 2;
+                double distance = std::hypot(x - centerX, y - centerY);
+
+                distance -= halfEraserSize * std::sqrt(2);
+
+                constexpr double PADDING = 0.1;
+                if (distance <= len / 2 + PADDING) {
+                    if (gap) {
+                        *gap = distance;
+                    }
+                    return true;
+                }
+            }
+        }
+
+        lastX = px;
+        lastY = py;
+    }
+
+    return false;
+}
+
+/**
+ * RegionSelect::contains() as it was before, walking the edges of the polygon, with the bounding box of the polygon
+ */
+static auto referenceRegionContains(const double* polygonX, const double* polygonY, size_t polygonCount, double x1Box,
+                                    double y1Box, double x2Box, double y2Box, double x, double y) -> bool {
+    if (x < x1Box || x > x2Box) {
+        return false;
+    }
+    if (y < y1Box || y > y2Box) {
+        return false;
+    }
+    if (polygonCount < 2) {
+        return false;
+    }
+
+    int hits = 0;
+
+    double lastx = polygonX[polygonCount - 1];
+    double lasty = polygonY[polygonCount - 1];
+    double curx = NAN, cury = NAN;
+
+    // Walk the edges of the polygon
+    for (size_t i = 0; i < polygonCount; lastx = curx, lasty = cury, i++) {
+        curx = polygonX[i];
+        cury = polygonY[i];
+
+        if (cury == lasty) {
+            continue;
+        }
+
+        int leftx = 0;
+        if (curx < lastx) {
+            if (x >= lastx) {
+                continue;
+            }
+            leftx = curx;
+        } else {
+            if (x >= curx) {
+                continue;
+            }
+            leftx = lastx;
+        }
+
+        double test1 = NAN, test2 = NAN;
+        if (cury < lasty) {
+            if (y < cury || y >= lasty) {
+                continue;
+            }
+            if (x < leftx) {
+                hits++;
+                continue;
+            }
+            test1 = x - curx;
+            test2 = y - cury;
+        } else {
+            if (y < lasty || y >= cury) {
+                continue;
+            }
+            if (x < leftx) {
+                hits++;
+                continue;
+            }
+            test1 = x - lastx;
+            test2 = y - lasty;
+        }
+
+        if (test1 < (test2 / (lasty - cury) * (lastx - curx))) {
+            hits++;
+        }
+    }
+
+    return (hits & 1) != 0;
+}
+
+using HitTest::Isa;
+
+class HitTestTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(HitTestTest);
+
+#ifdef TEST_CHECK_SPEED
+    CPPUNIT_TEST(testSpeedEraser);
+    CPPUNIT_TEST(testSpeedLasso);
+#endif
+
+    CPPUNIT_TEST(testPolygon);
+    CPPUNIT_TEST(testIsasAgree);
+    CPPUNIT_TEST(testEraserSameAsReference);
+    CPPUNIT_TEST(testRegionSameAsReference);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() { this->bestIsa = HitTest::getIsa(); }
+
+    void tearDown() { HitTest::setIsa(this->bestIsa); }
+
+#ifdef TEST_CHECK_SPEED
+    /**
+     * 1000 strokes with 1000 points each, erased along a line through the page
+     */
+    void testSpeedEraser() {
+        std::vector<std::unique_ptr<Stroke>> strokes;
+        for (int i = 0; i < 1000; i++) {
+            auto s = std::make_unique<Stroke>();
+            for (int j = 0; j < 1000; j++) {
+                s->addPoint(Point(20 + (i % 20) * 28 + j * 0.025, 20 + (i / 20) * 16 + 4 * std::sin(j * 0.1)));
+            }
+            strokes.push_back(std::move(s));
+        }
+
+        for (Isa isa: {Isa::SCALAR, Isa::SSE2, Isa::AVX2}) {
+            if (!HitTest::setIsa(isa)) {
+                continue;
+            }
+
+            int hits = 0;
+            SpeedTest speed;
+            speed.startTest("erase 1000 strokes with 1000 points at 200 positions with " + isaName(isa));
+            for (int step = 0; step < 200; step++) {
+                for (auto& s: strokes) {
+                    hits += s->intersects(20 + step * 3, 20 + step * 4, 3) ? 1 : 0;
+                }
+            }
+            speed.endTest();
+            std::cout << hits << " hits" << std::endl;
+        }
+    }
+
+    /**
+     * A million points tested against a lasso with 500 points
+     */
+    void testSpeedLasso() {
+        std::vector<double> xs;
+        std::vector<double> ys;
+        for (int i = 0; i < 1000000; i++) {
+            xs.push_back(300 + 200 * std::cos(i * 0.001) * std::sin(i * 0.0007));
+            ys.push_back(400 + 200 * std::sin(i * 0.001) * std::sin(i * 0.0007));
+        }
+
+        std::vector<double> lassoX;
+        std::vector<double> lassoY;
+        for (int i = 0; i < 500; i++) {
+            double r = 220 + 5 * std::sin(i * 0.7);
+            lassoX.push_back(300 + r * std::cos(i * 2 * M_PI / 500));
+            lassoY.push_back(400 + r * std::sin(i * 2 * M_PI / 500));
+        }
+        auto edges = HitTest::polygonEdges(lassoX.data(), lassoY.data(), lassoX.size());
+
+        for (Isa isa: {Isa::SCALAR, Isa::SSE2, Isa::AVX2}) {
+            if (!HitTest::setIsa(isa)) {
+                continue;
+            }
+
+            SpeedTest speed;
+            speed.startTest("lasso select a million points with " + isaName(isa));
+            CPPUNIT_ASSERT(HitTest::allInPolygon(xs.data(), ys.data(), xs.size(), edges));
+            speed.endTest();
+        }
+    }
+
+    static std::string isaName(Isa isa) {
+        switch (isa) {
+            case Isa::AVX2:
+                return "AVX2";
+            case Isa::SSE2:
+                return "SSE2";
+            default:
+                return "scalar";
+        }
+    }
+#endif
+
+    void testPolygon() {
+        // A square with a notch at the top
+        std::vector<double> xs = {0, 10, 10, 6, 5, 4, 0};
+        std::vector<double> ys = {0, 0, 10, 10, 5, 10, 10};
+        auto edges = HitTest::polygonEdges(xs.data(), ys.data(), xs.size());
+
+        std::vector<double> insideX = {1, 9, 5, 2};
+        std::vector<double> insideY = {1, 9, 2, 8};
+        CPPUNIT_ASSERT(HitTest::allInPolygon(insideX.data(), insideY.data(), insideX.size(), edges));
+
+        double notchX = 5;
+        double notchY = 8;
+        CPPUNIT_ASSERT(!HitTest::allInPolygon(&notchX, &notchY, 1, edges));
+
+        insideX.push_back(11);
+        insideY.push_back(5);
+        CPPUNIT_ASSERT(!HitTest::allInPolygon(insideX.data(), insideY.data(), insideX.size(), edges));
+
+        CPPUNIT_ASSERT(HitTest::allInBox(xs.data(), ys.data(), xs.size(), 0, 0, 10, 10));
+        CPPUNIT_ASSERT(!HitTest::allInBox(xs.data(), ys.data(), xs.size(), 0, 0, 10, 9.5));
+    }
+
+    /**
+     * The vectorized tests have to give the same results as the scalar one, also for the points after the last
+     * full vector
+     */
+    void testIsasAgree() {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<double> coord(0, 100);
+
+        for (int run = 0; run < 200; run++) {
+            size_t count = 1 + run % 23;
+            std::vector<double> xs;
+            std::vector<double> ys;
+            double x = coord(random);
+            double y = coord(random);
+            for (size_t i = 0; i < count; i++) {
+                x += coord(random) / 20 - 2.5;
+                y += coord(random) / 20 - 2.5;
+                xs.push_back(x);
+                ys.push_back(y);
+            }
+
+            std::vector<double> polygonX;
+            std::vector<double> polygonY;
+            for (int i = 0; i < 3 + run % 17; i++) {
+                polygonX.push_back(coord(random));
+                polygonY.push_back(coord(random));
+            }
+            auto edges = HitTest::polygonEdges(polygonX.data(), polygonY.data(), polygonX.size());
+
+            double ex = coord(random);
+            double ey = coord(random);
+            double h = coord(random) / 10;
+
+            std::vector<bool> results;
+            for (Isa isa: {Isa::SCALAR, Isa::SSE2, Isa::AVX2}) {
+                if (!HitTest::setIsa(isa)) {
+                    continue;
+                }
+
+                std::vector<bool> current;
+                current.push_back(HitTest::allInBox(xs.data(), ys.data(), count, 20, 20, 80, 80));
+                current.push_back(HitTest::allInPolygon(xs.data(), ys.data(), count, edges));
+                for (size_t i = 0; i < count; i++) {
+                    current.push_back(HitTest::allInPolygon(&xs[i], &ys[i], 1, edges));
+                    current.push_back(HitTest::nextSegmentCandidate(xs.data(), ys.data(), i, count, ex, ey, h, 0.1) ==
+                                      i);
+                }
+
+                if (results.empty()) {
+                    results = current;
+                } else {
+                    CPPUNIT_ASSERT(results == current);
+                }
+            }
+        }
+    }
+
+    /**
+     * Stroke::intersects() has to give the same hits and gaps as the previous test of all points with each
+     * instruction set, for point counts around the vector widths and the chunk size
+     */
+    void testEraserSameAsReference() {
+        std::mt19937 random(3);
+        std::uniform_real_distribution<double> unit(0, 1);
+
+        for (Isa isa: {Isa::SCALAR, Isa::SSE2, Isa::AVX2}) {
+            if (!HitTest::setIsa(isa)) {
+                continue;
+            }
+
+            for (size_t count = 1; count <= 40; count++) {
+                for (int run = 0; run < 50; run++) {
+                    Stroke s;
+                    double x = 20;
+                    double y = 20;
+                    for (size_t i = 0; i < count; i++) {
+                        x += unit(random) * 6 - 3;
+                        y += unit(random) * 6 - 3;
+                        s.addPoint(Point(x, y));
+                    }
+                    StrokePoints const& points = s.getPointStorage();
+
+                    for (int i = 0; i < 20; i++) {
+                        // Half of the positions near the last points, which are in the tail of the vectors
+                        size_t near = count - 1 - static_cast<size_t>(unit(random) * std::min<size_t>(count, 3));
+                        double ex = i % 2 ? points.x(near) + unit(random) * 4 - 2 : unit(random) * 40;
+                        double ey = i % 2 ? points.y(near) + unit(random) * 4 - 2 : unit(random) * 40;
+                        double h = 0.2 + unit(random) * 3;
+
+                        double gap = -1;
+                        double referenceGap = -1;
+                        bool hit = s.intersects(ex, ey, h, &gap);
+                        bool referenceHit = referenceStrokeIntersects(points.xData(), points.yData(), count, ex, ey,
+                                                                      h, &referenceGap);
+                        CPPUNIT_ASSERT_EQUAL(referenceHit, hit);
+                        CPPUNIT_ASSERT_EQUAL(referenceGap, gap);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * The box and polygon test of RegionSelect::containsAll() has to give the same result as the previous
+     * RegionSelect::contains() for each point, also if the only point outside is in the tail of the vectors
+     */
+    void testRegionSameAsReference() {
+        std::mt19937 random(5);
+        std::uniform_real_distribution<double> unit(0, 1);
+
+        for (int run = 0; run < 100; run++) {
+            // A lasso around (50, 50)
+            std::vector<double> polygonX;
+            std::vector<double> polygonY;
+            size_t corners = 3 + run % 30;
+            for (size_t i = 0; i < corners; i++) {
+                double r = 10 + unit(random) * 40;
+                polygonX.push_back(50 + r * std::cos(i * 2 * M_PI / corners));
+                polygonY.push_back(50 + r * std::sin(i * 2 * M_PI / corners));
+            }
+            auto edges = HitTest::polygonEdges(polygonX.data(), polygonY.data(), polygonX.size());
+
+            // The bounding box as built by RegionSelect::finalize()
+            double x1Box = 0;
+            double x2Box = 0;
+            double y1Box = 0;
+            double y2Box = 0;
+            for (size_t i = 0; i < corners; i++) {
+                if (polygonX[i] < x1Box) {
+                    x1Box = polygonX[i];
+                } else if (polygonX[i] > x2Box) {
+                    x2Box = polygonX[i];
+                }
+                if (polygonY[i] < y1Box) {
+                    y1Box = polygonY[i];
+                } else if (polygonY[i] > y2Box) {
+                    y2Box = polygonY[i];
+                }
+            }
+
+            auto reference = [&](double x, double y) {
+                return referenceRegionContains(polygonX.data(), polygonY.data(), corners, x1Box, y1Box, x2Box, y2Box,
+                                               x, y);
+            };
+
+            std::vector<double> insideX;
+            std::vector<double> insideY;
+            double outsideX = 0;
+            double outsideY = 0;
+            bool foundOutside = false;
+            while (insideX.size() < 19 || !foundOutside) {
+                double x = unit(random) * 100;
+                double y = unit(random) * 100;
+                if (reference(x, y)) {
+                    insideX.push_back(x);
+                    insideY.push_back(y);
+                } else if (!foundOutside) {
+                    outsideX = x;
+                    outsideY = y;
+                    foundOutside = true;
+                }
+            }
+
+            for (Isa isa: {Isa::SCALAR, Isa::SSE2, Isa::AVX2}) {
+                if (!HitTest::setIsa(isa)) {
+                    continue;
+                }
+
+                for (size_t count = 1; count <= 19; count++) {
+                    std::vector<double> xs(insideX.begin(), insideX.begin() + count);
+                    std::vector<double> ys(insideY.begin(), insideY.begin() + count);
+                    CPPUNIT_ASSERT(regionContainsAll(xs, ys, x1Box, y1Box, x2Box, y2Box, edges));
+
+                    // The point outside as the last point, and as the first point
+                    xs.back() = outsideX;
+                    ys.back() = outsideY;
+                    CPPUNIT_ASSERT(!regionContainsAll(xs, ys, x1Box, y1Box, x2Box, y2Box, edges));
+
+                    std::swap(xs.front(), xs.back());
+                    std::swap(ys.front(), ys.back());
+                    CPPUNIT_ASSERT(!regionContainsAll(xs, ys, x1Box, y1Box, x2Box, y2Box, edges));
+                }
+
+                // Single points anywhere
+                for (int i = 0; i < 200; i++) {
+                    double x = unit(random) * 110 - 5;
+                    double y = unit(random) * 110 - 5;
+                    CPPUNIT_ASSERT_EQUAL(reference(x, y), regionContainsAll({x}, {y}, x1Box, y1Box, x2Box, y2Box,
+                                                                            edges));
+                }
+            }
+        }
+    }
+
+private:
+    /**
+     * The test of RegionSelect::containsAll()
+     */
+    static bool regionContainsAll(std::vector<double> const& xs, std::vector<double> const& ys, double x1Box,
+                                  double y1Box, double x2Box, double y2Box,
+                                  std::vector<HitTest::PolygonEdge> const& edges) {
+        return HitTest::allInBox(xs.data(), ys.data(), xs.size(), x1Box, y1Box, x2Box, y2Box) &&
+               HitTest::allInPolygon(xs.data(), ys.data(), xs.size(), edges);
+    }
+
+private:
+    Isa bestIsa = Isa::SCALAR;
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(HitTestTest);
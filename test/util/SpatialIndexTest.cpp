@@ -0,0 +1,168 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/Layer.h"
+#include "model/Stroke.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class SpatialIndexTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(SpatialIndexTest);
+
+    CPPUNIT_TEST(testQuery);
+    CPPUNIT_TEST(testDrawingOrder);
+    CPPUNIT_TEST(testRemove);
+    CPPUNIT_TEST(testBoundsChanged);
+    CPPUNIT_TEST(testOversized);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    /**
+     * A short stroke starting at (x, y)
+     */
+    static auto createStroke(double x, double y) -> Stroke* {
+        auto* s = new Stroke();
+        s->setWidth(1);
+        s->addPoint(Point(x, y));
+        s->addPoint(Point(x + 10, y + 5));
+        return s;
+    }
+
+    /**
+     * Fills the layer with a grid of 10 x 10 strokes, 100 pt apart, so that small areas are searched in the grid
+     */
+    static void fillLayer(Layer& layer, std::vector<Stroke*>& strokes) {
+        for (int i = 0; i < 100; i++) {
+            Stroke* s = createStroke(20 + (i % 10) * 100, 20 + (i / 10) * 100);
+            layer.addElement(s);
+            strokes.push_back(s);
+        }
+    }
+
+    static auto contains(const std::vector<Element*>& elements, Element* e) -> bool {
+        return std::find(elements.begin(), elements.end(), e) != elements.end();
+    }
+
+    void testQuery() {
+        Layer layer;
+        std::vector<Stroke*> strokes;
+        fillLayer(layer, strokes);
+
+        // Around stroke 34, at (420, 320)
+        auto found = layer.getElementsInArea(415, 315, 20, 15);
+        CPPUNIT_ASSERT(contains(found, strokes[34]));
+        CPPUNIT_ASSERT(found.size() < 10);
+        for (Element* e: found) {
+            // Only neighbours may be returned as part of the superset
+            CPPUNIT_ASSERT(std::abs(e->getX() - 420) <= 100 && std::abs(e->getY() - 320) <= 100);
+        }
+
+        // Empty area between the strokes
+        auto between = layer.getElementsInArea(360, 360, 10, 10);
+        CPPUNIT_ASSERT(!contains(between, strokes[34]));
+        CPPUNIT_ASSERT(!contains(between, strokes[0]));
+
+        // A large area returns everything
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(100), layer.getElementsInArea(0, 0, 1100, 1100).size());
+    }
+
+    void testDrawingOrder() {
+        Layer layer;
+        std::vector<Stroke*> strokes;
+        fillLayer(layer, strokes);
+
+        // Stacked on stroke 34, one below it and one above it
+        Stroke* below = createStroke(421, 321);
+        Stroke* above = createStroke(422, 322);
+        layer.insertElement(below, layer.indexOf(strokes[34]));
+        layer.addElement(above);
+
+        auto found = layer.getElementsInArea(415, 315, 20, 15);
+        auto posBelow = std::find(found.begin(), found.end(), below);
+        auto posStroke = std::find(found.begin(), found.end(), strokes[34]);
+        auto posAbove = std::find(found.begin(), found.end(), above);
+        CPPUNIT_ASSERT(posBelow != found.end());
+        CPPUNIT_ASSERT(posStroke != found.end());
+        CPPUNIT_ASSERT(posAbove != found.end());
+        CPPUNIT_ASSERT(posBelow < posStroke);
+        CPPUNIT_ASSERT(posStroke < posAbove);
+
+        // Same order as the element list of the layer
+        for (size_t i = 1; i < found.size(); i++) {
+            CPPUNIT_ASSERT(layer.indexOf(found[i - 1]) < layer.indexOf(found[i]));
+        }
+    }
+
+    void testRemove() {
+        Layer layer;
+        std::vector<Stroke*> strokes;
+        fillLayer(layer, strokes);
+
+        layer.removeElement(strokes[34], false);
+        CPPUNIT_ASSERT(!contains(layer.getElementsInArea(415, 315, 20, 15), strokes[34]));
+        delete strokes[34];
+        CPPUNIT_ASSERT(contains(layer.getElementsInArea(515, 315, 20, 15), strokes[35]));
+
+        // Adding it again after removing it
+        Stroke* s = createStroke(420, 320);
+        layer.addElement(s);
+        CPPUNIT_ASSERT(contains(layer.getElementsInArea(415, 315, 20, 15), s));
+    }
+
+    void testBoundsChanged() {
+        Layer layer;
+        std::vector<Stroke*> strokes;
+        fillLayer(layer, strokes);
+
+        // Moves stroke 34 into the empty area between the strokes
+        strokes[34]->move(-50, 40);
+        CPPUNIT_ASSERT(!contains(layer.getElementsInArea(415, 315, 20, 15), strokes[34]));
+        CPPUNIT_ASSERT(contains(layer.getElementsInArea(365, 355, 20, 15), strokes[34]));
+
+        // Points added to a stroke on the layer extend its bounds
+        strokes[0]->addPoint(Point(250, 20));
+        CPPUNIT_ASSERT(contains(layer.getElementsInArea(245, 15, 10, 10), strokes[0]));
+    }
+
+    void testOversized() {
+        Layer layer;
+        std::vector<Stroke*> strokes;
+        fillLayer(layer, strokes);
+
+        // Covers far more cells than an element is put into
+        auto* large = new Stroke();
+        large->setWidth(1);
+        large->addPoint(Point(0, 0));
+        large->addPoint(Point(5000, 5000));
+        layer.addElement(large);
+
+        CPPUNIT_ASSERT(contains(layer.getElementsInArea(415, 315, 20, 15), large));
+        CPPUNIT_ASSERT(contains(layer.getElementsInArea(4000, 100, 10, 10), large));
+
+        layer.removeElement(large, false);
+        CPPUNIT_ASSERT(!contains(layer.getElementsInArea(415, 315, 20, 15), large));
+        delete large;
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(SpatialIndexTest);
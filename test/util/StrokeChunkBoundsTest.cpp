@@ -0,0 +1,297 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/Stroke.h"
+#include "model/StrokeChunkBounds.h"
+#include "model/StrokePoints.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/**
+ * Stroke::intersects() as it was before, testing every point and segment of the stroke
+ */
+static auto referenceStrokeIntersects(const double* xs, const double* ys, size_t count, double x, double y,
+                                      double halfEraserSize, double* gap) -> bool {
+    if (count == 0) {
+        return false;
+    }
+
+    double x1 = x - halfEraserSize;
+    double x2 = x + halfEraserSize;
+    double y1 = y - halfEraserSize;
+    double y2 = y + halfEraserSize;
+
+    double lastX = xs[0];
+    double lastY = ys[0];
+    for (size_t i = 0; i < count; i++) {
+        double px = xs[i];
+        double py = ys[i];
+
+        if (px >= x1 && py >= y1 && px <= x2 && py <= y2) {
+            if (gap) {
+                *gap = 0;
+            }
+            return true;
+        }
+
+        double len = std::hypot(px - lastX, py - lastY);
+        if (len >= halfEraserSize) {
+            double p = std::abs((x - lastX) * (lastY - py) + (y - lastY) * (px - lastX)) / len;
+
+            if (p <= halfEraserSize) {
+                double centerX = (lastX + px) / 2;
+                double centerY = (lastY + py) / 2;
+                double distance = std::hypot(x - centerX, y - centerY);
+
+                distance -= halfEraserSize * std::sqrt(2);
+
+                constexpr double PADDING = 0.1;
+                if (distance <= len / 2 + PADDING) {
+                    if (gap) {
+                        *gap = distance;
+                    }
+                    return true;
+                }
+            }
+        }
+
+        lastX = px;
+        lastY = py;
+    }
+
+    return false;
+}
+
+class StrokeChunkBoundsTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(StrokeChunkBoundsTest);
+
+    CPPUNIT_TEST(testEmpty);
+    CPPUNIT_TEST(testSinglePoint);
+    CPPUNIT_TEST(testChunkBoundary);
+    CPPUNIT_TEST(testGroups);
+    CPPUNIT_TEST(testSameHitsAsAllPoints);
+    CPPUNIT_TEST(testMotion);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    void testEmpty() {
+        StrokePoints points;
+        StrokeChunkBounds bounds;
+        CPPUNIT_ASSERT(bounds.get(points).empty());
+
+        Stroke s;
+        CPPUNIT_ASSERT(!s.intersects(0, 0, 10));
+    }
+
+    void testSinglePoint() {
+        StrokePoints points;
+        points.push_back(Point(3, 4));
+
+        StrokeChunkBounds bounds;
+        auto const& chunks = bounds.get(points);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), chunks.size());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), chunks[0].first);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), chunks[0].end);
+        CPPUNIT_ASSERT_EQUAL(3.0, chunks[0].minX);
+        CPPUNIT_ASSERT_EQUAL(4.0, chunks[0].maxY);
+        CPPUNIT_ASSERT_EQUAL(0.0, chunks[0].maxSegmentLength);
+        CPPUNIT_ASSERT_EQUAL(0.0, chunks[0].distanceTo(3, 4));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, chunks[0].distanceTo(6, 8), 1e-9);
+
+        Stroke s;
+        s.addPoint(Point(3, 4));
+        CPPUNIT_ASSERT(s.intersects(3.5, 4.5, 1));
+        CPPUNIT_ASSERT(!s.intersects(10, 10, 1));
+    }
+
+    void testChunkBoundary() {
+        // One point more than a chunk, the last chunk has only the segment leading to its point
+        StrokePoints points;
+        for (size_t i = 0; i <= StrokeChunkBounds::CHUNK_SIZE; i++) {
+            points.push_back(Point(i, i == StrokeChunkBounds::CHUNK_SIZE ? 10 : 0));
+        }
+
+        StrokeChunkBounds bounds;
+        auto const& chunks = bounds.get(points);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), chunks.size());
+        CPPUNIT_ASSERT_EQUAL(StrokeChunkBounds::CHUNK_SIZE, chunks[0].end);
+        CPPUNIT_ASSERT_EQUAL(StrokeChunkBounds::CHUNK_SIZE, chunks[1].first);
+        CPPUNIT_ASSERT_EQUAL(StrokeChunkBounds::CHUNK_SIZE + 1, chunks[1].end);
+
+        // The box of the last chunk includes the previous point
+        CPPUNIT_ASSERT_EQUAL(static_cast<double>(StrokeChunkBounds::CHUNK_SIZE - 1), chunks[1].minX);
+        CPPUNIT_ASSERT_EQUAL(0.0, chunks[1].minY);
+        CPPUNIT_ASSERT_EQUAL(10.0, chunks[1].maxY);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(std::hypot(1.0, 10.0), chunks[1].maxSegmentLength, 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, chunks[0].maxSegmentLength, 1e-9);
+
+        // The segment crossing the chunk boundary is hit in its middle
+        Stroke s;
+        for (size_t i = 0; i < points.size(); i++) {
+            s.addPoint(points.get(i));
+        }
+        double gap = -1;
+        CPPUNIT_ASSERT(s.intersects(StrokeChunkBounds::CHUNK_SIZE - 0.5, 5, 1, &gap));
+        CPPUNIT_ASSERT(gap <= 0);
+
+        // Changing the points rebuilds the chunks
+        bounds.invalidate();
+        points.push_back(Point(100, 100));
+        CPPUNIT_ASSERT_EQUAL(100.0, bounds.get(points).back().maxX);
+    }
+
+    void testGroups() {
+        // One chunk more than a group
+        constexpr size_t count = StrokeChunkBounds::CHUNK_SIZE * StrokeChunkBounds::GROUP_SIZE + 1;
+        StrokePoints points;
+        for (size_t i = 0; i < count; i++) {
+            points.push_back(Point(i * 0.5, 20 * std::sin(i * 0.01)));
+        }
+
+        StrokeChunkBounds bounds;
+        auto const& chunks = bounds.get(points);
+        auto const& groups = bounds.getGroups(points);
+        CPPUNIT_ASSERT_EQUAL(StrokeChunkBounds::GROUP_SIZE + 1, chunks.size());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), groups.size());
+        CPPUNIT_ASSERT_EQUAL(StrokeChunkBounds::GROUP_SIZE, groups[0].end);
+        CPPUNIT_ASSERT_EQUAL(StrokeChunkBounds::GROUP_SIZE, groups[1].first);
+        CPPUNIT_ASSERT_EQUAL(chunks.size(), groups[1].end);
+
+        // Each group contains the bounds of its chunks
+        for (auto const& group: groups) {
+            for (size_t i = group.first; i < group.end; i++) {
+                CPPUNIT_ASSERT(group.minX <= chunks[i].minX && group.maxX >= chunks[i].maxX);
+                CPPUNIT_ASSERT(group.minY <= chunks[i].minY && group.maxY >= chunks[i].maxY);
+                CPPUNIT_ASSERT(group.maxSegmentLength >= chunks[i].maxSegmentLength);
+            }
+        }
+
+        // Only the chunks near the position are visited, the chunks of the first group are skipped by the group
+        Point last = points.get(count - 1);
+        int nearCalls = 0;
+        size_t visited = 0;
+        bool found = bounds.findChunk(
+                points,
+                [&](StrokeChunkBounds::Chunk const& chunk) {
+                    nearCalls++;
+                    return chunk.distanceTo(last.x, last.y) <= 0.1;
+                },
+                [&](StrokeChunkBounds::Chunk const& chunk) {
+                    visited = chunk.first;
+                    return true;
+                });
+        CPPUNIT_ASSERT(found);
+        CPPUNIT_ASSERT_EQUAL(count - 1, visited);
+        CPPUNIT_ASSERT_EQUAL(3, nearCalls);
+    }
+
+    /**
+     * Random strokes tested at 600000 random eraser positions give the same hits and gaps as testing all points
+     */
+    void testSameHitsAsAllPoints() {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<double> unit(0, 1);
+
+        for (int run = 0; run < 200; run++) {
+            // Around the chunk size, and a few long strokes
+            size_t count = run < 100 ? 1 + run % 70 : 1 + static_cast<size_t>(unit(random) * 500);
+
+            Stroke s;
+            double x = 50;
+            double y = 50;
+            for (size_t i = 0; i < count; i++) {
+                // Mostly short segments, some long ones
+                double length = unit(random) < 0.1 ? unit(random) * 30 : unit(random) * 2;
+                double angle = unit(random) * 2 * M_PI;
+                x += length * std::cos(angle);
+                y += length * std::sin(angle);
+                s.addPoint(Point(x, y));
+            }
+
+            StrokePoints const& points = s.getPointStorage();
+            for (int i = 0; i < 3000; i++) {
+                double ex = unit(random) * 100;
+                double ey = unit(random) * 100;
+                double h = 0.2 + unit(random) * 8;
+
+                double gap = -1;
+                double referenceGap = -1;
+                bool hit = s.intersects(ex, ey, h, &gap);
+                bool referenceHit =
+                        referenceStrokeIntersects(points.xData(), points.yData(), points.size(), ex, ey, h, &referenceGap);
+
+                CPPUNIT_ASSERT_EQUAL(referenceHit, hit);
+                CPPUNIT_ASSERT_EQUAL(referenceGap, gap);
+            }
+        }
+    }
+
+    /**
+     * The swept test finds every stroke hit at a position along the motion, and rejects strokes far away
+     */
+    void testMotion() {
+        std::mt19937 random(11);
+        std::uniform_real_distribution<double> unit(0, 1);
+
+        Stroke line;
+        line.addPoint(Point(0, 0));
+        line.addPoint(Point(100, 0));
+        CPPUNIT_ASSERT(line.mayIntersectMotion(50, -20, 50, 20, 1));
+        CPPUNIT_ASSERT(!line.mayIntersectMotion(0, 20, 100, 20, 1));
+
+        int rejected = 0;
+        for (int run = 0; run < 20000; run++) {
+            Stroke s;
+            double x = unit(random) * 100;
+            double y = unit(random) * 100;
+            size_t count = 1 + static_cast<size_t>(unit(random) * 80);
+            for (size_t i = 0; i < count; i++) {
+                s.addPoint(Point(x, y));
+                x += (unit(random) - 0.5) * 10;
+                y += (unit(random) - 0.5) * 10;
+            }
+
+            double fromX = unit(random) * 100;
+            double fromY = unit(random) * 100;
+            double toX = fromX + (unit(random) - 0.5) * 40;
+            double toY = fromY + (unit(random) - 0.5) * 40;
+            double h = 0.5 + unit(random) * 5;
+
+            // The positions of EraseHandler::erase()
+            int steps = std::max(1, static_cast<int>(std::ceil(std::hypot(toX - fromX, toY - fromY) / h)));
+            bool hit = false;
+            for (int i = 0; i <= steps && !hit; i++) {
+                hit = s.intersects(fromX + (toX - fromX) * i / steps, fromY + (toY - fromY) * i / steps, h);
+            }
+
+            bool mayHit = s.mayIntersectMotion(fromX, fromY, toX, toY, h);
+            CPPUNIT_ASSERT(!hit || mayHit);
+            rejected += mayHit ? 0 : 1;
+        }
+
+        CPPUNIT_ASSERT(rejected > 10000);
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(StrokeChunkBoundsTest);
@@ -0,0 +1,186 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/Stroke.h"
+#include "model/StrokeRenderCache.h"
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class StrokeRenderCacheTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(StrokeRenderCacheTest);
+
+#ifdef TEST_CHECK_SPEED
+    CPPUNIT_TEST(testSpeedZoomedOut);
+#endif
+
+    CPPUNIT_TEST(testLevelOfDetail);
+    CPPUNIT_TEST(testSimplifyErrorBound);
+    CPPUNIT_TEST(testSimplifyKeepsEndpoints);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+#ifdef TEST_CHECK_SPEED
+    /**
+     * 1000 strokes with 1000 points each drawn at 25% and 10% zoom, with all points and with each level
+     */
+    void testSpeedZoomedOut() {
+        std::vector<std::unique_ptr<Stroke>> strokes;
+        for (int i = 0; i < 1000; i++) {
+            auto s = std::make_unique<Stroke>();
+            s->setWidth(1.4);
+            for (int j = 0; j < 1000; j++) {
+                s->addPoint(Point(20 + (i % 20) * 28 + j * 0.025, 20 + (i / 20) * 16 + 4 * std::sin(j * 0.1),
+                                  1 + 0.4 * std::sin(j * 0.05)));
+            }
+            strokes.push_back(std::move(s));
+        }
+
+        for (double zoom: {0.25, 0.1}) {
+            cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 600, 850);
+            cairo_t* cr = cairo_create(surface);
+            cairo_scale(cr, zoom, zoom);
+            cairo_set_line_width(cr, 1.4);
+            cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
+            cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+
+            int chosen = StrokeRenderCache::getLevel(zoom);
+            for (int level = 0; level < StrokeRenderCache::LOD_LEVELS; level++) {
+                size_t count = 0;
+                SpeedTest speed;
+                speed.startTest("draw 1000 strokes 10 times at " + std::to_string(static_cast<int>(zoom * 100)) +
+                                "% zoom with level " + std::to_string(level) + (level == chosen ? " (chosen)" : ""));
+
+                for (int run = 0; run < 10; run++) {
+                    for (auto& s: strokes) {
+                        auto points = level > 0 ? s->getRenderCache().getSimplified(s->getPointStorage(), level) :
+                                                  s->getRenderCache().getPointVector(s->getPointStorage());
+                        count += points->size();
+                        cairo_move_to(cr, points->front().x, points->front().y);
+                        for (Point const& p: *points) {
+                            cairo_line_to(cr, p.x, p.y);
+                        }
+                        cairo_stroke(cr);
+                    }
+                }
+
+                speed.endTest();
+                std::cout << count / 10 << " points" << std::endl;
+            }
+
+            cairo_destroy(cr);
+            cairo_surface_destroy(surface);
+        }
+    }
+#endif
+
+    void testLevelOfDetail() {
+        // All points at 100% zoom and above
+        CPPUNIT_ASSERT_EQUAL(0, StrokeRenderCache::getLevel(1.0));
+        CPPUNIT_ASSERT_EQUAL(0, StrokeRenderCache::getLevel(2.0));
+
+        CPPUNIT_ASSERT_EQUAL(1, StrokeRenderCache::getLevel(0.5));
+        CPPUNIT_ASSERT_EQUAL(2, StrokeRenderCache::getLevel(0.25));
+        CPPUNIT_ASSERT_EQUAL(4, StrokeRenderCache::getLevel(0.1));
+        CPPUNIT_ASSERT_EQUAL(StrokeRenderCache::LOD_LEVELS - 1, StrokeRenderCache::getLevel(0.01));
+
+        // The chosen level deviates less than a device pixel, and at least half a pixel below 100% zoom
+        for (double scale = 0.01; scale < 3; scale *= 1.1) {
+            int level = StrokeRenderCache::getLevel(scale);
+            double deviation = StrokeRenderCache::getTolerance(level) * scale;
+            CPPUNIT_ASSERT(deviation < 1);
+            if (scale < 1 && level < StrokeRenderCache::LOD_LEVELS - 1) {
+                CPPUNIT_ASSERT(deviation >= 0.5);
+            }
+        }
+    }
+
+    void testSimplifyErrorBound() {
+        Stroke s;
+        for (int j = 0; j < 1000; j++) {
+            s.addPoint(Point(j * 0.1, 10 * std::sin(j * 0.02)));
+        }
+
+        for (int level = 1; level < StrokeRenderCache::LOD_LEVELS; level++) {
+            auto simplified = s.getRenderCache().getSimplified(s.getPointStorage(), level);
+            CPPUNIT_ASSERT(simplified->size() < 1000);
+            CPPUNIT_ASSERT(simplified->size() >= 2);
+
+            // Every point is within the tolerance of the simplified line
+            double tolerance = StrokeRenderCache::getTolerance(level);
+            for (Point const& p: s.getPointVector()) {
+                double distance = distanceToLine(*simplified, p);
+                CPPUNIT_ASSERT(distance <= tolerance + 1e-9);
+            }
+        }
+    }
+
+    void testSimplifyKeepsEndpoints() {
+        Stroke s;
+        s.addPoint(Point(0, 0, 1.0));
+        for (int j = 1; j < 100; j++) {
+            s.addPoint(Point(j, 0, 1.0));
+        }
+        s.addPoint(Point(100, 0, 1.0));
+
+        auto simplified = s.getRenderCache().getSimplified(s.getPointStorage(), 1);
+
+        // A straight line with constant pressure is reduced to its endpoints
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), simplified->size());
+        CPPUNIT_ASSERT_EQUAL(0.0, simplified->front().x);
+        CPPUNIT_ASSERT_EQUAL(100.0, simplified->back().x);
+        CPPUNIT_ASSERT_EQUAL(1.0, simplified->back().z);
+
+        // Strokes with two points stay unchanged
+        Stroke shortStroke;
+        shortStroke.addPoint(Point(1, 2));
+        shortStroke.addPoint(Point(3, 4));
+        auto two = shortStroke.getRenderCache().getSimplified(shortStroke.getPointStorage(), 3);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), two->size());
+        CPPUNIT_ASSERT_EQUAL(1.0, two->front().x);
+        CPPUNIT_ASSERT_EQUAL(4.0, two->back().y);
+    }
+
+private:
+    static double distanceToLine(std::vector<Point> const& line, Point const& p) {
+        double result = std::hypot(p.x - line.front().x, p.y - line.front().y);
+        for (size_t i = 1; i < line.size(); i++) {
+            Point const& a = line[i - 1];
+            Point const& b = line[i];
+            double dx = b.x - a.x;
+            double dy = b.y - a.y;
+            double len2 = dx * dx + dy * dy;
+            double t = len2 > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2 : 0;
+            t = std::max(0.0, std::min(1.0, t));
+            result = std::min(result, std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy)));
+        }
+        return result;
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(StrokeRenderCacheTest);
@@ -0,0 +1,136 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/PageRef.h"
+#include "view/background/BackgroundConfig.h"
+#include "view/background/BackgroundPatternCache.h"
+#include "view/background/DottedBackgroundPainter.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class BackgroundPatternCacheTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(BackgroundPatternCacheTest);
+
+    CPPUNIT_TEST(testHit);
+    CPPUNIT_TEST(testEvictLeastRecentlyUsed);
+    CPPUNIT_TEST(testCreateFailed);
+    CPPUNIT_TEST(testColorChangeRendersNewCell);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    /**
+     * The cache is shared by all tests, so each test uses its own keys
+     */
+    static cairo_surface_t* get(std::string const& key, int& created) {
+        return BackgroundPatternCache::getInstance().get(key, [&created]() {
+            created++;
+            return cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 4, 4);
+        });
+    }
+
+    void testHit() {
+        int created = 0;
+        cairo_surface_t* first = get("hit/a", created);
+        cairo_surface_t* second = get("hit/a", created);
+        CPPUNIT_ASSERT(first != nullptr);
+        CPPUNIT_ASSERT(first == second);
+        CPPUNIT_ASSERT_EQUAL(1, created);
+
+        // Another key is another cell
+        cairo_surface_t* other = get("hit/b", created);
+        CPPUNIT_ASSERT(other != first);
+        CPPUNIT_ASSERT_EQUAL(2, created);
+
+        cairo_surface_destroy(first);
+        cairo_surface_destroy(second);
+        cairo_surface_destroy(other);
+    }
+
+    void testEvictLeastRecentlyUsed() {
+        int created = 0;
+        cairo_surface_destroy(get("evict/used", created));
+        cairo_surface_destroy(get("evict/unused", created));
+
+        // Keeps "used" recently used while many other cells are added
+        for (int i = 0; i < 100; i++) {
+            cairo_surface_destroy(get("evict/" + std::to_string(i), created));
+            cairo_surface_destroy(get("evict/used", created));
+        }
+        CPPUNIT_ASSERT_EQUAL(102, created);
+
+        cairo_surface_destroy(get("evict/used", created));
+        CPPUNIT_ASSERT_EQUAL(102, created);
+
+        cairo_surface_destroy(get("evict/unused", created));
+        CPPUNIT_ASSERT_EQUAL(103, created);
+    }
+
+    void testCreateFailed() {
+        CPPUNIT_ASSERT(BackgroundPatternCache::getInstance().get("failed", []() { return nullptr; }) == nullptr);
+
+        // Not cached, the next call tries again
+        int created = 0;
+        cairo_surface_t* surface = get("failed", created);
+        CPPUNIT_ASSERT(surface != nullptr);
+        CPPUNIT_ASSERT_EQUAL(1, created);
+        cairo_surface_destroy(surface);
+    }
+
+    /**
+     * @return the pixel at the first dot of a dotted background drawn in color
+     */
+    static uint32_t paintDotted(std::string const& color) {
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+        cairo_t* cr = cairo_create(surface);
+
+        PageRef page = std::make_shared<XojPage>(100, 100);
+        BackgroundConfig config("f1=" + color);
+        DottedBackgroundPainter dotted;
+        BaseBackgroundPainter& painter = dotted;
+        painter.paint(cr, page, &config);
+
+        cairo_destroy(cr);
+        cairo_surface_flush(surface);
+
+        // The first dot is at (14.17, 14.17)
+        unsigned char* data = cairo_image_surface_get_data(surface);
+        int stride = cairo_image_surface_get_stride(surface);
+        uint32_t pixel = *reinterpret_cast<uint32_t*>(data + 14 * stride + 14 * 4);
+
+        cairo_surface_destroy(surface);
+        return pixel;
+    }
+
+    void testColorChangeRendersNewCell() {
+        uint32_t red = paintDotted("ff0000");
+        uint32_t blue = paintDotted("0000ff");
+
+        CPPUNIT_ASSERT(((red >> 16) & 0xff) > (red & 0xff));
+        CPPUNIT_ASSERT((blue & 0xff) > ((blue >> 16) & 0xff));
+
+        // Painting red again uses the cached cell, with the same result
+        CPPUNIT_ASSERT_EQUAL(red, paintDotted("ff0000"));
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(BackgroundPatternCacheTest);
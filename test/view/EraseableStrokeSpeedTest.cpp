@@ -0,0 +1,91 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/Stroke.h"
+#include "model/eraser/EraseableStroke.h"
+
+#include "Range.h"
+#include "SpeedTest.cpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/**
+ * Counts all allocations of this executable. It is built on its own, so the other tests keep the default operator new.
+ */
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+class EraseableStrokeSpeedTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(EraseableStrokeSpeedTest);
+
+    CPPUNIT_TEST(testSpeedEraseThousandStrokes);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    /**
+     * 1000 strokes with 200 points each, erased along a line through the page
+     */
+    void testSpeedEraseThousandStrokes() {
+        std::vector<std::unique_ptr<Stroke>> strokes;
+        std::vector<std::unique_ptr<EraseableStroke>> eraseables;
+        for (int i = 0; i < 1000; i++) {
+            auto s = std::make_unique<Stroke>();
+            s->setWidth(1.4);
+            for (int j = 0; j < 200; j++) {
+                s->addPoint(Point(20 + (i % 20) * 28 + j * 0.12, 20 + (i / 20) * 16 + 4 * std::sin(j * 0.3)));
+            }
+            eraseables.push_back(std::make_unique<EraseableStroke>(s.get()));
+            strokes.push_back(std::move(s));
+        }
+
+        size_t allocationsBefore = allocations;
+
+        SpeedTest speed;
+        speed.startTest("erase 1000 strokes with 200 points at 400 positions");
+
+        for (int step = 0; step < 400; step++) {
+            for (auto& e: eraseables) {
+                delete e->erase(20 + step * 1.5, 20 + step * 2.0, 3);
+            }
+        }
+
+        speed.endTest();
+        std::cout << allocations - allocationsBefore << " allocations" << std::endl;
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(EraseableStrokeSpeedTest);
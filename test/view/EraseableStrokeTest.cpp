@@ -0,0 +1,275 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/Stroke.h"
+#include "model/eraser/EraseableStroke.h"
+
+#include "Range.h"
+
+#include <cmath>
+#include <list>
+#include <random>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/**
+ * The erase algorithm of the implementation with a GList of parts, kept to compare the results against
+ */
+class ReferenceEraseableStroke {
+public:
+    explicit ReferenceEraseableStroke(Stroke const& stroke) {
+        for (int i = 1; i < stroke.getPointCount(); i++) {
+            Point a = stroke.getPoint(i - 1);
+            this->parts.push_back(Part{{a, stroke.getPoint(i)}, a.z, 0});
+        }
+    }
+
+    void erase(double x, double y, double halfEraserSize) {
+        for (auto it = this->parts.begin(); it != this->parts.end();) {
+            auto current = it++;
+            erasePart(x, y, halfEraserSize, current);
+        }
+    }
+
+    /**
+     * The points of the strokes EraseableStroke::getStroke() creates
+     */
+    auto getStrokes() const -> std::vector<std::vector<Point>> {
+        std::vector<std::vector<Point>> strokes;
+        Point lastPoint(NAN, NAN);
+        for (Part const& part: this->parts) {
+            if (part.points.size() < 2) {
+                continue;
+            }
+
+            Point a = part.points.front();
+            a.z = part.width;
+            if (!lastPoint.equalsPos(a) || strokes.empty()) {
+                if (!strokes.empty()) {
+                    strokes.back().push_back(lastPoint);
+                }
+                strokes.emplace_back();
+            }
+            strokes.back().push_back(a);
+            lastPoint = part.points.back();
+        }
+        if (!strokes.empty()) {
+            strokes.back().push_back(lastPoint);
+        }
+        return strokes;
+    }
+
+private:
+    struct Part {
+        std::vector<Point> points;
+        double width;
+        double splitSize;
+    };
+
+    static auto inBox(Point const& p, double x, double y, double halfEraserSize) -> bool {
+        return p.x >= x - halfEraserSize && p.y >= y - halfEraserSize && p.x <= x + halfEraserSize &&
+               p.y <= y + halfEraserSize;
+    }
+
+    /**
+     * Parts inserted after it are not visited again by the same erase
+     */
+    void erasePart(double x, double y, double halfEraserSize, std::list<Part>::iterator it) {
+        Part& part = *it;
+        if (part.points.size() < 2) {
+            return;
+        }
+
+        Point eraser(x, y);
+        Point a = part.points.front();
+        Point b = part.points.back();
+
+        if (eraser.lineLengthTo(a) < halfEraserSize * 1.2 && eraser.lineLengthTo(b) < halfEraserSize * 1.2) {
+            this->parts.erase(it);
+            return;
+        }
+
+        bool hit = inBox(a, x, y, halfEraserSize) || inBox(b, x, y, halfEraserSize);
+        if (!hit) {
+            double len = std::hypot(b.x - a.x, b.y - a.y);
+            double p = std::abs((x - a.x) * (a.y - b.y) + (y - a.y) * (b.x - a.x)) / len;
+            if (p <= halfEraserSize) {
+                double distance = std::hypot(x - (a.x + b.x) / 2, y - (a.y + b.y) / 2);
+                distance -= halfEraserSize * std::sqrt(2);
+                hit = distance <= len / 2 + 0.1;
+            }
+        }
+        if (!hit) {
+            return;
+        }
+
+        if (halfEraserSize != part.splitSize) {
+            part.splitSize = halfEraserSize;
+            double len = a.lineLengthTo(b);
+            if (len > halfEraserSize) {
+                part.points = {a, b};
+                double step = halfEraserSize / 2;
+                while (len > step) {
+                    part.points.insert(part.points.begin() + 1, a.lineTo(b, len));
+                    len -= step;
+                }
+            }
+        }
+
+        std::vector<std::vector<Point>> runs(1);
+        for (Point const& p: part.points) {
+            if (!inBox(p, x, y, halfEraserSize)) {
+                runs.back().push_back(p);
+            } else if (!runs.back().empty()) {
+                runs.emplace_back();
+            }
+        }
+        if (runs.back().empty()) {
+            runs.pop_back();
+        }
+
+        if (runs.empty()) {
+            this->parts.erase(it);
+            return;
+        }
+
+        part.points = runs[0];
+        auto pos = std::next(it);
+        for (size_t i = 1; i < runs.size(); i++) {
+            this->parts.insert(pos, Part{runs[i], part.width, 0});
+        }
+    }
+
+private:
+    std::list<Part> parts;
+};
+
+class EraseableStrokeTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(EraseableStrokeTest);
+
+    CPPUNIT_TEST(testEraseMiddle);
+    CPPUNIT_TEST(testEraseAll);
+    CPPUNIT_TEST(testSameAsReference);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    void testEraseMiddle() {
+        Stroke s;
+        for (int i = 0; i <= 10; i++) {
+            s.addPoint(Point(i * 10, 0));
+        }
+
+        EraseableStroke e(&s);
+        Range* range = e.erase(50, 0, 2);
+        CPPUNIT_ASSERT(range != nullptr);
+        CPPUNIT_ASSERT(range->getX() <= 48 && range->getX2() >= 52);
+        delete range;
+
+        GList* parts = e.getStroke(&s);
+        CPPUNIT_ASSERT_EQUAL(2U, g_list_length(parts));
+
+        auto* first = static_cast<Stroke*>(parts->data);
+        auto* second = static_cast<Stroke*>(parts->next->data);
+        CPPUNIT_ASSERT_EQUAL(0.0, first->getPoint(0).x);
+        CPPUNIT_ASSERT(first->getPoint(first->getPointCount() - 1).x < 48);
+        CPPUNIT_ASSERT(second->getPoint(0).x > 52);
+        CPPUNIT_ASSERT_EQUAL(100.0, second->getPoint(second->getPointCount() - 1).x);
+
+        for (GList* l = parts; l != nullptr; l = l->next) {
+            delete static_cast<Stroke*>(l->data);
+        }
+        g_list_free(parts);
+
+        // Nothing left to erase there
+        CPPUNIT_ASSERT(e.erase(50, 0, 2) == nullptr);
+    }
+
+    void testEraseAll() {
+        Stroke s;
+        s.addPoint(Point(0, 0));
+        s.addPoint(Point(1, 1));
+
+        EraseableStroke e(&s);
+        delete e.erase(0.5, 0.5, 5);
+
+        CPPUNIT_ASSERT(e.getStroke(&s) == nullptr);
+    }
+
+    /**
+     * Random strokes erased at random positions with changing eraser sizes, so parts are split again
+     */
+    void testSameAsReference() {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<double> unit(0, 1);
+
+        for (int sequence = 0; sequence < 400; sequence++) {
+            Stroke s;
+            s.setWidth(1.4);
+            bool pressure = sequence % 2 == 1;
+            double x = 100;
+            double y = 100;
+            int count = 2 + static_cast<int>(unit(random) * 59);
+            for (int i = 0; i < count; i++) {
+                x += unit(random) * 12 - 6;
+                y += unit(random) * 12 - 6;
+                s.addPoint(Point(x, y, pressure ? 0.5 + unit(random) * 2 : Point::NO_PRESSURE));
+            }
+
+            EraseableStroke eraseable(&s);
+            ReferenceEraseableStroke reference(s);
+
+            for (int step = 0; step < 10; step++) {
+                Point near = s.getPoint(static_cast<int>(unit(random) * count));
+                double eraserX = near.x + unit(random) * 8 - 4;
+                double eraserY = near.y + unit(random) * 8 - 4;
+                double halfEraserSize = 1 + static_cast<int>(unit(random) * 3);
+
+                delete eraseable.erase(eraserX, eraserY, halfEraserSize);
+                reference.erase(eraserX, eraserY, halfEraserSize);
+
+                assertSameStrokes(reference.getStrokes(), eraseable.getStroke(&s));
+            }
+        }
+    }
+
+private:
+    /**
+     * Compares and frees the strokes
+     */
+    static void assertSameStrokes(std::vector<std::vector<Point>> const& expected, GList* strokes) {
+        CPPUNIT_ASSERT_EQUAL(static_cast<guint>(expected.size()), g_list_length(strokes));
+
+        size_t i = 0;
+        for (GList* l = strokes; l != nullptr; l = l->next, i++) {
+            auto* s = static_cast<Stroke*>(l->data);
+            CPPUNIT_ASSERT_EQUAL(static_cast<int>(expected[i].size()), s->getPointCount());
+            for (int j = 0; j < s->getPointCount(); j++) {
+                Point p = s->getPoint(j);
+                CPPUNIT_ASSERT_EQUAL(expected[i][j].x, p.x);
+                CPPUNIT_ASSERT_EQUAL(expected[i][j].y, p.y);
+                CPPUNIT_ASSERT_EQUAL(expected[i][j].z, p.z);
+            }
+            delete s;
+        }
+        g_list_free(strokes);
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(EraseableStrokeTest);
@@ -0,0 +1,200 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/Stroke.h"
+#include "view/DocumentView.h"
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class StrokeViewTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(StrokeViewTest);
+
+#ifdef TEST_CHECK_SPEED
+    CPPUNIT_TEST(testSpeedMillionPoints);
+#endif
+
+    CPPUNIT_TEST(testPointsWithoutPressure);
+    CPPUNIT_TEST(testPointsWithPressure);
+    CPPUNIT_TEST(testCloneSharesPoints);
+    CPPUNIT_TEST(testPressureOutline);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+#ifdef TEST_CHECK_SPEED
+    /**
+     * 1000 strokes with 1000 points each, like a page of handwriting without pressure
+     */
+    void testSpeedMillionPoints() {
+        std::vector<std::unique_ptr<Stroke>> strokes;
+        size_t storage = 0;
+        for (int i = 0; i < 1000; i++) {
+            auto s = std::make_unique<Stroke>();
+            s->setWidth(1.4);
+            for (int j = 0; j < 1000; j++) {
+                s->addPoint(Point(20 + (i % 20) * 28 + j * 0.025, 20 + (i / 20) * 16 + 4 * std::sin(j * 0.1)));
+            }
+            s->freeUnusedPointItems();
+            storage += s->getPointStorage().getMemoryUsage();
+            strokes.push_back(std::move(s));
+        }
+
+        std::cout << std::endl
+                  << "Point storage: " << storage / 1024 << " KiB, as Point array: "
+                  << static_cast<size_t>(1000 * 1000) * sizeof(Point) / 1024 << " KiB" << std::endl;
+
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 600, 850);
+        cairo_t* cr = cairo_create(surface);
+        DocumentView view;
+
+        SpeedTest speed;
+        speed.startTest("draw 1000 strokes with 1000 points 10 times");
+
+        for (int run = 0; run < 10; run++) {
+            for (auto& s: strokes) {
+                view.drawStroke(cr, s.get());
+            }
+        }
+
+        speed.endTest();
+
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+    }
+#endif
+
+    void testPointsWithoutPressure() {
+        Stroke s;
+        s.addPoint(Point(1, 2));
+        s.addPoint(Point(3, 4));
+        s.addPoint(Point(5, 6));
+
+        CPPUNIT_ASSERT(!s.hasPressure());
+        CPPUNIT_ASSERT(!s.getPointStorage().hasPressureArray());
+        CPPUNIT_ASSERT_EQUAL(3, s.getPointCount());
+        CPPUNIT_ASSERT_EQUAL(Point::NO_PRESSURE, s.getPoint(1).z);
+
+        s.deletePoint(1);
+        std::vector<Point> const& points = s.getPointVector();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), points.size());
+        CPPUNIT_ASSERT_EQUAL(5.0, points[1].x);
+        CPPUNIT_ASSERT_EQUAL(6.0, points[1].y);
+        CPPUNIT_ASSERT_EQUAL(s.getPoints()[0].x, 1.0);
+    }
+
+    void testPointsWithPressure() {
+        Stroke s;
+        s.addPoint(Point(1, 2));
+        s.addPoint(Point(3, 4));
+        s.setPressure({0.5});
+
+        CPPUNIT_ASSERT(s.hasPressure());
+        CPPUNIT_ASSERT_EQUAL(0.5, s.getPoint(0).z);
+        CPPUNIT_ASSERT_EQUAL(Point::NO_PRESSURE, s.getPoint(1).z);
+
+        s.move(1, 1);
+        CPPUNIT_ASSERT_EQUAL(2.0, s.getPointVector()[0].x);
+        CPPUNIT_ASSERT_EQUAL(0.5, s.getPointVector()[0].z);
+
+        s.clearPressure();
+        CPPUNIT_ASSERT(!s.hasPressure());
+        CPPUNIT_ASSERT(!s.getPointStorage().hasPressureArray());
+    }
+
+    void testCloneSharesPoints() {
+        Stroke s;
+        s.addPoint(Point(1, 2));
+        s.addPoint(Point(3, 4));
+
+        std::unique_ptr<Stroke> copy(s.cloneStroke());
+        CPPUNIT_ASSERT(copy->getPointStorage().xData() == s.getPointStorage().xData());
+        CPPUNIT_ASSERT(&copy->getRenderCache() == &s.getRenderCache());
+
+        // Changing the original leaves the copy with the old points and its own cache
+        s.move(1, 1);
+        CPPUNIT_ASSERT(copy->getPointStorage().xData() != s.getPointStorage().xData());
+        CPPUNIT_ASSERT(&copy->getRenderCache() != &s.getRenderCache());
+        CPPUNIT_ASSERT_EQUAL(1.0, copy->getPointVector()[0].x);
+        CPPUNIT_ASSERT_EQUAL(2.0, s.getPointVector()[0].x);
+    }
+
+    /**
+     * The outline covers the same pixels as the segments stroked one by one with round caps,
+     * with sharp turns, a turn back and a crossing
+     */
+    void testPressureOutline() {
+        Stroke s;
+        std::vector<Point> points{{10, 10}, {40, 12}, {15, 30}, {45, 45}, {45, 20}, {45, 40}, {20, 5}, {20, 50}};
+        for (Point const& p: points) {
+            s.addPoint(p);
+        }
+        s.setPressure(std::vector<double>(points.size() - 1, 3.0));
+
+        cairo_surface_t* outline = cairo_image_surface_create(CAIRO_FORMAT_A8, 240, 240);
+        cairo_t* cr = cairo_create(outline);
+        cairo_scale(cr, 4, 4);
+        DocumentView view;
+        view.drawStroke(cr, &s, 0, 1, false);
+        cairo_destroy(cr);
+
+        cairo_surface_t* segments = cairo_image_surface_create(CAIRO_FORMAT_A8, 240, 240);
+        cr = cairo_create(segments);
+        cairo_scale(cr, 4, 4);
+        cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+        cairo_set_line_width(cr, 3.0);
+        for (size_t i = 1; i < points.size(); i++) {
+            cairo_move_to(cr, points[i - 1].x, points[i - 1].y);
+            cairo_line_to(cr, points[i].x, points[i].y);
+            cairo_stroke(cr);
+        }
+        cairo_destroy(cr);
+
+        cairo_surface_flush(outline);
+        cairo_surface_flush(segments);
+        int stride = cairo_image_surface_get_stride(outline);
+        unsigned char* a = cairo_image_surface_get_data(outline);
+        unsigned char* b = cairo_image_surface_get_data(segments);
+        int covered = 0;
+        int different = 0;
+        for (int y = 0; y < 240; y++) {
+            for (int x = 0; x < 240; x++) {
+                int alphaA = a[y * stride + x];
+                int alphaB = b[y * stride + x];
+                covered += alphaB > 128;
+                // Only the antialiasing of the edges may differ
+                different += std::abs(alphaA - alphaB) > 128;
+            }
+        }
+        CPPUNIT_ASSERT(covered > 1000);
+        CPPUNIT_ASSERT(different * 100 < covered);
+
+        cairo_surface_destroy(outline);
+        cairo_surface_destroy(segments);
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(StrokeViewTest);
@@ -0,0 +1,77 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/TexRenderCache.h"
+
+#include <cstdint>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TexRenderCacheTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TexRenderCacheTest);
+
+    CPPUNIT_TEST(testPaintOverBackground);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    static uint32_t pixel(cairo_surface_t* surface, int x, int y) {
+        cairo_surface_flush(surface);
+        unsigned char* data = cairo_image_surface_get_data(surface);
+        int stride = cairo_image_surface_get_stride(surface);
+        return reinterpret_cast<uint32_t*>(data + y * stride)[x];
+    }
+
+    void testPaintOverBackground() {
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 40, 30);
+        cairo_t* cr = cairo_create(surface);
+
+        // Fill the background, and leave the operator as the page background painter does
+        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_paint(cr);
+
+        int renderCount = 0;
+
+        // The formula covers only the left half of its 20 x 10 rectangle, the rest is transparent
+        auto render = [&renderCount](cairo_t* crTex) {
+            renderCount++;
+            cairo_set_source_rgb(crTex, 0, 0, 0);
+            cairo_rectangle(crTex, 0, 0, 10, 10);
+            cairo_fill(crTex);
+        };
+
+        TexRenderCache cache;
+        for (int run = 0; run < 2; run++) {
+            CPPUNIT_ASSERT(cache.paint(cr, 10, 10, 20, 10, render));
+
+            CPPUNIT_ASSERT_EQUAL(0xff000000U, pixel(surface, 12, 15));
+            CPPUNIT_ASSERT_EQUAL(0xffffffffU, pixel(surface, 25, 15));
+            CPPUNIT_ASSERT_EQUAL(0xffffffffU, pixel(surface, 5, 5));
+        }
+
+        // The second paint used the cached rendering
+        CPPUNIT_ASSERT_EQUAL(1, renderCount);
+        CPPUNIT_ASSERT_EQUAL(CAIRO_OPERATOR_SOURCE, cairo_get_operator(cr));
+
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(TexRenderCacheTest);
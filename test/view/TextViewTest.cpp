@@ -0,0 +1,153 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/Text.h"
+#include "view/TextView.h"
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+#include <memory>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TextViewTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TextViewTest);
+
+#ifdef TEST_CHECK_SPEED
+    CPPUNIT_TEST(testSpeedRerender);
+#endif
+
+    CPPUNIT_TEST(testCachedSize);
+    CPPUNIT_TEST(testFontChangedByReference);
+    CPPUNIT_TEST(testOtherThread);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+#ifdef TEST_CHECK_SPEED
+    void testSpeedRerender() {
+        std::vector<std::unique_ptr<Text>> texts;
+        for (int i = 0; i < 500; i++) {
+            auto t = std::make_unique<Text>();
+            t->setText("Text box " + std::to_string(i) + "\nwith a second line of typed notes");
+            t->setX(20 + (i % 5) * 110);
+            t->setY(20 + (i / 5) * 8);
+            texts.push_back(std::move(t));
+        }
+
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 600, 850);
+        cairo_t* cr = cairo_create(surface);
+
+        SpeedTest speed;
+        speed.startTest("rerender a page with 500 text boxes 20 times");
+
+        for (int run = 0; run < 20; run++) {
+            for (auto& t: texts) {
+                TextView::drawText(cr, t.get());
+            }
+        }
+
+        speed.endTest();
+
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+    }
+#endif
+
+    void testCachedSize() {
+        Text t;
+        t.setText("Hello\nWorld");
+
+        double width = 0;
+        double height = 0;
+        TextView::calcSize(&t, width, height);
+
+        // The same size as measured without cache, like the TextEditor does
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+        cairo_t* cr = cairo_create(surface);
+        PangoLayout* layout = TextView::initPango(cr, &t);
+        pango_layout_set_text(layout, "Hello\nWorld", -1);
+        int w = 0;
+        int h = 0;
+        pango_layout_get_size(layout, &w, &h);
+        g_object_unref(layout);
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+
+        CPPUNIT_ASSERT(width > 0);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(static_cast<double>(w) / PANGO_SCALE, width, 0.001);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(static_cast<double>(h) / PANGO_SCALE, height, 0.001);
+
+        t.setText("Hello");
+        double shortWidth = 0;
+        TextView::calcSize(&t, shortWidth, height);
+        CPPUNIT_ASSERT(shortWidth < width + 0.001);
+    }
+
+    void testFontChangedByReference() {
+        Text t;
+        t.setText("Hello");
+
+        double width = 0;
+        double height = 0;
+        TextView::calcSize(&t, width, height);
+
+        t.getFont().setSize(t.getFontSize() * 2);
+
+        double biggerWidth = 0;
+        double biggerHeight = 0;
+        TextView::calcSize(&t, biggerWidth, biggerHeight);
+
+        CPPUNIT_ASSERT(biggerWidth > width);
+        CPPUNIT_ASSERT(biggerHeight > height);
+    }
+
+    void testOtherThread() {
+        Text t;
+        t.setText("Hello\nWorld");
+
+        double width = 0;
+        double height = 0;
+        TextView::calcSize(&t, width, height);
+
+        // Another thread uses the layout of the render threads, with the same size
+        struct Result {
+            Text* text;
+            double width;
+            double height;
+        } result{&t, 0, 0};
+
+        GThread* thread = g_thread_new(
+                "text-test",
+                [](gpointer data) -> gpointer {
+                    auto* r = static_cast<Result*>(data);
+                    TextView::calcSize(r->text, r->width, r->height);
+                    return nullptr;
+                },
+                &result);
+        g_thread_join(thread);
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(width, result.width, 0.001);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(height, result.height, 0.001);
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(TextViewTest);